@@ -0,0 +1,100 @@
+// Flooding benchmark of P2pServer: a mesh of nodes in one loop over
+// loopback, each dialing the next few, every node broadcasts, and
+// every message must reach all other nodes once.
+//
+// usage: gossip_bench [nodes [messagesPerNode [degree [size]]]]
+
+#include <tesla/base/Timestamp.h>
+
+#include <tesla/net/EventLoop.h>
+#include <tesla/net/p2p/P2pServer.h>
+
+#include <boost/bind.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
+
+#include <string>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace tesla::base;
+using namespace tesla::net;
+
+EventLoop* g_loop;
+int64_t g_expected = 0;
+int64_t g_delivered = 0;
+Timestamp g_begin;
+
+void onGossip(int64_t, const StringPiece&, Timestamp)
+{
+    if (++g_delivered == g_expected)
+    {
+        g_loop->quit();
+    }
+}
+
+void broadcastAll(boost::ptr_vector<P2pServer>* nodes, int messagesPerNode, const std::string* message)
+{
+    g_begin = Timestamp::now();
+    for (int i = 0; i < messagesPerNode; ++i)
+    {
+        for (size_t j = 0; j < nodes->size(); ++j)
+        {
+            (*nodes)[j].broadcast(*message);
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int numNodes = argc > 1 ? atoi(argv[1]) : 16;
+    int messagesPerNode = argc > 2 ? atoi(argv[2]) : 1000;
+    int degree = argc > 3 ? atoi(argv[3]) : 3;
+    std::string message(argc > 4 ? atoi(argv[4]) : 100, 'x');
+    g_expected = static_cast<int64_t>(numNodes) * messagesPerNode * (numNodes - 1);
+
+    EventLoop loop;
+    g_loop = &loop;
+    boost::ptr_vector<P2pServer> nodes;
+    for (int i = 0; i < numNodes; ++i)
+    {
+        char name[32];
+        snprintf(name, sizeof name, "node%d", i);
+        nodes.push_back(new P2pServer(&loop, InetAddress("127.0.0.1", static_cast<uint16_t>(20000 + i)), name));
+        nodes.back().setGossipCallback(onGossip);
+        nodes.back().start();
+    }
+    for (int i = 0; i < numNodes; ++i)
+    {
+        for (int d = 1; d <= degree; ++d)
+        {
+            nodes[i].connectTo(InetAddress("127.0.0.1", static_cast<uint16_t>(20000 + (i + d) % numNodes)));
+        }
+    }
+
+    // the mesh forms within a second over loopback
+    loop.runAfter(1.0, boost::bind(broadcastAll, &nodes, messagesPerNode, &message));
+    loop.runAfter(30.0, boost::bind(&EventLoop::quit, &loop));
+    loop.loop();
+    double seconds = static_cast<double>(timespanInMicrosecond(Timestamp::now(), g_begin)) / 1000000;
+
+    int64_t duplicates = 0;
+    int64_t sent = 0;
+    size_t peers = 0;
+    for (size_t i = 0; i < nodes.size(); ++i)
+    {
+        duplicates += nodes[i].duplicates();
+        sent += nodes[i].sentFrames();
+        peers += nodes[i].peerCount();
+    }
+    int64_t messages = static_cast<int64_t>(numNodes) * messagesPerNode;
+    printf("%d nodes, %.1f peers each, %lld messages in %.3f s: "
+           "%lld of %lld deliveries, %.0f deliveries/s, "
+           "%.1f frames sent and %.1f duplicates per message\n",
+           numNodes, static_cast<double>(peers) / numNodes,
+           static_cast<long long>(messages), seconds,
+           static_cast<long long>(g_delivered), static_cast<long long>(g_expected),
+           static_cast<double>(g_delivered) / seconds,
+           static_cast<double>(sent) / static_cast<double>(messages),
+           static_cast<double>(duplicates) / static_cast<double>(messages));
+}
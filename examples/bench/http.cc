@@ -0,0 +1,281 @@
+// Requests per second of HttpServer, against an echo server doing
+// the same round trips with no parsing, to show what HTTP costs.
+// The server runs in the main thread, the clients in another one,
+// requests per server core is measured by the server thread's CPU time.
+//
+// Modes:
+//   http  a small text body
+//   echo  the request echoed back by a plain TcpServer
+//   file  a file body with sendfile(2)
+//   copy  the same file body read into memory once, copied per response
+//
+// usage: http_bench [http|echo|file|copy [connections [pipeline [seconds [file]]]]]
+// The file is 64k of generated bytes if not given.
+
+#include <tesla/base/CountdownLatch.h>
+#include <tesla/base/Logger.h>
+
+#include <tesla/net/Buffer.h>
+#include <tesla/net/EventLoop.h>
+#include <tesla/net/EventLoopThread.h>
+#include <tesla/net/FileRegion.h>
+#include <tesla/net/TcpClient.h>
+#include <tesla/net/TcpServer.h>
+#include <tesla/net/http/HttpRequest.h>
+#include <tesla/net/http/HttpResponse.h>
+#include <tesla/net/http/HttpServer.h>
+
+#include <boost/bind.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
+#include <boost/scoped_ptr.hpp>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+
+using namespace tesla::base;
+using namespace tesla::net;
+
+const char g_request[] = "GET /hello HTTP/1.1\r\n"
+                         "Host: localhost:18080\r\n"
+                         "User-Agent: http_bench\r\n"
+                         "Accept: */*\r\n"
+                         "\r\n";
+const size_t g_requestSize = sizeof g_request - 1;
+
+bool g_http = true;
+int g_pipeline = 1;
+FileRegion g_file;
+string g_fileContent;
+int64_t g_responses = 0; /* atomic, counted in the client thread */
+
+double threadCpuSeconds()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) / 1e9;
+}
+
+void onHello(const HttpRequest& req, HttpResponse* resp)
+{
+    if (req.path() == "/hello")
+    {
+        resp->setStatusCode(HttpResponse::Ok200);
+        resp->setContentType("text/plain");
+        resp->setBody("hello, world!\n");
+    }
+    else
+    {
+        resp->setStatusCode(HttpResponse::NotFound404);
+    }
+}
+
+void onFile(const HttpRequest&, HttpResponse* resp)
+{
+    resp->setStatusCode(HttpResponse::Ok200);
+    resp->setContentType("application/octet-stream");
+    resp->setBodyFile(g_file);
+}
+
+void onCopy(const HttpRequest&, HttpResponse* resp)
+{
+    resp->setStatusCode(HttpResponse::Ok200);
+    resp->setContentType("application/octet-stream");
+    resp->setBody(g_fileContent);
+}
+
+/// the file to serve, 64k generated if @c path is NULL
+bool openFile(const char* path)
+{
+    char generated[] = "/tmp/http_bench.XXXXXX";
+    if (path == NULL)
+    {
+        int fd = ::mkstemp(generated);
+        string block(64 * 1024, 'x');
+        if (fd < 0 || ::write(fd, block.data(), block.size()) != static_cast<ssize_t>(block.size()))
+        {
+            perror("http_bench");
+            return false;
+        }
+        ::close(fd);
+        path = generated;
+    }
+    g_file = FileRegion::open(path);
+    if (path == generated)
+    {
+        ::unlink(generated);
+    }
+    if (g_file.fd() < 0)
+    {
+        perror(path);
+        return false;
+    }
+    g_fileContent.resize(g_file.size());
+    if (::pread(g_file.fd(), &*g_fileContent.begin(), g_file.size(), 0)
+            != static_cast<ssize_t>(g_file.size()))
+    {
+        perror(path);
+        return false;
+    }
+    return true;
+}
+
+void onEcho(const TcpConnectionPtr& conn, Buffer* buf, Timestamp)
+{
+    conn->send(buf);
+}
+
+/// bytes of the first complete response in @c buf, 0 if none
+size_t responseSize(const Buffer* buf)
+{
+    const char* headerEnd = buf->find("\r\n\r\n");
+    if (headerEnd == NULL)
+    {
+        return 0;
+    }
+    size_t bodyLength = 0;
+    for (const char* line = buf->peek(); line < headerEnd; )
+    {
+        const char* lineEnd = buf->findCRLF(line);
+        if (lineEnd - line > 15 && ::strncasecmp(line, "Content-Length:", 15) == 0)
+        {
+            bodyLength = static_cast<size_t>(atol(line + 15));
+        }
+        line = lineEnd + 2;
+    }
+    size_t size = headerEnd + 4 - buf->peek() + bodyLength;
+    return size <= buf->readableBytes() ? size : 0;
+}
+
+class Client
+{
+public:
+    Client(EventLoop* loop, const InetAddress& serverAddr)
+        : client_(loop, serverAddr, "http_bench")
+    {
+        client_.setConnectionCallback(
+            boost::bind(&Client::onConnection, this, _1));
+        client_.setMessageCallback(
+            boost::bind(&Client::onMessage, this, _1, _2, _3));
+        client_.connect();
+    }
+
+private:
+    void onConnection(const TcpConnectionPtr& conn)
+    {
+        if (conn->connected())
+        {
+            conn->setTcpNoDelay(true);
+            for (int i = 0; i < g_pipeline; ++i)
+            {
+                conn->send(g_request, g_requestSize);
+            }
+        }
+    }
+
+    void onMessage(const TcpConnectionPtr& conn, Buffer* buf, Timestamp)
+    {
+        Buffer requests;
+        for (;;)
+        {
+            size_t size = g_http ? responseSize(buf) : g_requestSize;
+            if (size == 0 || buf->readableBytes() < size)
+            {
+                break;
+            }
+            buf->retrieve(size);
+            __atomic_fetch_add(&g_responses, 1, __ATOMIC_RELAXED);
+            requests.append(g_request, g_requestSize);
+        }
+        conn->send(&requests);
+    }
+
+    TcpClient client_;
+};
+
+boost::ptr_vector<Client> g_clients;
+
+void startClients(EventLoop* loop, const InetAddress& serverAddr, int connections)
+{
+    for (int i = 0; i < connections; ++i)
+    {
+        g_clients.push_back(new Client(loop, serverAddr));
+    }
+}
+
+void stopClients(CountdownLatch* latch)
+{
+    g_clients.clear();
+    latch->countDown();
+}
+
+int main(int argc, char* argv[])
+{
+    const char* mode = argc > 1 ? argv[1] : "http";
+    g_http = strcmp(mode, "echo") != 0;
+    int connections = argc > 2 ? atoi(argv[2]) : 16;
+    g_pipeline = argc > 3 ? atoi(argv[3]) : 1;
+    double seconds = argc > 4 ? atof(argv[4]) : 5.0;
+    bool withFile = strcmp(mode, "file") == 0 || strcmp(mode, "copy") == 0;
+    if (withFile && !openFile(argc > 5 ? argv[5] : NULL))
+    {
+        return 1;
+    }
+    Logger::setLogLevel(Logger::WARN);
+
+    EventLoop loop;
+    InetAddress listenAddr(18080, true);
+    boost::scoped_ptr<HttpServer> httpServer;
+    boost::scoped_ptr<TcpServer> echoServer;
+    if (g_http)
+    {
+        httpServer.reset(new HttpServer(&loop, listenAddr, "http_bench"));
+        httpServer->addCommonHeader("Server", "tesla");
+        if (strcmp(mode, "file") == 0)
+        {
+            httpServer->setHttpCallback(onFile);
+        }
+        else if (strcmp(mode, "copy") == 0)
+        {
+            httpServer->setHttpCallback(onCopy);
+        }
+        else
+        {
+            httpServer->setHttpCallback(onHello);
+        }
+        httpServer->start();
+    }
+    else
+    {
+        echoServer.reset(new TcpServer(&loop, listenAddr, "echo_bench"));
+        echoServer->setMessageCallback(onEcho);
+        echoServer->start();
+    }
+
+    EventLoopThread clientThread;
+    EventLoop* clientLoop = clientThread.startLoop();
+    clientLoop->runInLoop(boost::bind(startClients, clientLoop, listenAddr, connections));
+
+    loop.runAfter(seconds, boost::bind(&EventLoop::quit, &loop));
+    double cpuStart = threadCpuSeconds();
+    Timestamp start = Timestamp::now();
+    loop.loop();
+    double cpu = threadCpuSeconds() - cpuStart;
+    double wall = static_cast<double>(Timestamp::now().microSecondsSinceEpoch()
+                                      - start.microSecondsSinceEpoch()) / 1e6;
+    int64_t responses = __atomic_load_n(&g_responses, __ATOMIC_RELAXED);
+    double requests = static_cast<double>(responses);
+
+    CountdownLatch stopped(1);
+    clientLoop->runInLoop(boost::bind(stopClients, &stopped));
+    stopped.wait();
+
+    printf("%s: %d connections, pipeline %d, %.1fs\n",
+           mode, connections, g_pipeline, wall);
+    printf("%lld requests, %.0f requests/s, server cpu %.2fs, %.0f requests/s per core\n",
+           static_cast<long long>(responses), requests / wall, cpu,
+           cpu > 0 ? requests / cpu : 0.0);
+}
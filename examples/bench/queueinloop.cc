@@ -0,0 +1,77 @@
+// Contention benchmark of EventLoop::queueInLoop():
+// many threads post small functors to one loop as fast as they can.
+//
+// usage: queueinloop_bench [numThreads [postsPerThread]]
+
+#include <tesla/base/CountdownLatch.h>
+#include <tesla/base/Thread.h>
+#include <tesla/base/Timestamp.h>
+
+#include <tesla/net/EventLoop.h>
+
+#include <boost/bind.hpp>
+#include <boost/ptr_container/ptr_vector.hpp>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace tesla::base;
+using namespace tesla::net;
+
+EventLoop* g_loop;
+int g_postsPerThread = 100000;
+int64_t g_expected = 0;
+int64_t g_received = 0;
+
+void onPost()
+{
+    if (++g_received == g_expected)
+    {
+        g_loop->quit();
+    }
+}
+
+void producer(CountdownLatch* start)
+{
+    start->wait();
+    for (int i = 0; i < g_postsPerThread; ++i)
+    {
+        g_loop->queueInLoop(onPost);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int numThreads = argc > 1 ? atoi(argv[1]) : 16;
+    if (argc > 2)
+    {
+        g_postsPerThread = atoi(argv[2]);
+    }
+    g_expected = static_cast<int64_t>(numThreads) * g_postsPerThread;
+
+    EventLoop loop;
+    g_loop = &loop;
+    CountdownLatch start(1);
+    boost::ptr_vector<Thread> threads;
+    for (int i = 0; i < numThreads; ++i)
+    {
+        threads.push_back(new Thread(boost::bind(producer, &start)));
+        threads.back().start();
+    }
+
+    Timestamp begin(Timestamp::now());
+    start.countDown();
+    loop.loop();
+    double seconds = static_cast<double>(timespanInMicrosecond(Timestamp::now(), begin)) / 1000000;
+
+    for (size_t i = 0; i < threads.size(); ++i)
+    {
+        threads[i].join();
+    }
+    printf("%d threads, %lld functors in %.3f s, %.0f functors/s, "
+           "%lld loop iterations, %lld eventfd writes\n",
+           numThreads, static_cast<long long>(g_expected), seconds,
+           static_cast<double>(g_expected) / seconds,
+           static_cast<long long>(loop.iteration()),
+           static_cast<long long>(loop.wakeupWrites()));
+}
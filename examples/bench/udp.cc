@@ -0,0 +1,101 @@
+// Throughput benchmark of UdpServer/UdpClient:
+// the client keeps a window of datagrams in flight to an echo server,
+// both in one loop, and reports how many datagrams each syscall moved.
+// With offload, the client sends its datagrams with UDP_SEGMENT and
+// both ends receive with UDP_GRO.
+//
+// usage: udp_bench [window [seconds [size [offload]]]]
+
+#include <tesla/base/Timestamp.h>
+
+#include <tesla/net/EventLoop.h>
+#include <tesla/net/UdpClient.h>
+#include <tesla/net/UdpServer.h>
+
+#include <boost/bind.hpp>
+
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace tesla::base;
+using namespace tesla::net;
+
+int64_t g_echoed = 0;
+bool g_offload = false;
+
+void onServerDatagrams(UdpServer* server, const std::vector<Datagram>& datagrams, Timestamp)
+{
+    for (size_t i = 0; i < datagrams.size(); ++i)
+    {
+        server->sendTo(datagrams[i].peer, datagrams[i].data);
+    }
+}
+
+void sendMessages(UdpClient* client, const std::string* message, size_t count)
+{
+    if (g_offload)
+    {
+        std::string segments;
+        for (size_t i = 0; i < count; ++i)
+        {
+            segments += *message;
+        }
+        client->sendSegments(segments, message->size());
+        return;
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+        client->send(*message);
+    }
+}
+
+void onClientDatagrams(UdpClient* client, const std::string* message,
+                       const std::vector<Datagram>& datagrams, Timestamp)
+{
+    g_echoed += datagrams.size();
+    sendMessages(client, message, datagrams.size());
+}
+
+int main(int argc, char* argv[])
+{
+    int window = argc > 1 ? atoi(argv[1]) : 64;
+    double seconds = argc > 2 ? atof(argv[2]) : 5.0;
+    size_t size = argc > 3 ? atoi(argv[3]) : 64;
+    g_offload = argc > 4 && atoi(argv[4]) != 0;
+    std::string message(size, 'x');
+
+    EventLoop loop;
+    InetAddress serverAddr("127.0.0.1", 19982);
+    UdpServer server(&loop, serverAddr, "UdpBenchServer");
+    server.setDatagramCallback(boost::bind(onServerDatagrams, &server, _1, _2));
+    UdpClient client(&loop, serverAddr, "UdpBenchClient");
+    client.setDatagramCallback(boost::bind(onClientDatagrams, &client, &message, _1, _2));
+    if (g_offload)
+    {
+        server.enableGro();
+        client.enableGso();
+        client.enableGro();
+    }
+    server.start();
+    client.start();
+
+    loop.runAfter(0, boost::bind(sendMessages, &client, &message, static_cast<size_t>(window)));
+    loop.runAfter(seconds, boost::bind(&EventLoop::quit, &loop));
+    Timestamp begin(Timestamp::now());
+    loop.loop();
+    double elapsed = static_cast<double>(timespanInMicrosecond(Timestamp::now(), begin)) / 1000000;
+
+    const UdpEndpointPtr& s = server.endpoint();
+    const UdpEndpointPtr& c = client.endpoint();
+    printf("window %d, %zu bytes, gso %d, gro %d: %.0f round trips/s, "
+           "%.1f datagrams per recvmmsg, %.1f per sendmmsg, %lld dropped\n",
+           window, size, c->gso(), s->gro(), static_cast<double>(g_echoed) / elapsed,
+           static_cast<double>(s->receivedDatagrams() + c->receivedDatagrams())
+               / static_cast<double>(s->receiveCalls() + c->receiveCalls()),
+           static_cast<double>(s->sentDatagrams() + c->sentDatagrams())
+               / static_cast<double>(s->sendCalls() + c->sendCalls()),
+           static_cast<long long>(s->droppedDatagrams() + c->droppedDatagrams()));
+}
@@ -45,7 +45,7 @@ public:
         MutexLockGuard lock(mutex_);
         if (connection_)
         {
-            codec_.send(get_pointer(connection_), message);
+            codec_.send(connection_.get(), message);
         }
     }
 
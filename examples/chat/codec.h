@@ -6,6 +6,7 @@
 
 #include <tesla/net/Buffer.h>
 #include <tesla/net/Endian.hpp>
+#include <tesla/net/Slice.hpp>
 #include <tesla/net/TcpConnection.h>
 
 #include <boost/function.hpp>
@@ -68,6 +69,23 @@ public:
         conn->send(&buf);
     }
 
+    /// Frames @c message once, the result can be sent to many connections.
+    static tesla::net::Slice frame(const tesla::base::StringPiece& message)
+    {
+        tesla::net::Buffer buf;
+        buf.append(message.data(), message.size());
+        int32_t len = static_cast<int32_t>(message.size());
+        int32_t be32 = tesla::net::hostToNetwork32(len);
+        buf.prepend(&be32, sizeof be32);
+        return tesla::net::Slice(&buf);
+    }
+
+    void send(tesla::net::TcpConnection* conn,
+              const tesla::net::Slice& framed)
+    {
+        conn->send(framed);
+    }
+
 private:
     StringMessageCallback messageCallback_;
     const static size_t HEADER_LENGTH = sizeof(int32_t);
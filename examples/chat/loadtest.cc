@@ -101,7 +101,7 @@ private:
     void send()
     {
         g_startTime = Timestamp::now();
-        codec_.send(get_pointer(connection_), "hello");
+        codec_.send(connection_.get(), "hello");
         LOG_DEBUG << "sent";
     }
 
@@ -67,7 +67,7 @@ private:
                 it != connections_.end();
                 ++it)
         {
-            codec_.send(get_pointer(*it), message);
+            codec_.send(it->get(), message);
         }
     }
 
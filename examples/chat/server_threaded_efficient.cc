@@ -78,7 +78,7 @@ private:
                 it != connections->end();
                 ++it)
         {
-            codec_.send(get_pointer(*it), message);
+            codec_.send(it->get(), message);
         }
     }
 
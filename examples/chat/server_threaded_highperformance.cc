@@ -64,7 +64,9 @@ private:
                          const string& message,
                          Timestamp)
     {
-        EventLoop::Functor f = boost::bind(&ChatServer::distributeMessage, this, message);
+        // framed once, every connection shares the same bytes
+        EventLoop::Functor f = boost::bind(&ChatServer::distributeMessage, this,
+                                           LengthHeaderCodec::frame(message));
         LOG_DEBUG;
 
         MutexLockGuard lock(mutex_);
@@ -79,14 +81,14 @@ private:
 
     typedef std::set<TcpConnectionPtr> ConnectionList;
 
-    void distributeMessage(const string& message)
+    void distributeMessage(const Slice& message)
     {
         LOG_DEBUG << "begin";
         for (ConnectionList::iterator it = LocalConnections::instance().begin();
                 it != LocalConnections::instance().end();
                 ++it)
         {
-            codec_.send(get_pointer(*it), message);
+            codec_.send(it->get(), message);
         }
         LOG_DEBUG << "end";
     }
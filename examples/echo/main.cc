@@ -3,15 +3,46 @@
 #include <tesla/base/Logger.h>
 #include <tesla/net/EventLoop.h>
 
+#include <boost/bind.hpp>
+
+#include <signal.h>
+
 using namespace tesla::base;
 // using namespace tesla;
 // using namespace tesla::net;
 
+// quits once the echoes in flight are written. The server keeps
+// accepting meanwhile, the echoes of new connections are waited for too.
+void drain(tesla::net::EventLoop* loop)
+{
+    if (loop->pendingOutputBytes() > 0)
+    {
+        loop->runAfter(0.1, boost::bind(drain, loop));
+        return;
+    }
+    loop->quit();
+}
+
+void onTerminate(tesla::net::EventLoop* loop, int signo)
+{
+    LOG_INFO << "signal " << signo << ", draining " << loop->pendingOutputBytes() << " bytes";
+    drain(loop);
+}
+
+void onHangup(int)
+{
+    Logger::setLogLevel(Logger::getLogLevel() == Logger::TRACE ? Logger::INFO : Logger::TRACE);
+    LOG_WARN << "SIGHUP, log level " << Logger::getLogLevel();
+}
+
 int main()
 {
     Logger::setLogLevel(Logger::TRACE);
     LOG_INFO << "pid = " << getpid();
     tesla::net::EventLoop loop;
+    loop.onSignal(SIGTERM, boost::bind(onTerminate, &loop, _1));
+    loop.onSignal(SIGINT, boost::bind(onTerminate, &loop, _1));
+    loop.onSignal(SIGHUP, onHangup);
     tesla::net::InetAddress listenAddr(2007);
     EchoServer server(&loop, listenAddr);
     server.start();
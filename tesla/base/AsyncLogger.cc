@@ -10,6 +10,12 @@ namespace tesla
 namespace base
 {
 
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+using std::bind;
+#else // __GXX_EXPERIMENTAL_CXX0X__
+using boost::bind;
+#endif // __GXX_EXPERIMENTAL_CXX0X__
+
 AsyncLogger::AsyncLogger(const string& basename,
                          size_t rollSize,
                          int flushInterval)
@@ -17,12 +23,12 @@ AsyncLogger::AsyncLogger(const string& basename,
       running_(false),
       basename_(basename),
       rollSize_(rollSize),
-      thread_(boost::bind(&AsyncLogger::threadFunc, this), "Logging"),
+      thread_(bind(&AsyncLogger::threadFunc, this), "Logging"),
       latch_(1),
       mutex_(),
       cond_(mutex_),
-      currentBuffer_(new Buffer),
-      nextBuffer_(new Buffer),
+      currentBuffer_(new Buffer, BufferPtr::deleter_type()),
+      nextBuffer_(new Buffer, BufferPtr::deleter_type()),
       buffers_()
 {
     currentBuffer_->bzero();
@@ -47,7 +53,7 @@ void AsyncLogger::append(const char* logline, int len)
         }
         else
         {
-            currentBuffer_.reset(new Buffer); // Rarely happens
+            currentBuffer_.reset(new Buffer, BufferPtr::deleter_type()); // Rarely happens
         }
         currentBuffer_->append(logline, len);
         cond_.notify();
@@ -59,8 +65,8 @@ void AsyncLogger::threadFunc()
     assert(running_ == true);
     latch_.countDown();
     FileLogger output(basename_, rollSize_, false);
-    BufferPtr newBuffer1(new Buffer);
-    BufferPtr newBuffer2(new Buffer);
+    BufferPtr newBuffer1(new Buffer, BufferPtr::deleter_type());
+    BufferPtr newBuffer2(new Buffer, BufferPtr::deleter_type());
     newBuffer1->bzero();
     newBuffer2->bzero();
     BufferVector buffersToWrite;
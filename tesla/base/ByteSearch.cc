@@ -0,0 +1,183 @@
+#include <tesla/base/ByteSearch.h>
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__))
+#define TESLA_BYTESEARCH_X86
+#include <immintrin.h>
+#endif
+
+namespace tesla
+{
+
+namespace base
+{
+
+typedef const char* (*FindFunc)(const char*, const char*, const char*, size_t);
+
+const char* scalarFind(const char* begin, const char* end,
+                       const char* needle, size_t len)
+{
+    const char* last = end - len;
+    const char* p = begin;
+    while (p <= last)
+    {
+        p = static_cast<const char*>(::memchr(p, needle[0], last - p + 1));
+        if (p == NULL)
+        {
+            return NULL;
+        }
+        if (::memcmp(p + 1, needle + 1, len - 1) == 0)
+        {
+            return p;
+        }
+        ++p;
+    }
+    return NULL;
+}
+
+#ifdef TESLA_BYTESEARCH_X86
+
+// candidates are the positions where both the first and the last byte
+// of the needle match, the bytes between are compared one candidate
+// at a time, for CRLF there are none
+
+const char* sse2Find(const char* begin, const char* end,
+                     const char* needle, size_t len)
+{
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[len - 1]);
+    const char* p = begin;
+    for (; end - p >= static_cast<ptrdiff_t>(len - 1 + 16); p += 16)
+    {
+        __m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + len - 1));
+        unsigned mask = _mm_movemask_epi8(
+                            _mm_and_si128(_mm_cmpeq_epi8(blockFirst, first),
+                                          _mm_cmpeq_epi8(blockLast, last)));
+        while (mask != 0)
+        {
+            int bit = __builtin_ctz(mask);
+            if (len <= 2 || ::memcmp(p + bit + 1, needle + 1, len - 2) == 0)
+            {
+                return p + bit;
+            }
+            mask &= mask - 1;
+        }
+    }
+    return scalarFind(p, end, needle, len);
+}
+
+__attribute__((target("avx2")))
+const char* avx2Find(const char* begin, const char* end,
+                     const char* needle, size_t len)
+{
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[len - 1]);
+    const char* p = begin;
+    // two blocks a round, one branch for both on the usual miss
+    for (; end - p >= static_cast<ptrdiff_t>(len - 1 + 64); p += 64)
+    {
+        const __m256i* q = reinterpret_cast<const __m256i*>(p);
+        const __m256i* r = reinterpret_cast<const __m256i*>(p + len - 1);
+        __m256i match0 = _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_loadu_si256(q), first),
+                                          _mm256_cmpeq_epi8(_mm256_loadu_si256(r), last));
+        __m256i match1 = _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_loadu_si256(q + 1), first),
+                                          _mm256_cmpeq_epi8(_mm256_loadu_si256(r + 1), last));
+        if (_mm256_testz_si256(_mm256_or_si256(match0, match1),
+                               _mm256_or_si256(match0, match1)))
+        {
+            continue;
+        }
+        uint64_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(match0))
+                        | static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(match1))) << 32;
+        while (mask != 0)
+        {
+            int bit = __builtin_ctzll(mask);
+            if (len <= 2 || ::memcmp(p + bit + 1, needle + 1, len - 2) == 0)
+            {
+                return p + bit;
+            }
+            mask &= mask - 1;
+        }
+    }
+    return sse2Find(p, end, needle, len);
+}
+
+#endif // TESLA_BYTESEARCH_X86
+
+struct Kernel
+{
+    const char* name;
+    FindFunc find;
+};
+
+const Kernel* selectKernel()
+{
+    static const Kernel scalar = { "scalar", scalarFind };
+#ifdef TESLA_BYTESEARCH_X86
+    static const Kernel sse2 = { "sse2", sse2Find };
+    static const Kernel avx2 = { "avx2", avx2Find };
+    if (::getenv("TESLA_NO_SIMD"))
+    {
+        return &scalar;
+    }
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") ? &avx2 : &sse2;
+#else
+    return &scalar;
+#endif
+}
+
+// chosen on first use, racing threads choose the same
+const Kernel* g_kernel = NULL;
+
+const Kernel* kernelOf()
+{
+    const Kernel* kernel = __atomic_load_n(&g_kernel, __ATOMIC_ACQUIRE);
+    if (kernel == NULL)
+    {
+        kernel = selectKernel();
+        __atomic_store_n(&g_kernel, kernel, __ATOMIC_RELEASE);
+    }
+    return kernel;
+}
+
+const char* ByteSearch::findByte(const char* begin, const char* end, char c)
+{
+    return static_cast<const char*>(::memchr(begin, c, end - begin));
+}
+
+const char* ByteSearch::findCRLF(const char* begin, const char* end)
+{
+    return find(begin, end, "\r\n", 2);
+}
+
+const char* ByteSearch::find(const char* begin, const char* end,
+                             const char* needle, size_t len)
+{
+    if (len == 0)
+    {
+        return begin;
+    }
+    if (static_cast<size_t>(end - begin) < len)
+    {
+        return NULL;
+    }
+    if (len == 1)
+    {
+        return findByte(begin, end, needle[0]);
+    }
+    return kernelOf()->find(begin, end, needle, len);
+}
+
+const char* ByteSearch::kernel()
+{
+    return kernelOf()->name;
+}
+
+} // namespace base
+
+} // namespace tesla
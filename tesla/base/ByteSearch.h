@@ -0,0 +1,58 @@
+/*
+ *
+ * Author:
+ *     Thomas Liu
+ * Date:
+ *     10/18/2026
+ * Description:
+ *     Byte and short needle search with SSE2/AVX2 kernels
+ *
+ *
+ * Licensed under the Apache License, Version 2.0
+ *
+ */
+
+#ifndef TESLA_BASE_BYTESEARCH_H
+#define TESLA_BASE_BYTESEARCH_H
+
+#include <tesla/base/Noncopyable.hpp>
+
+#include <stddef.h>
+
+namespace tesla
+{
+
+namespace base
+{
+
+///
+/// Searches of [begin, end) for protocol delimiters.
+///
+/// A needle is found by comparing its first and last bytes against
+/// 16 or 32 positions at once, the AVX2 kernel is taken if the CPU
+/// has it, SSE2 otherwise on x86, a scalar loop elsewhere or if
+/// TESLA_NO_SIMD is set.
+/// A single byte goes to memchr(3), which libc vectorizes already.
+///
+class ByteSearch
+    : private tesla::base::Noncopyable
+{
+public:
+    /// @return the first @c c, or NULL
+    static const char* findByte(const char* begin, const char* end, char c);
+    /// @return the first "\r\n", or NULL
+    static const char* findCRLF(const char* begin, const char* end);
+    /// @return the first @c needle of @c len bytes, or NULL,
+    /// @c begin if @c len is 0
+    static const char* find(const char* begin, const char* end,
+                            const char* needle, size_t len);
+
+    /// "avx2", "sse2" or "scalar"
+    static const char* kernel();
+}; // class ByteSearch
+
+} // namespace base
+
+} // namespace tesla
+
+#endif  // TESLA_BASE_BYTESEARCH_H
@@ -0,0 +1,147 @@
+#include <tesla/base/CpuAffinity.h>
+#include <tesla/base/CurrentThread.h>
+#include <tesla/base/Logger.h>
+#include <tesla/base/ProcessInfo.h>
+
+#include <map>
+
+#include <errno.h>
+#include <sched.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+// from <numaif.h>, which comes with libnuma
+#ifndef MPOL_PREFERRED
+#define MPOL_PREFERRED 1
+#endif
+
+namespace tesla
+{
+
+namespace base
+{
+
+bool preferNumaNode(int node)
+{
+    // nodes above 1023 are not worth a dependency on libnuma
+    const int maxNodes = 1024;
+    const int bitsPerWord = 8 * static_cast<int>(sizeof(unsigned long));
+    if (node < 0 || node >= maxNodes)
+    {
+        return false;
+    }
+    unsigned long mask[maxNodes / (8 * sizeof(unsigned long))] = { 0 };
+    mask[node / bitsPerWord] = 1UL << (node % bitsPerWord);
+    return ::syscall(SYS_set_mempolicy, MPOL_PREFERRED, mask, maxNodes) == 0;
+}
+
+CpuAffinity::CpuAffinity()
+    : mode_(NoPinning)
+{
+}
+
+CpuAffinity::CpuAffinity(Mode mode, const std::vector<int>& cpus)
+    : mode_(mode),
+      cpus_(cpus)
+{
+}
+
+CpuAffinity CpuAffinity::cpuList(const std::vector<int>& cpus)
+{
+    return CpuAffinity(CpuList, cpus);
+}
+
+CpuAffinity CpuAffinity::physicalCores()
+{
+    return CpuAffinity(PhysicalCores, ProcessInfo::physicalCores());
+}
+
+CpuAffinity CpuAffinity::numaNodes()
+{
+    std::vector<int> cores = ProcessInfo::physicalCores();
+    std::map<int, std::vector<int> > nodes;
+    for (size_t i = 0; i < cores.size(); ++i)
+    {
+        nodes[ProcessInfo::numaNodeOf(cores[i])].push_back(cores[i]);
+    }
+
+    // the first core of every node, then the second ones, ...
+    std::vector<int> cpus;
+    for (size_t round = 0; cpus.size() < cores.size(); ++round)
+    {
+        for (std::map<int, std::vector<int> >::const_iterator it = nodes.begin();
+                it != nodes.end(); ++it)
+        {
+            if (round < it->second.size())
+            {
+                cpus.push_back(it->second[round]);
+            }
+        }
+    }
+    return CpuAffinity(NumaNodes, cpus);
+}
+
+int CpuAffinity::cpuOf(int index) const
+{
+    if (mode_ == NoPinning || cpus_.empty() || index < 0)
+    {
+        return -1;
+    }
+    return cpus_[index % cpus_.size()];
+}
+
+bool CpuAffinity::apply(int index) const
+{
+    int cpu = cpuOf(index);
+    if (cpu < 0)
+    {
+        return true;
+    }
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (::sched_setaffinity(0, sizeof set, &set) != 0)
+    {
+        LOG_SYSERR << "CpuAffinity::apply sched_setaffinity cpu " << cpu;
+        return false;
+    }
+
+    int node = ProcessInfo::numaNodeOf(cpu);
+    // what this thread allocates from now on, its Buffers say, is node-local
+    if (!preferNumaNode(node) && errno != ENOSYS)
+    {
+        LOG_SYSERR << "CpuAffinity::apply set_mempolicy node " << node;
+    }
+
+    ProcessInfo::PinnedThread thread;
+    thread.tid = CurrentThread::tid();
+    thread.name = CurrentThread::name();
+    thread.cpu = cpu;
+    thread.node = node;
+    ProcessInfo::addPinnedThread(thread);
+    LOG_DEBUG << "thread " << thread.tid << " pinned to cpu " << cpu
+              << " node " << node;
+    return true;
+}
+
+string CpuAffinity::toString() const
+{
+    static const char* const names[] =
+    {
+        "NoPinning", "CpuList", "PhysicalCores", "NumaNodes",
+    };
+    string result(names[mode_]);
+    for (size_t i = 0; i < cpus_.size(); ++i)
+    {
+        char buf[16];
+        snprintf(buf, sizeof buf, "%c%d", i == 0 ? ' ' : ',', cpus_[i]);
+        result += buf;
+    }
+    return result;
+}
+
+} // namespace base
+
+} // namespace tesla
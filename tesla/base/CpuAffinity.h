@@ -0,0 +1,91 @@
+/*
+ *
+ * Author:
+ *     Thomas Liu
+ * Date:
+ *     10/18/2026
+ * Description:
+ *     CPU affinity plan for thread pools
+ *
+ *
+ * Licensed under the Apache License, Version 2.0
+ *
+ */
+
+#ifndef TESLA_BASE_CPUAFFINITY_H
+#define TESLA_BASE_CPUAFFINITY_H
+
+#include <tesla/base/Copyable.hpp>
+#include <tesla/base/Types.hpp>
+
+#include <vector>
+
+namespace tesla
+{
+
+namespace base
+{
+
+///
+/// Which cpu each thread of a pool runs on.
+/// The i-th thread gets cpuOf(i), the list wraps around
+/// when there are more threads than cpus.
+///
+/// A pinned thread also prefers the memory of its cpu's NUMA node,
+/// so what it allocates, its Buffers for instance, stays local.
+/// Pinned threads are listed by ProcessInfo::pinnedThreads().
+class CpuAffinity
+    : public Copyable
+{
+public:
+    enum Mode
+    {
+        NoPinning,
+        /// the cpus given
+        CpuList,
+        /// one logical cpu of each physical core, no hyper-thread siblings
+        PhysicalCores,
+        /// physical cores taken from the NUMA nodes in turn,
+        /// so the threads spread evenly over the nodes
+        NumaNodes,
+    };
+
+    /// no pinning, the scheduler decides
+    CpuAffinity();
+
+    static CpuAffinity cpuList(const std::vector<int>& cpus);
+    static CpuAffinity physicalCores();
+    static CpuAffinity numaNodes();
+
+    Mode mode() const
+    {
+        return mode_;
+    }
+    const std::vector<int>& cpus() const
+    {
+        return cpus_;
+    }
+
+    /// cpu of the @c index th thread, -1 if not pinned
+    int cpuOf(int index) const;
+
+    /// Pins the calling thread to cpuOf(index), and prefers its node
+    /// for memory. Called by the thread itself before it allocates.
+    /// @return false if the kernel refused
+    bool apply(int index) const;
+
+    /// "PhysicalCores 0,2,4,6"
+    string toString() const;
+
+private:
+    CpuAffinity(Mode mode, const std::vector<int>& cpus);
+
+    Mode mode_;
+    std::vector<int> cpus_;
+}; // class CpuAffinity
+
+} // namespace base
+
+} // namespace tesla
+
+#endif  // TESLA_BASE_CPUAFFINITY_H
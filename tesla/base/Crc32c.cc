@@ -0,0 +1,142 @@
+#include <tesla/base/Crc32c.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__)
+#define TESLA_CRC32C_X86
+#include <immintrin.h>
+#endif
+
+namespace tesla
+{
+
+namespace base
+{
+
+typedef uint32_t (*ExtendFunc)(uint32_t, const char*, size_t);
+
+/// reflected 0x1EDC6F41
+const uint32_t CRC32C_POLY = 0x82F63B78;
+
+/// slicing-by-8: entries[k][b] is the CRC of byte b followed by k zero bytes
+struct Crc32cTable
+{
+    Crc32cTable()
+    {
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            uint32_t crc = i;
+            for (int j = 0; j < 8; ++j)
+            {
+                crc = (crc >> 1) ^ (crc & 1 ? CRC32C_POLY : 0);
+            }
+            entries[0][i] = crc;
+        }
+        for (int k = 1; k < 8; ++k)
+        {
+            for (int i = 0; i < 256; ++i)
+            {
+                uint32_t prev = entries[k - 1][i];
+                entries[k][i] = entries[0][prev & 0xff] ^ (prev >> 8);
+            }
+        }
+    }
+
+    uint32_t entries[8][256];
+};
+
+uint32_t scalarExtend(uint32_t crc, const char* data, size_t len)
+{
+    static const Crc32cTable table;
+    const uint32_t (*t)[256] = table.entries;
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+    const unsigned char* end = p + len;
+    crc = ~crc;
+    for (; end - p >= 8; p += 8)
+    {
+        uint32_t low = crc ^ (p[0] | p[1] << 8 | p[2] << 16 | static_cast<uint32_t>(p[3]) << 24);
+        crc = t[7][low & 0xff] ^ t[6][(low >> 8) & 0xff]
+              ^ t[5][(low >> 16) & 0xff] ^ t[4][low >> 24]
+              ^ t[3][p[4]] ^ t[2][p[5]] ^ t[1][p[6]] ^ t[0][p[7]];
+    }
+    for (; p < end; ++p)
+    {
+        crc = t[0][(crc ^ *p) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+#ifdef TESLA_CRC32C_X86
+
+__attribute__((target("sse4.2")))
+uint32_t sse42Extend(uint32_t crc, const char* data, size_t len)
+{
+    const char* p = data;
+    const char* end = data + len;
+    uint64_t crc64 = ~crc;
+    for (; p + 8 <= end; p += 8)
+    {
+        uint64_t word;
+        ::memcpy(&word, p, sizeof word);
+        crc64 = _mm_crc32_u64(crc64, word);
+    }
+    uint32_t crc32 = static_cast<uint32_t>(crc64);
+    for (; p < end; ++p)
+    {
+        crc32 = _mm_crc32_u8(crc32, static_cast<unsigned char>(*p));
+    }
+    return ~crc32;
+}
+
+#endif // TESLA_CRC32C_X86
+
+struct Crc32cKernel
+{
+    const char* name;
+    ExtendFunc extend;
+};
+
+const Crc32cKernel* selectCrc32cKernel()
+{
+    static const Crc32cKernel scalar = { "scalar", scalarExtend };
+#ifdef TESLA_CRC32C_X86
+    static const Crc32cKernel sse42 = { "sse4.2", sse42Extend };
+    if (::getenv("TESLA_NO_SIMD"))
+    {
+        return &scalar;
+    }
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse4.2") ? &sse42 : &scalar;
+#else
+    return &scalar;
+#endif
+}
+
+// chosen on first use, racing threads choose the same
+const Crc32cKernel* g_crc32cKernel = NULL;
+
+const Crc32cKernel* crc32cKernelOf()
+{
+    const Crc32cKernel* kernel = __atomic_load_n(&g_crc32cKernel, __ATOMIC_ACQUIRE);
+    if (kernel == NULL)
+    {
+        kernel = selectCrc32cKernel();
+        __atomic_store_n(&g_crc32cKernel, kernel, __ATOMIC_RELEASE);
+    }
+    return kernel;
+}
+
+uint32_t Crc32c::extend(uint32_t crc, const char* data, size_t len)
+{
+    return crc32cKernelOf()->extend(crc, data, len);
+}
+
+const char* Crc32c::kernel()
+{
+    return crc32cKernelOf()->name;
+}
+
+} // namespace base
+
+} // namespace tesla
@@ -0,0 +1,235 @@
+/*
+ *
+ * Author:
+ *     Thomas Liu
+ * Date:
+ *     10/18/2026
+ * Description:
+ *     Lock-free multi-producer single-consumer queue
+ *
+ *
+ * Licensed under the Apache License, Version 2.0
+ *
+ */
+
+#ifndef TESLA_BASE_MPSCQUEUE_HPP
+#define TESLA_BASE_MPSCQUEUE_HPP
+
+#include <tesla/base/Noncopyable.hpp>
+#include <tesla/base/ThreadLocalSingleton.hpp>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include <stddef.h>
+
+namespace tesla
+{
+
+namespace base
+{
+
+///
+/// Unbounded MPSC queue of linked nodes (D. Vyukov).
+///
+/// push() is wait-free, one atomic exchange and one store,
+/// the value lives inside the node.
+/// Elements of one producer come out in the order they were pushed.
+///
+/// The consumer always holds a dummy node, which is the last node
+/// it has taken, so no node is pushed while still linked.
+///
+/// Nodes are cached per thread: the consumer keeps those it is done
+/// with, and push() takes one from the cache of its thread, so a thread
+/// that both consumes and produces, an EventLoop queueing to itself
+/// or to its peers, does not allocate. Other threads allocate one node
+/// per push().
+template<typename T>
+class MpscQueue
+    : private Noncopyable
+{
+public:
+    MpscQueue()
+        : head_(new Node),
+          tail_(head_)
+    {
+    }
+
+    ~MpscQueue()
+    {
+        while (tail_)
+        {
+            Node* next = tail_->next;
+            delete tail_;
+            tail_ = next;
+        }
+    }
+
+    /// Thread safe.
+    void push(const T& x)
+    {
+        Node* node = NodeCache::instance().take();
+        if (node != NULL)
+        {
+            node->value = x;
+        }
+        else
+        {
+            node = new Node(x);
+        }
+        link(node);
+    }
+
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+    /// Thread safe.
+    void push(T&& x)
+    {
+        Node* node = NodeCache::instance().take();
+        if (node != NULL)
+        {
+            node->value = std::move(x);
+        }
+        else
+        {
+            node = new Node(std::move(x));
+        }
+        link(node);
+    }
+#endif // __GXX_EXPERIMENTAL_CXX0X__
+
+    /// Moves everything pushed before this call to the back of @c out.
+    /// A node whose push() is still linking is left for the next call,
+    /// so are the ones pushed meanwhile.
+    /// Consumer only.
+    /// @return number of elements taken
+    size_t takeAll(std::vector<T>* out)
+    {
+        Node* last = __atomic_load_n(&head_, __ATOMIC_ACQUIRE);
+        Nodes& cache = NodeCache::instance();
+        size_t n = 0;
+        while (tail_ != last)
+        {
+            Node* next = __atomic_load_n(&tail_->next, __ATOMIC_ACQUIRE);
+            if (next == NULL)
+            {
+                break;  // its producer is between exchange and store
+            }
+            out->push_back(T());
+            using std::swap;
+            swap(out->back(), next->value);
+            cache.give(tail_);
+            tail_ = next;
+            ++n;
+        }
+        return n;
+    }
+
+    /// Consumer only.
+    bool empty() const
+    {
+        return __atomic_load_n(&tail_->next, __ATOMIC_ACQUIRE) == NULL;
+    }
+
+private:
+    struct Node
+    {
+        Node()
+            : value(),
+              next(NULL)
+        {
+        }
+
+        explicit Node(const T& x)
+            : value(x),
+              next(NULL)
+        {
+        }
+
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+        explicit Node(T&& x)
+            : value(std::move(x)),
+              next(NULL)
+        {
+        }
+#endif // __GXX_EXPERIMENTAL_CXX0X__
+
+        T value;
+        Node* next;
+    };
+
+    /// free nodes of one thread, their values are default ones
+    class Nodes
+        : private Noncopyable
+    {
+    public:
+        Nodes()
+            : free_(NULL),
+              count_(0)
+        {
+        }
+
+        ~Nodes()
+        {
+            while (free_)
+            {
+                Node* next = free_->next;
+                delete free_;
+                free_ = next;
+            }
+        }
+
+        /// NULL if there is none
+        Node* take()
+        {
+            Node* node = free_;
+            if (node != NULL)
+            {
+                free_ = node->next;
+                node->next = NULL;
+                --count_;
+            }
+            return node;
+        }
+
+        void give(Node* node)
+        {
+            if (count_ < MAX_CACHED_NODES)
+            {
+                node->next = free_;
+                free_ = node;
+                ++count_;
+            }
+            else
+            {
+                delete node;
+            }
+        }
+
+    private:
+        /// of each thread, for each T
+        static const size_t MAX_CACHED_NODES = 1024;
+
+        Node* free_;
+        size_t count_;
+    }; // class Nodes
+    typedef ThreadLocalSingleton<Nodes> NodeCache;
+
+    void link(Node* node)
+    {
+        Node* prev = __atomic_exchange_n(&head_, node, __ATOMIC_ACQ_REL);
+        __atomic_store_n(&prev->next, node, __ATOMIC_RELEASE);
+    }
+
+    static const size_t CACHE_LINE_SIZE = 64;
+
+    Node* head_;  // last pushed, shared by producers
+    char pad_[CACHE_LINE_SIZE - sizeof(Node*)];  // keeps tail_ off producers' line
+    Node* tail_;  // dummy in front of the first element, consumer only
+}; // class MpscQueue
+
+} // namespace base
+
+} // namespace tesla
+
+#endif  // TESLA_BASE_MPSCQUEUE_HPP
@@ -1,14 +1,17 @@
 #include <tesla/base/ProcessInfo.h>
 #include <tesla/base/CurrentThread.h>
 #include <tesla/base/FileUtils.h>
+#include <tesla/base/Mutex.hpp>
 
 #include <algorithm>
 
 #include <assert.h>
 #include <dirent.h>
 #include <pwd.h>
+#include <sched.h>
 #include <stdio.h> // snprintf
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <sys/resource.h>
 #include <sys/times.h>
@@ -28,6 +31,9 @@ Timestamp g_startTime = Timestamp::now();
 int g_clockticks = static_cast<int>(::sysconf(_SC_CLK_TCK));
 int g_pagesize = static_cast<int>(::sysconf(_SC_PAGE_SIZE));
 
+MutexLock g_pinnedMutex;
+std::vector<ProcessInfo::PinnedThread> g_pinnedThreads;
+
 
 int fdDirFilter(const struct dirent* d)
 {
@@ -47,6 +53,17 @@ int taskDirFilter(const struct dirent* d)
     return 0;
 }
 
+// -1 if the file is missing
+int readSysInt(const char* path)
+{
+    string content;
+    if (readFile(path, 64, &content) != 0 || content.empty())
+    {
+        return -1;
+    }
+    return ::atoi(content.c_str());
+}
+
 int scanDir(const char *dirpath, int (*filter)(const struct dirent *))
 {
     struct dirent** namelist = NULL;
@@ -239,6 +256,120 @@ std::vector<pid_t> ProcessInfo::threads()
     return result;
 }
 
+std::vector<int> ProcessInfo::allowedCpus()
+{
+    std::vector<int> result;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (::sched_getaffinity(0, sizeof set, &set) == 0)
+    {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+        {
+            if (CPU_ISSET(cpu, &set))
+            {
+                result.push_back(cpu);
+            }
+        }
+    }
+    else
+    {
+        long n = ::sysconf(_SC_NPROCESSORS_ONLN);
+        for (int cpu = 0; cpu < n; ++cpu)
+        {
+            result.push_back(cpu);
+        }
+    }
+    return result;
+}
+
+int ProcessInfo::numaNodeOf(int cpu)
+{
+    // the cpu directory links to its node as "nodeN"
+    char path[64];
+    snprintf(path, sizeof path, "/sys/devices/system/cpu/cpu%d", cpu);
+    int node = 0;
+    DIR* dir = ::opendir(path);
+    if (dir)
+    {
+        struct dirent* d;
+        while ((d = ::readdir(dir)) != NULL)
+        {
+            if (::strncmp(d->d_name, "node", 4) == 0 && ::isdigit(d->d_name[4]))
+            {
+                node = ::atoi(d->d_name + 4);
+                break;
+            }
+        }
+        ::closedir(dir);
+    }
+    return node;
+}
+
+std::vector<int> ProcessInfo::physicalCores()
+{
+    std::vector<int> result;
+    std::vector<std::pair<int, int> > seen; // (package, core)
+    std::vector<int> cpus = allowedCpus();
+    for (size_t i = 0; i < cpus.size(); ++i)
+    {
+        char path[96];
+        snprintf(path, sizeof path,
+                 "/sys/devices/system/cpu/cpu%d/topology/physical_package_id", cpus[i]);
+        int package = readSysInt(path);
+        snprintf(path, sizeof path,
+                 "/sys/devices/system/cpu/cpu%d/topology/core_id", cpus[i]);
+        int core = readSysInt(path);
+        if (core < 0)
+        {
+            // no topology, every cpu counts as a core
+            result.push_back(cpus[i]);
+            continue;
+        }
+        std::pair<int, int> key(package, core);
+        if (std::find(seen.begin(), seen.end(), key) == seen.end())
+        {
+            seen.push_back(key);
+            result.push_back(cpus[i]);
+        }
+    }
+    return result;
+}
+
+std::vector<ProcessInfo::PinnedThread> ProcessInfo::pinnedThreads()
+{
+    MutexLockGuard lock(g_pinnedMutex);
+    return g_pinnedThreads;
+}
+
+void ProcessInfo::addPinnedThread(const PinnedThread& thread)
+{
+    MutexLockGuard lock(g_pinnedMutex);
+    for (size_t i = 0; i < g_pinnedThreads.size(); ++i)
+    {
+        if (g_pinnedThreads[i].tid == thread.tid)
+        {
+            g_pinnedThreads[i] = thread;
+            return;
+        }
+    }
+    g_pinnedThreads.push_back(thread);
+}
+
+string ProcessInfo::affinityPlan()
+{
+    std::vector<PinnedThread> threads = pinnedThreads();
+    string result;
+    for (size_t i = 0; i < threads.size(); ++i)
+    {
+        char buf[128];
+        snprintf(buf, sizeof buf, "%d %s cpu %d node %d\n",
+                 threads[i].tid, threads[i].name.c_str(),
+                 threads[i].cpu, threads[i].node);
+        result += buf;
+    }
+    return result;
+}
+
 } // namespace base
 
 } // namespace tesla
@@ -19,6 +19,8 @@
 #include <tesla/base/Timestamp.h>
 #include <vector>
 
+#include <sys/types.h>
+
 namespace tesla
 {
 
@@ -69,6 +71,26 @@ public:
     static int numOfThreads();
 
     static std::vector<pid_t> threads();
+
+    // cpus this process may run on, sched_getaffinity
+    static std::vector<int> allowedCpus();
+    // NUMA node of the cpu, 0 on a machine without NUMA
+    static int numaNodeOf(int cpu);
+    // one cpu of each physical core, from allowedCpus()
+    static std::vector<int> physicalCores();
+
+    // threads pinned by a CpuAffinity plan
+    struct PinnedThread
+    {
+        pid_t tid;
+        string name;
+        int cpu;
+        int node;
+    };
+    static std::vector<PinnedThread> pinnedThreads();
+    static void addPinnedThread(const PinnedThread& thread);
+    // one "tid name cpu node" line per pinned thread
+    static string affinityPlan();
 }; // class ProcessInfo
 
 } // namespace base
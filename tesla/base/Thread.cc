@@ -5,8 +5,10 @@
 
 #if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
 #include <memory>
+#include <type_traits>
 #else // __GXX_EXPERIMENTAL_CXX0X__
 #include <boost/weak_ptr.hpp>
+#include <boost/type_traits/is_same.hpp>
 #endif // __GXX_EXPERIMENTAL_CXX0X__
 
 #include <errno.h>
@@ -36,7 +38,7 @@ __thread int t_cachedTid;
 __thread char t_tidString[32];
 __thread const char* t_threadName;
 
-const bool sameType = boost::is_same<int, pid_t>::value;
+const bool sameType = is_same<int, pid_t>::value;
 BOOST_STATIC_ASSERT(sameType);
 
 pid_t gettid()
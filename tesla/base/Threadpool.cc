@@ -16,6 +16,13 @@ namespace tesla
 namespace base
 {
 
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+using std::bind;
+using namespace std::placeholders;
+#else // __GXX_EXPERIMENTAL_CXX0X__
+using boost::bind;
+#endif // __GXX_EXPERIMENTAL_CXX0X__
+
 ThreadPool::ThreadPool(const string& name)
     : mutex_(),
       notEmpty_(mutex_),
@@ -44,7 +51,7 @@ void ThreadPool::start(int numThreads)
         char id[32];
         snprintf(id, sizeof id, "%d", i+1);
         threads_.push_back(new Thread(
-                               boost::bind(&ThreadPool::runInThread, this), name_+id));
+                               bind(&ThreadPool::runInThread, this, i), name_+id));
         threads_[i].start();
     }
 }
@@ -58,7 +65,7 @@ void ThreadPool::stop()
     }
     for_each(threads_.begin(),
              threads_.end(),
-             boost::bind(&Thread::join, _1));
+             bind(&Thread::join, _1));
 }
 
 void ThreadPool::run(const Task& task)
@@ -81,7 +88,7 @@ void ThreadPool::run(const Task& task)
     }
 }
 
-#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __clpusplus >= 201103L
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
 void ThreadPool::run(Task&& task)
 {
     if (threads_.empty())
@@ -130,8 +137,9 @@ bool ThreadPool::isFull() const
     return maxQueueSize_ > 0 && queue_.size() >= maxQueueSize_;
 }
 
-void ThreadPool::runInThread()
+void ThreadPool::runInThread(int index)
 {
+    affinity_.apply(index);
     try
     {
         while (running_)
@@ -15,6 +15,7 @@
 #define TESLA_BASE_THREADPOOL_H
 
 #include <tesla/base/Condition.h>
+#include <tesla/base/CpuAffinity.h>
 #include <tesla/base/Mutex.hpp>
 #include <tesla/base/Thread.h>
 #include <tesla/base/Types.hpp>
@@ -54,6 +55,13 @@ public:
         maxQueueSize_ = maxSize;
     }
 
+    // Must be called before start().
+    // The i-th thread pins itself by the plan, see CpuAffinity.
+    void setAffinity(const CpuAffinity& affinity)
+    {
+        affinity_ = affinity;
+    }
+
     void start(int numThreads);
     void stop();
 
@@ -65,7 +73,7 @@ public:
 
 private:
     bool isFull() const;
-    void runInThread();
+    void runInThread(int index);
     Task take();
 
     MutexLock mutex_;
@@ -75,6 +83,7 @@ private:
     boost::ptr_vector<Thread> threads_;
     std::deque<Task> queue_;
     size_t maxQueueSize_;
+    CpuAffinity affinity_;
     bool running_;
 }; // class Threadpool
 
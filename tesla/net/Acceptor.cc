@@ -12,6 +12,7 @@
 #endif // __GXX_EXPERIMENTAL_CXX0X__
 
 #include <errno.h>
+#include <unistd.h>
 #include <fcntl.h>
 
 //#include <sys/types.h>
@@ -24,20 +25,29 @@ namespace net
 {
 
 using namespace tesla::base;
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+using std::bind;
+#else // __GXX_EXPERIMENTAL_CXX0X__
+using boost::bind;
+#endif // __GXX_EXPERIMENTAL_CXX0X__
 
 Acceptor::Acceptor(EventLoop* loop, const InetAddress& listenAddr, bool reuseport)
     : loop_(loop),
       acceptSocket_(SockOps::createNonblockingOrDie()),
       acceptChannel_(loop, acceptSocket_.fd()),
       listening_(false),
-      idleFd_(::open("/dev/null", O_RDONLY | O_CLOEXEC))
+      idleFd_(::open("/dev/null", O_RDONLY | O_CLOEXEC)),
+      maxAcceptsPerWakeup_(64),
+      lastAccepted_(0),
+      acceptWakeups_(0),
+      acceptedConnections_(0)
 {
     assert(idleFd_ >= 0);
     acceptSocket_.setReuseAddr(true);
     acceptSocket_.setReusePort(reuseport);
     acceptSocket_.bindAddress(listenAddr);
     acceptChannel_.setReadCallback(
-        boost::bind(&Acceptor::handleRead, this));
+        bind(&Acceptor::handleRead, this));
 }
 
 Acceptor::~Acceptor()
@@ -58,11 +68,23 @@ void Acceptor::listen()
 void Acceptor::handleRead()
 {
     loop_->assertInLoopThread();
+    // drains the backlog, the cap keeps other channels of this loop served
+    int64_t before = acceptedConnections_;
+    for (int i = 0; i < maxAcceptsPerWakeup_ && acceptOne(); ++i)
+    {
+    }
+    lastAccepted_ = static_cast<int>(acceptedConnections_ - before);
+    ++acceptWakeups_;
+    LOG_TRACE << "Acceptor::handleRead accepted " << lastAccepted_;
+}
+
+bool Acceptor::acceptOne()
+{
     InetAddress peerAddr;
-    //FIXME loop until no more
     int connfd = acceptSocket_.accept(&peerAddr);
     if (connfd >= 0)
     {
+        ++acceptedConnections_;
         // string hostport = peerAddr.toIpPort();
         // LOG_TRACE << "Accepts of " << hostport;
         if (newConnectionCallback_)
@@ -73,22 +95,29 @@ void Acceptor::handleRead()
         {
             close(connfd);
         }
+        return true;
     }
-    else
+
+    int savedErrno = errno;
+    if (savedErrno == EAGAIN)
     {
-        LOG_SYSERR << "in Acceptor::handleRead";
+        return false;  // drained
+    }
+    LOG_SYSERR << "in Acceptor::handleRead";
 
-        // Read the section named "The special problem of
-        // accept()ing when you can't" in libev's doc.
-        // By Marc Lehmann, author of livev.
-        if (errno == EMFILE)
-        {
-            ::close(idleFd_);
-            idleFd_ = ::accept(acceptSocket_.fd(), NULL, NULL);
-            ::close(idleFd_);
-            idleFd_ = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
-        }
+    // Read the section named "The special problem of
+    // accept()ing when you can't" in libev's doc.
+    // By Marc Lehmann, author of livev.
+    if (savedErrno == EMFILE)
+    {
+        ::close(idleFd_);
+        idleFd_ = ::accept(acceptSocket_.fd(), NULL, NULL);
+        ::close(idleFd_);
+        idleFd_ = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+        return false;
     }
+    // an aborted connection does not stop the draining
+    return savedErrno == ECONNABORTED || savedErrno == EINTR || savedErrno == EPROTO;
 }
 
 } // namespace net
@@ -26,6 +26,9 @@
 #include <tesla/net/Channel.h>
 #include <tesla/net/Socket.h>
 
+#include <assert.h>
+#include <stdint.h>
+
 namespace tesla
 {
 namespace net
@@ -56,14 +59,45 @@ public:
         newConnectionCallback_ = cb;
     }
 
+    EventLoop* getLoop() const
+    {
+        return loop_;
+    }
+
     bool listening() const
     {
         return listening_;
     }
     void listen();
 
+    /// At most @c n connections are accepted per readable event,
+    /// the rest wait for the next loop iteration. Default is 64.
+    void setMaxAcceptsPerWakeup(int n)
+    {
+        assert(n > 0);
+        maxAcceptsPerWakeup_ = n;
+    }
+
+    /// connections accepted by the last readable event
+    int lastAccepted() const
+    {
+        return lastAccepted_;
+    }
+    /// readable events handled, and connections accepted by them
+    int64_t acceptWakeups() const
+    {
+        return acceptWakeups_;
+    }
+    int64_t acceptedConnections() const
+    {
+        return acceptedConnections_;
+    }
+
 private:
     void handleRead();
+    /// Accepts one connection.
+    /// @return false if there is no more for now
+    bool acceptOne();
 
     EventLoop* loop_;
     Socket acceptSocket_;
@@ -71,6 +105,10 @@ private:
     NewConnectionCallback newConnectionCallback_;
     bool listening_;
     int idleFd_;
+    int maxAcceptsPerWakeup_;
+    int lastAccepted_;
+    int64_t acceptWakeups_;
+    int64_t acceptedConnections_;
 }; // class Acceptor
 
 } // namespace net
@@ -39,7 +39,8 @@ public:
     typedef std::vector<Channel*> ChannelList;
 
     Backend(EventLoop* loop)
-        : ownerLoop_(loop)
+        : savedSyscalls_(0),
+          ownerLoop_(loop)
     {}
     virtual ~Backend()
     {}
@@ -63,6 +64,16 @@ public:
         ownerLoop_->assertInLoopThread();
     }
 
+    /// How many interest updates never reached the kernel,
+    /// because they were merged with or cancelled by later ones.
+    int64_t savedSyscalls() const
+    {
+        return savedSyscalls_;
+    }
+
+protected:
+    int64_t savedSyscalls_;
+
 private:
     EventLoop* ownerLoop_;
 };
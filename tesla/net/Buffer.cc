@@ -15,39 +15,139 @@ using namespace tesla::base;
 const char Buffer::CRLF[] = "\r\n";
 const size_t Buffer::CHEAP_PERPEND;
 const size_t Buffer::INITIAL_SIZE;
+char Buffer::releasedStorage_[CHEAP_PERPEND];
 
-ssize_t Buffer::readFd(int fd, int* savedErrno)
+Buffer::Buffer(const Buffer& rhs)
+    : buffer_(releasedStorage_),
+      capacity_(CHEAP_PERPEND),
+      readerIndex_(CHEAP_PERPEND),
+      writerIndex_(CHEAP_PERPEND)
 {
-    // saved an ioctl()/FIONREAD call to tell how much to read
-    char extrabuf[65536];
-    struct iovec vec[2];
-    const size_t writable = writableBytes();
-    vec[0].iov_base = begin()+writerIndex_;
-    vec[0].iov_len = writable;
-    vec[1].iov_base = extrabuf;
-    vec[1].iov_len = sizeof extrabuf;
-    // when there is enough space in this buffer, don't read into extrabuf.
-    // by doing this, we read 128k-1 bytes at most
-    const int iovcnt = (writable < sizeof extrabuf) ? 2 : 1;
-    const ssize_t n = readv(fd, vec, iovcnt);
-    if (n < 0)
+    if (rhs.buffer_ != releasedStorage_)
+    {
+        buffer_ = BufferPool::allocate(rhs.capacity_, &capacity_);
+        readerIndex_ = rhs.readerIndex_;
+        writerIndex_ = rhs.writerIndex_;
+        ::memcpy(buffer_ + readerIndex_, rhs.peek(), rhs.readableBytes());
+    }
+}
+
+Buffer& Buffer::operator=(const Buffer& rhs)
+{
+    Buffer copy(rhs);
+    swap(copy);
+    return *this;
+}
+
+bool Buffer::release()
+{
+    if (buffer_ == releasedStorage_)
     {
-        *savedErrno = errno;
+        return true;
     }
-    else if (implicit_cast<size_t>(n) <= writable)
+    if (readableBytes() != 0)
     {
-        writerIndex_ += n;
+        return false;
     }
-    else
+    BufferPool::release(buffer_, capacity_);
+    buffer_ = releasedStorage_;
+    capacity_ = CHEAP_PERPEND;
+    readerIndex_ = CHEAP_PERPEND;
+    writerIndex_ = CHEAP_PERPEND;
+    return true;
+}
+
+void Buffer::grow(size_t len)
+{
+    size_t readable = readableBytes();
+    // doubles at least, as vector::resize() did
+    size_t wanted = std::max(CHEAP_PERPEND + readable + len, 2 * capacity_);
+    if (buffer_ == releasedStorage_)
     {
-        writerIndex_ = buffer_.size();
-        append(extrabuf, n - writable);
+        wanted = std::max(CHEAP_PERPEND + len, CHEAP_PERPEND + INITIAL_SIZE);
     }
-    // if (n == writable + sizeof extrabuf)
-    // {
-    //   goto line_30;
-    // }
-    return n;
+    size_t capacity = 0;
+    char* storage = BufferPool::allocate(wanted, &capacity);
+    ::memcpy(storage + CHEAP_PERPEND, peek(), readable);
+    if (buffer_ != releasedStorage_)
+    {
+        BufferPool::release(buffer_, capacity_);
+    }
+    buffer_ = storage;
+    capacity_ = capacity;
+    readerIndex_ = CHEAP_PERPEND;
+    writerIndex_ = CHEAP_PERPEND + readable;
+}
+
+ssize_t Buffer::readFd(int fd, int* savedErrno, Buffer* spare, size_t maxBytes)
+{
+    assert(spare->readableBytes() == 0);
+    // saved an ioctl()/FIONREAD call to tell how much to read
+    const size_t spareSize = spare->writableBytes();
+    ssize_t total = 0;
+    for (;;)
+    {
+        // a splice of the last round took the spare storage
+        spare->ensureWritableBytes(spareSize);
+        const size_t writable = writableBytes();
+        const size_t held = readableBytes() + writable;
+        // splices only if most of the spare is left for the overflow
+        const bool splice = held <= spare->writableBytes() / 2;
+        char* overflow = spare->beginWrite() + (splice ? held : 0);
+        struct iovec vec[2];
+        vec[0].iov_base = beginWrite();
+        vec[0].iov_len = writable;
+        vec[1].iov_base = overflow;
+        vec[1].iov_len = spare->writableBytes() - (splice ? held : 0);
+        // when there is enough space in this buffer, don't read into spare.
+        const int iovcnt = (writable < spareSize) ? 2 : 1;
+        const ssize_t n = readv(fd, vec, iovcnt);
+        if (n <= 0)
+        {
+            if (total > 0)
+            {
+                // EAGAIN, or the EOF or error is seen on the next event
+                return total;
+            }
+            if (n < 0)
+            {
+                *savedErrno = errno;
+            }
+            return n;
+        }
+
+        total += n;
+        if (implicit_cast<size_t>(n) <= writable)
+        {
+            writerIndex_ += n;
+        }
+        else if (splice)
+        {
+            ::memcpy(spare->beginWrite(), peek(), held);
+            spare->writerIndex_ += held + (n - writable);
+            swap(*spare);
+            spare->retrieveAll();
+        }
+        else
+        {
+            writerIndex_ = capacity_;
+            append(overflow, n - writable);
+        }
+
+        const size_t offered = writable + (iovcnt == 2 ? vec[1].iov_len : 0);
+        if (implicit_cast<size_t>(n) < offered
+                || implicit_cast<size_t>(total) >= maxBytes)
+        {
+            return total;
+        }
+    }
+}
+
+ssize_t Buffer::readFd(int fd, int* savedErrno)
+{
+    Buffer spare;
+    spare.ensureWritableBytes(BufferPool::MAX_CHUNK_SIZE - CHEAP_PERPEND);
+    return readFd(fd, savedErrno, &spare, 0);
 }
 
 } // namespace net
@@ -15,14 +15,15 @@
 #ifndef TESLA_NET_BUFFER_H
 #define TESLA_NET_BUFFER_H
 
+#include <tesla/base/ByteSearch.h>
 #include <tesla/base/Copyable.hpp>
 #include <tesla/base/StringPiece.hpp>
 #include <tesla/base/Types.hpp>
 
+#include <tesla/net/BufferPool.h>
 #include <tesla/net/Endian.hpp>
 
 #include <algorithm>
-#include <vector>
 
 #include <assert.h>
 #include <string.h>
@@ -43,15 +44,20 @@ namespace net
 /// |                   |                  |                  |
 /// 0      <=      readerIndex   <=   writerIndex    <=     size
 /// @endcode
+///
+/// The storage is a chunk of the thread's BufferPool, release()
+/// gives it back while the buffer is empty, the next write takes
+/// a new one.
 class Buffer
     : public tesla::base::Copyable
 {
 public:
     static const size_t CHEAP_PERPEND = 8;
-    static const size_t INITIAL_SIZE = 1024;
+    /// the initial storage is a 1k chunk
+    static const size_t INITIAL_SIZE = BufferPool::MIN_CHUNK_SIZE - CHEAP_PERPEND;
 
     Buffer()
-        : buffer_(CHEAP_PERPEND + INITIAL_SIZE),
+        : buffer_(BufferPool::allocate(CHEAP_PERPEND + INITIAL_SIZE, &capacity_)),
           readerIndex_(CHEAP_PERPEND),
           writerIndex_(CHEAP_PERPEND)
     {
@@ -60,12 +66,31 @@ public:
         assert(prependableBytes() == CHEAP_PERPEND);
     }
 
-    // implicit copy-ctor, move-ctor, dtor and assignment are fine
-    // NOTE: implicit move-ctor is added in g++ 4.6
+    Buffer(const Buffer& rhs);
+    Buffer& operator=(const Buffer& rhs);
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+    Buffer(Buffer&& rhs)
+        : buffer_(releasedStorage_),
+          capacity_(CHEAP_PERPEND),
+          readerIndex_(CHEAP_PERPEND),
+          writerIndex_(CHEAP_PERPEND)
+    {
+        swap(rhs);
+    }
+#endif
+
+    ~Buffer()
+    {
+        if (buffer_ != releasedStorage_)
+        {
+            BufferPool::release(buffer_, capacity_);
+        }
+    }
 
     void swap(Buffer& rhs)
     {
-        buffer_.swap(rhs.buffer_);
+        std::swap(buffer_, rhs.buffer_);
+        std::swap(capacity_, rhs.capacity_);
         std::swap(readerIndex_, rhs.readerIndex_);
         std::swap(writerIndex_, rhs.writerIndex_);
     }
@@ -77,7 +102,7 @@ public:
 
     size_t writableBytes() const
     {
-        return buffer_.size() - writerIndex_;
+        return capacity_ - writerIndex_;
     }
 
     size_t prependableBytes() const
@@ -92,30 +117,74 @@ public:
 
     const char* findCRLF() const
     {
-        const char* crlf = std::search(peek(), beginWrite(), CRLF, CRLF+2);
-        return crlf == beginWrite() ? NULL : crlf;
+        return tesla::base::ByteSearch::findCRLF(peek(), beginWrite());
     }
 
     const char* findCRLF(const char* start) const
     {
         assert(peek() <= start);
         assert(start <= beginWrite());
-        const char* crlf = std::search(start, beginWrite(), CRLF, CRLF+2);
-        return crlf == beginWrite() ? NULL : crlf;
+        return tesla::base::ByteSearch::findCRLF(start, beginWrite());
     }
 
     const char* findEOL() const
     {
-        const void* eol = memchr(peek(), '\n', readableBytes());
-        return static_cast<const char*>(eol);
+        return tesla::base::ByteSearch::findByte(peek(), beginWrite(), '\n');
     }
 
     const char* findEOL(const char* start) const
     {
         assert(peek() <= start);
         assert(start <= beginWrite());
-        const void* eol = memchr(start, '\n', readableBytes());
-        return static_cast<const char*>(eol);
+        return tesla::base::ByteSearch::findByte(start, beginWrite(), '\n');
+    }
+
+    const char* find(const tesla::base::StringPiece& needle) const
+    {
+        return tesla::base::ByteSearch::find(peek(), beginWrite(), needle.data(), needle.size());
+    }
+
+    const char* find(const char* start, const tesla::base::StringPiece& needle) const
+    {
+        assert(peek() <= start);
+        assert(start <= beginWrite());
+        return tesla::base::ByteSearch::find(start, beginWrite(), needle.data(), needle.size());
+    }
+
+    ///
+    /// Resumable searches, for frames that arrive in pieces.
+    /// @c scanned counts the bytes from peek() that were searched
+    /// already, the search goes on from there, and on a miss it is
+    /// moved up to where a match could still start.
+    /// Start it at 0, and set it back to 0 after a retrieve.
+    ///
+    const char* resumeFindCRLF(size_t* scanned) const
+    {
+        return resumeFind(tesla::base::StringPiece(CRLF, 2), scanned);
+    }
+
+    const char* resumeFindEOL(size_t* scanned) const
+    {
+        assert(*scanned <= readableBytes());
+        const char* eol = tesla::base::ByteSearch::findByte(peek() + *scanned, beginWrite(), '\n');
+        *scanned = eol == NULL ? readableBytes() : eol - peek();
+        return eol;
+    }
+
+    const char* resumeFind(const tesla::base::StringPiece& needle, size_t* scanned) const
+    {
+        assert(*scanned <= readableBytes());
+        const char* found = tesla::base::ByteSearch::find(peek() + *scanned, beginWrite(),
+                                             needle.data(), needle.size());
+        if (found != NULL)
+        {
+            *scanned = found - peek();
+        }
+        else if (readableBytes() >= static_cast<size_t>(needle.size()))
+        {
+            *scanned = readableBytes() - needle.size() + 1;
+        }
+        return found;
     }
 
     // retrieve returns void, to prevent
@@ -141,6 +210,11 @@ public:
         retrieve(end - peek());
     }
 
+    void retrieveInt64()
+    {
+        retrieve(sizeof(int64_t));
+    }
+
     void retrieveInt32()
     {
         retrieve(sizeof(int32_t));
@@ -228,6 +302,15 @@ public:
         writerIndex_ -= len;
     }
 
+    ///
+    /// Append int64_t using network endian
+    ///
+    void appendInt64(int64_t x)
+    {
+        int64_t be64 = hostToNetwork64(x);
+        append(&be64, sizeof be64);
+    }
+
     ///
     /// Append int32_t using network endian
     ///
@@ -248,6 +331,17 @@ public:
         append(&x, sizeof x);
     }
 
+    ///
+    /// Read int64_t from network endian
+    ///
+    /// Require: buf->readableBytes() >= sizeof(int64_t)
+    int64_t readInt64()
+    {
+        int64_t result = peekInt64();
+        retrieveInt64();
+        return result;
+    }
+
     ///
     /// Read int32_t from network endian
     ///
@@ -273,6 +367,18 @@ public:
         return result;
     }
 
+    ///
+    /// Peek int64_t from network endian
+    ///
+    /// Require: buf->readableBytes() >= sizeof(int64_t)
+    int64_t peekInt64() const
+    {
+        assert(readableBytes() >= sizeof(int64_t));
+        int64_t be64 = 0;
+        ::memcpy(&be64, peek(), sizeof be64);
+        return networkToHost64(be64);
+    }
+
     ///
     /// Peek int32_t from network endian
     ///
@@ -300,6 +406,15 @@ public:
         return x;
     }
 
+    ///
+    /// Prepend int64_t using network endian
+    ///
+    void prependInt64(int64_t x)
+    {
+        int64_t be64 = hostToNetwork64(x);
+        prepend(&be64, sizeof be64);
+    }
+
     ///
     /// Prepend int32_t using network endian
     ///
@@ -323,6 +438,10 @@ public:
     void prepend(const void* /*restrict*/ data, size_t len)
     {
         assert(len <= prependableBytes());
+        if (buffer_ == releasedStorage_)
+        {
+            makeSpace(0);
+        }
         readerIndex_ -= len;
         const char* d = static_cast<const char*>(data);
         std::copy(d, d+len, begin()+readerIndex_);
@@ -339,33 +458,45 @@ public:
 
     size_t internalCapacity() const
     {
-        return buffer_.capacity();
+        return buffer_ == releasedStorage_ ? 0 : capacity_;
     }
 
+    /// Gives the storage back to the BufferPool if nothing is readable,
+    /// for idle connections.
+    /// @return whether the storage is released
+    bool release();
+
     /// Read data directly into buffer.
     ///
-    /// It may implement with readv(2)
-    /// @return result of read(2), @c errno is saved
+    /// What does not fit goes to the writable space of @c spare,
+    /// see EventLoop::readBuffer(). If that leaves room in front for
+    /// what this buffer holds, the held data is moved there and the
+    /// storages are swapped, so the overflow itself is not copied.
+    /// Reads again while a read fills all the room it is given,
+    /// until EAGAIN or @c maxBytes are read, 0 reads once.
+    /// @return bytes read, or result of the first readv(2), @c errno is saved
+    ssize_t readFd(int fd, int* savedErrno, Buffer* spare, size_t maxBytes);
+    /// Reads once, the overflow goes to a 64k chunk of the BufferPool.
     ssize_t readFd(int fd, int* savedErrno);
 
 private:
 
     char* begin()
     {
-        return &*buffer_.begin();
+        return buffer_;
     }
 
     const char* begin() const
     {
-        return &*buffer_.begin();
+        return buffer_;
     }
 
     void makeSpace(size_t len)
     {
-        if (writableBytes() + prependableBytes() < len + CHEAP_PERPEND)
+        if (writableBytes() + prependableBytes() < len + CHEAP_PERPEND
+                || buffer_ == releasedStorage_)
         {
-            // FIXME: move readable data
-            buffer_.resize(writerIndex_+len);
+            grow(len);
         }
         else
         {
@@ -381,12 +512,18 @@ private:
         }
     }
 
+    /// moves the readable bytes into a larger chunk
+    void grow(size_t len);
+
 private:
-    std::vector<char> buffer_;
+    char* buffer_;
+    size_t capacity_;
     size_t readerIndex_;
     size_t writerIndex_;
 
     static const char CRLF[];
+    /// storage of released buffers, never written
+    static char releasedStorage_[CHEAP_PERPEND];
 };
 
 } // namespace net
@@ -0,0 +1,204 @@
+#include <tesla/base/Logger.h>
+
+#include <tesla/net/BufferChain.h>
+#include <tesla/net/SockOps.h>
+
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+namespace tesla
+{
+
+namespace net
+{
+
+using namespace tesla::base;
+
+const int BufferChain::MAX_IOVECS;
+const size_t BufferChain::MAX_SENDFILE_BYTES;
+
+void BufferChain::append(const char* data, size_t len)
+{
+    if (segments_.empty() || !segments_.back().buffer)
+    {
+        segments_.push_back(Segment());
+        segments_.back().buffer.reset(new Buffer);
+    }
+    segments_.back().buffer->append(data, len);
+    readableBytes_ += len;
+}
+
+void BufferChain::append(const Slice& slice)
+{
+    if (slice.empty())
+    {
+        return;
+    }
+    segments_.push_back(Segment());
+    segments_.back().slice = slice;
+    readableBytes_ += slice.size();
+}
+
+void BufferChain::append(const FileRegion& file)
+{
+    if (file.empty())
+    {
+        return;
+    }
+    segments_.push_back(Segment());
+    segments_.back().file = file;
+    readableBytes_ += file.size();
+}
+
+void BufferChain::retrieve(size_t len)
+{
+    assert(len <= readableBytes_);
+    readableBytes_ -= len;
+    while (len > 0)
+    {
+        Segment& front = segments_.front();
+        size_t readable = front.readableBytes();
+        if (len < readable)
+        {
+            if (front.buffer)
+            {
+                front.buffer->retrieve(len);
+            }
+            else if (front.isFile())
+            {
+                front.file.removePrefix(len);
+            }
+            else
+            {
+                front.slice.removePrefix(len);
+            }
+            break;
+        }
+        len -= readable;
+        if (segments_.size() == 1 && front.buffer)
+        {
+            // keep the last buffer for following appends
+            front.buffer->retrieveAll();
+        }
+        else
+        {
+            segments_.pop_front();
+        }
+    }
+}
+
+void BufferChain::retrieveAll()
+{
+    segments_.clear();
+    readableBytes_ = 0;
+}
+
+bool BufferChain::release()
+{
+    if (readableBytes_ != 0)
+    {
+        return false;
+    }
+    std::deque<Segment>().swap(segments_);
+    return true;
+}
+
+ssize_t BufferChain::writeFd(int fd, int* savedErrno)
+{
+    std::deque<Segment>::const_iterator it = segments_.begin();
+    while (it != segments_.end() && it->readableBytes() == 0)
+    {
+        ++it;
+    }
+    if (it != segments_.end() && it->isFile())
+    {
+        return writeFile(fd, savedErrno);
+    }
+
+    struct iovec vec[MAX_IOVECS];
+    int iovcnt = 0;
+    size_t gathered = 0;
+    for (; it != segments_.end() && !it->isFile() && iovcnt < MAX_IOVECS; ++it)
+    {
+        StringPiece data = it->buffer ? it->buffer->toStringPiece()
+                           : it->slice.toStringPiece();
+        if (data.empty())
+        {
+            continue;
+        }
+        vec[iovcnt].iov_base = const_cast<char*>(data.data());
+        vec[iovcnt].iov_len = data.size();
+        gathered += data.size();
+        ++iovcnt;
+    }
+
+    ssize_t n;
+    bool fileNext = it != segments_.end() && it->isFile();
+    if (fileNext)
+    {
+        // MSG_MORE, so that a header and the file fill the same segments
+        struct msghdr msg;
+        ::memset(&msg, 0, sizeof msg);
+        msg.msg_iov = vec;
+        msg.msg_iovlen = iovcnt;
+        n = ::sendmsg(fd, &msg, MSG_MORE);
+    }
+    else
+    {
+        n = SockOps::writev(fd, vec, iovcnt);
+    }
+    if (n < 0)
+    {
+        *savedErrno = errno;
+        return n;
+    }
+
+    retrieve(n);
+    if (fileNext && implicit_cast<size_t>(n) == gathered)
+    {
+        int fileErrno = 0;
+        ssize_t nfile = writeFile(fd, &fileErrno);
+        if (nfile > 0)
+        {
+            n += nfile;
+        }
+    }
+    return n;
+}
+
+ssize_t BufferChain::writeFile(int fd, int* savedErrno)
+{
+    std::deque<Segment>::iterator it = segments_.begin();
+    while (it->readableBytes() == 0)
+    {
+        ++it;
+    }
+    assert(it->isFile());
+
+    FileRegion file(it->file);
+    ssize_t n = file.sendTo(fd, MAX_SENDFILE_BYTES);
+    if (n < 0)
+    {
+        *savedErrno = errno;
+    }
+    else if (n == 0)
+    {
+        // the file is shorter than the region, the peer sees
+        // a short body rather than the loop spinning on it
+        LOG_WARN << "BufferChain::writeFile file of fd " << file.fd()
+                 << " ends " << file.size() << " bytes early";
+        n = static_cast<ssize_t>(file.size());
+        retrieve(file.size());
+    }
+    else
+    {
+        retrieve(n);
+    }
+    return n;
+}
+
+} // namespace net
+
+} // namespace tesla
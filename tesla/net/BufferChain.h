@@ -0,0 +1,115 @@
+/*
+ *
+ * Author:
+ *     Thomas Liu
+ * Date:
+ *     10/18/2026
+ * Description:
+ *     Segmented output queue, drained with writev(2)
+ *
+ *
+ * Licensed under the Apache License, Version 2.0
+ *
+ */
+
+#ifndef TESLA_NET_BUFFERCHAIN_H
+#define TESLA_NET_BUFFERCHAIN_H
+
+#include <tesla/base/Noncopyable.hpp>
+
+#include <tesla/net/Buffer.h>
+#include <tesla/net/FileRegion.h>
+#include <tesla/net/Slice.hpp>
+
+#include <boost/shared_ptr.hpp>
+
+#include <deque>
+
+namespace tesla
+{
+namespace net
+{
+
+///
+/// A list of segments waiting to be written.
+///
+/// Small writes are copied into a Buffer segment at the tail,
+/// Slices are queued as they are, sharing their bytes,
+/// and file regions are sent by the kernel.
+/// Nothing is moved around when the head is partially written.
+class BufferChain
+    : private tesla::base::Noncopyable
+{
+public:
+    BufferChain()
+        : readableBytes_(0)
+    {
+    }
+
+    size_t readableBytes() const
+    {
+        return readableBytes_;
+    }
+
+    size_t numSegments() const
+    {
+        return segments_.size();
+    }
+
+    /// Copies into the tail segment.
+    void append(const char* /*restrict*/ data, size_t len);
+
+    /// Queues the slice, no copy.
+    void append(const Slice& slice);
+    /// Queues the file region, sent with sendfile(2) in its turn.
+    void append(const FileRegion& file);
+
+    void retrieve(size_t len);
+    void retrieveAll();
+
+    /// Frees the kept tail buffer if nothing is queued, see Buffer::release().
+    /// @return whether it is empty
+    bool release();
+
+    /// Writes as many segments as possible with one writev(2),
+    /// then a file region right behind them with one sendfile(2),
+    /// and retrieves what has been written.
+    /// @return bytes written, or the error of the first call, @c errno is saved,
+    /// the bytes of a file region ending early count as written, being dropped
+    ssize_t writeFd(int fd, int* savedErrno);
+
+private:
+    static const int MAX_IOVECS = 64;
+    /// per sendfile(2), so that one file does not hold up the loop
+    static const size_t MAX_SENDFILE_BYTES = 1024 * 1024;
+
+    /// the file region at the head, dropped if the file ends early
+    ssize_t writeFile(int fd, int* savedErrno);
+
+    /// one of buffer, slice and file is used, in this order.
+    struct Segment
+    {
+        boost::shared_ptr<Buffer> buffer; // copied bytes, appendable at the tail
+        Slice slice;                      // shared bytes
+        FileRegion file;                  // bytes of a file
+
+        bool isFile() const
+        {
+            return !buffer && slice.empty() && !file.empty();
+        }
+        size_t readableBytes() const
+        {
+            return buffer ? buffer->readableBytes()
+                   : isFile() ? file.size() : slice.size();
+        }
+    };
+
+    std::deque<Segment> segments_;
+    size_t readableBytes_;
+}; // class BufferChain
+
+} // namespace net
+
+} // namespace tesla
+
+#endif  // TESLA_NET_BUFFERCHAIN_H
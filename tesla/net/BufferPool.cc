@@ -0,0 +1,105 @@
+#include <tesla/base/ThreadLocalSingleton.hpp>
+
+#include <tesla/net/BufferPool.h>
+
+#include <new>
+
+#include <assert.h>
+
+namespace tesla
+{
+
+namespace net
+{
+
+using namespace tesla::base;
+
+const size_t BufferPool::MIN_CHUNK_SIZE;
+const size_t BufferPool::MAX_CHUNK_SIZE;
+const size_t BufferPool::MAX_CACHED_BYTES;
+const int BufferPool::CLASSES;
+
+BufferPool::BufferPool()
+    : cachedBytes_(0),
+      reusedChunks_(0)
+{
+}
+
+BufferPool::~BufferPool()
+{
+    for (int i = 0; i < CLASSES; ++i)
+    {
+        for (size_t j = 0; j < freeChunks_[i].size(); ++j)
+        {
+            ::operator delete(freeChunks_[i][j]);
+        }
+    }
+}
+
+int BufferPool::classOf(size_t capacity)
+{
+    int sizeClass = 0;
+    size_t chunkSize = MIN_CHUNK_SIZE;
+    while (chunkSize < capacity)
+    {
+        chunkSize <<= 1;
+        ++sizeClass;
+    }
+    return sizeClass;
+}
+
+char* BufferPool::allocate(size_t size, size_t* capacity)
+{
+    if (size > MAX_CHUNK_SIZE)
+    {
+        *capacity = size;
+        return static_cast<char*>(::operator new(size));
+    }
+
+    int sizeClass = classOf(size);
+    *capacity = MIN_CHUNK_SIZE << sizeClass;
+    BufferPool& pool = ThreadLocalSingleton<BufferPool>::instance();
+    std::vector<char*>& chunks = pool.freeChunks_[sizeClass];
+    if (!chunks.empty())
+    {
+        char* chunk = chunks.back();
+        chunks.pop_back();
+        pool.cachedBytes_ -= *capacity;
+        ++pool.reusedChunks_;
+        return chunk;
+    }
+    return static_cast<char*>(::operator new(*capacity));
+}
+
+void BufferPool::release(char* chunk, size_t capacity)
+{
+    if (capacity > MAX_CHUNK_SIZE)
+    {
+        ::operator delete(chunk);
+        return;
+    }
+
+    assert(capacity == MIN_CHUNK_SIZE << classOf(capacity));
+    BufferPool& pool = ThreadLocalSingleton<BufferPool>::instance();
+    if (pool.cachedBytes_ + capacity > MAX_CACHED_BYTES)
+    {
+        ::operator delete(chunk);
+        return;
+    }
+    pool.freeChunks_[classOf(capacity)].push_back(chunk);
+    pool.cachedBytes_ += capacity;
+}
+
+size_t BufferPool::cachedBytes()
+{
+    return ThreadLocalSingleton<BufferPool>::instance().cachedBytes_;
+}
+
+int64_t BufferPool::reusedChunks()
+{
+    return ThreadLocalSingleton<BufferPool>::instance().reusedChunks_;
+}
+
+} // namespace net
+
+} // namespace tesla
@@ -0,0 +1,74 @@
+/*
+ *
+ * Author:
+ *     Thomas Liu
+ * Date:
+ *     10/18/2026
+ * Description:
+ *     Per-thread pool of power-of-two chunks for Buffer
+ *
+ *
+ * Licensed under the Apache License, Version 2.0
+ *
+ */
+
+#ifndef TESLA_NET_BUFFERPOOL_H
+#define TESLA_NET_BUFFERPOOL_H
+
+#include <tesla/base/Noncopyable.hpp>
+
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace tesla
+{
+
+namespace net
+{
+
+///
+/// Chunks of 1k, 2k, ... 64k bytes cached per thread,
+/// larger ones come from the heap.
+///
+/// A chunk may be released in another thread than the one that
+/// allocated it, it is then cached by the releasing thread.
+/// Each thread caches at most MAX_CACHED_BYTES, the rest goes
+/// back to the heap, so released memory does not pile up here.
+class BufferPool
+    : private tesla::base::Noncopyable
+{
+public:
+    static const size_t MIN_CHUNK_SIZE = 1024;
+    static const size_t MAX_CHUNK_SIZE = 64 * 1024;
+    static const size_t MAX_CACHED_BYTES = 4 * 1024 * 1024;
+
+    /// A chunk of at least @c size bytes, @c *capacity is set to its size.
+    static char* allocate(size_t size, size_t* capacity);
+    /// Gives back a chunk of allocate().
+    static void release(char* chunk, size_t capacity);
+
+    /// of the calling thread
+    static size_t cachedBytes();
+    static int64_t reusedChunks();
+
+    /// for ThreadLocalSingleton, use the static functions
+    BufferPool();
+    ~BufferPool();
+
+private:
+    static const int CLASSES = 7; // 1k to 64k
+
+    static int classOf(size_t capacity);
+
+    std::vector<char*> freeChunks_[CLASSES];
+    size_t cachedBytes_;
+    int64_t reusedChunks_;
+}; // class BufferPool
+
+} // namespace net
+
+} // namespace tesla
+
+#endif  // TESLA_NET_BUFFERPOOL_H
@@ -38,7 +38,7 @@ class TcpConnection;
 // see License in tesla/base/Types.hpp
 template<typename To, typename From>
 #if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
-inline std::shared_ptr<To> down_pointer_cast(const ::boost::shared_ptr<From>& f)
+inline std::shared_ptr<To> down_pointer_cast(const std::shared_ptr<From>& f)
 #else // __GXX_EXPERIMENTAL_CXX0X__
 inline boost::shared_ptr<To> down_pointer_cast(const ::boost::shared_ptr<From>& f)
 #endif // __GXX_EXPERIMENTAL_CXX0X__
@@ -49,7 +49,7 @@ inline boost::shared_ptr<To> down_pointer_cast(const ::boost::shared_ptr<From>&
     }
 
 #ifndef NDEBUG
-    assert(f == NULL || dynamic_cast<To*>(get_pointer(f)) != NULL);
+    assert(f == NULL || dynamic_cast<To*>(f.get()) != NULL);
 #endif
 #if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
     return std::static_pointer_cast<To>(f);
@@ -59,8 +59,23 @@ inline boost::shared_ptr<To> down_pointer_cast(const ::boost::shared_ptr<From>&
 }
 
 // All client visible callbacks go here.
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+typedef std::shared_ptr<TcpConnection> TcpConnectionPtr;
+typedef std::function<void()> TimerCallback;
+typedef std::function<void (int signo)> SignalCallback;
+typedef std::function<void (const TcpConnectionPtr&)> ConnectionCallback;
+typedef std::function<void (const TcpConnectionPtr&)> CloseCallback;
+typedef std::function<void (const TcpConnectionPtr&)> WriteCompleteCallback;
+typedef std::function<void (const TcpConnectionPtr&, size_t)> HighWaterMarkCallback;
+
+// the data has been read to (buf, len)
+typedef std::function<void (const TcpConnectionPtr&,
+                            Buffer*,
+                            tesla::base::Timestamp)> MessageCallback;
+#else // __GXX_EXPERIMENTAL_CXX0X__
 typedef boost::shared_ptr<TcpConnection> TcpConnectionPtr;
 typedef boost::function<void()> TimerCallback;
+typedef boost::function<void (int signo)> SignalCallback;
 typedef boost::function<void (const TcpConnectionPtr&)> ConnectionCallback;
 typedef boost::function<void (const TcpConnectionPtr&)> CloseCallback;
 typedef boost::function<void (const TcpConnectionPtr&)> WriteCompleteCallback;
@@ -70,6 +85,7 @@ typedef boost::function<void (const TcpConnectionPtr&, size_t)> HighWaterMarkCal
 typedef boost::function<void (const TcpConnectionPtr&,
                               Buffer*,
                               tesla::base::Timestamp)> MessageCallback;
+#endif // __GXX_EXPERIMENTAL_CXX0X__
 
 void defaultConnectionCallback(const TcpConnectionPtr& conn);
 void defaultMessageCallback(const TcpConnectionPtr& conn,
@@ -14,7 +14,7 @@ namespace net
 
 using namespace tesla::base;
 #if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
-using str::shared_ptr;
+using std::shared_ptr;
 #else // __GXX_EXPERIMENTAL_CXX0X__
 using boost::shared_ptr;
 #endif // __GXX_EXPERIMENTAL_CXX0X__
@@ -40,7 +40,11 @@ Channel::~Channel()
     assert(!eventHandling_);
 }
 
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+void Channel::tie(const std::shared_ptr<void>& obj)
+#else // __GXX_EXPERIMENTAL_CXX0X__
 void Channel::tie(const boost::shared_ptr<void>& obj)
+#endif // __GXX_EXPERIMENTAL_CXX0X__
 {
     tie_ = obj;
     tied_ = true;
@@ -61,7 +65,11 @@ void Channel::handleEvent(Timestamp receiveTime)
 {
     if (tied_)
     {
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+        std::shared_ptr<void> guard(tie_.lock());
+#else // __GXX_EXPERIMENTAL_CXX0X__
         boost::shared_ptr<void> guard(tie_.lock());
+#endif // __GXX_EXPERIMENTAL_CXX0X__
         if (guard)
         {
             handleEventWithGuard(receiveTime);
@@ -207,7 +207,11 @@ private:
 
     /// shared_ptr object helper
     bool tied_;
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+    std::weak_ptr<void> tie_;
+#else // __GXX_EXPERIMENTAL_CXX0X__
     boost::weak_ptr<void> tie_;
+#endif // __GXX_EXPERIMENTAL_CXX0X__
 
     /// whether we are handling events now
     bool eventHandling_;
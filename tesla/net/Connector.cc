@@ -12,6 +12,7 @@
 #endif // __GXX_EXPERIMENTAL_CXX0X__
 
 #include <errno.h>
+#include <unistd.h>
 
 namespace tesla
 {
@@ -20,6 +21,11 @@ namespace net
 {
 
 using namespace tesla::base;
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+using std::bind;
+#else // __GXX_EXPERIMENTAL_CXX0X__
+using boost::bind;
+#endif // __GXX_EXPERIMENTAL_CXX0X__
 
 const int Connector::MAX_RETRY_DELAY_MS;
 
@@ -42,7 +48,7 @@ Connector::~Connector()
 void Connector::start()
 {
     connect_ = true;
-    loop_->runInLoop(boost::bind(&Connector::startInLoop, this)); // FIXME: unsafe
+    loop_->runInLoop(bind(&Connector::startInLoop, this)); // FIXME: unsafe
 }
 
 void Connector::startInLoop()
@@ -62,7 +68,7 @@ void Connector::startInLoop()
 void Connector::stop()
 {
     connect_ = false;
-    loop_->queueInLoop(boost::bind(&Connector::stopInLoop, this)); // FIXME: unsafe
+    loop_->queueInLoop(bind(&Connector::stopInLoop, this)); // FIXME: unsafe
     // FIXME: cancel timer
 }
 
@@ -133,9 +139,9 @@ void Connector::connecting(int sockfd)
     assert(!channel_);
     channel_.reset(new Channel(loop_, sockfd));
     channel_->setWriteCallback(
-        boost::bind(&Connector::handleWrite, this)); // FIXME: unsafe
+        bind(&Connector::handleWrite, this)); // FIXME: unsafe
     channel_->setErrorCallback(
-        boost::bind(&Connector::handleError, this)); // FIXME: unsafe
+        bind(&Connector::handleError, this)); // FIXME: unsafe
 
     // channel_->tie(shared_from_this()); is not working,
     // as channel_ is not managed by shared_ptr
@@ -148,7 +154,7 @@ int Connector::removeAndResetChannel()
     channel_->remove();
     int sockfd = channel_->fd();
     // Can't reset channel_ here, because we are inside Channel::handleEvent
-    loop_->queueInLoop(boost::bind(&Connector::resetChannel, this)); // FIXME: unsafe
+    loop_->queueInLoop(bind(&Connector::resetChannel, this)); // FIXME: unsafe
     return sockfd;
 }
 
@@ -217,7 +223,7 @@ void Connector::retry(int sockfd)
         LOG_INFO << "Connector::retry - Retry connecting to " << serverAddr_.toIpPort()
                  << " in " << retryDelayMs_ << " milliseconds. ";
         loop_->runAfter(retryDelayMs_/1000.0,
-                        boost::bind(&Connector::startInLoop, shared_from_this()));
+                        bind(&Connector::startInLoop, shared_from_this()));
         retryDelayMs_ = std::min(retryDelayMs_ * 2, MAX_RETRY_DELAY_MS);
     }
     else
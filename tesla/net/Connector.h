@@ -93,7 +93,7 @@ private:
     InetAddress serverAddr_;
     States state_;  // FIXME: use atomic variable
 #if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
-    std::scoped_ptr<Channel> channel_;
+    std::unique_ptr<Channel> channel_;
 #include <memory>
 #else // __GXX_EXPERIMENTAL_CXX0X__
     boost::scoped_ptr<Channel> channel_;
@@ -0,0 +1,165 @@
+#include <tesla/net/DatagramRing.h>
+
+#include <algorithm>
+
+#include <assert.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <string.h>
+
+namespace tesla
+{
+
+namespace net
+{
+
+using namespace tesla::base;
+
+const int DatagramRing::MAX_BATCH;
+const size_t DatagramRing::DEFAULT_SLOTS;
+const size_t DatagramRing::DEFAULT_SLOT_SIZE;
+const size_t DatagramRing::MAX_COALESCED_SIZE;
+const int DatagramRing::MAX_COALESCED_BATCH;
+
+DatagramRing::DatagramRing(size_t slots, size_t slotSize)
+    : slots_(std::max(slots, static_cast<size_t>(MAX_BATCH))),
+      slotSize_(slotSize),
+      storage_(new char[slots_ * slotSize_]),
+      msgs_(slots_),
+      iovecs_(slots_),
+      addrs_(slots_),
+      head_(0),
+      span_((MAX_COALESCED_SIZE + slotSize_ - 1) / slotSize_),
+      coalesced_(false)
+{
+    ::memset(&msgs_[0], 0, slots_ * sizeof msgs_[0]);
+    ::memset(coalescedMsgs_, 0, sizeof coalescedMsgs_);
+    for (int i = 0; i < MAX_COALESCED_BATCH; ++i)
+    {
+        coalescedMsgs_[i].msg_hdr.msg_iov = &coalescedIovecs_[i];
+        coalescedMsgs_[i].msg_hdr.msg_iovlen = 1;
+    }
+    for (size_t i = 0; i < slots_; ++i)
+    {
+        iovecs_[i].iov_base = storage_ + i * slotSize_;
+        iovecs_[i].iov_len = slotSize_;
+        msgs_[i].msg_hdr.msg_iov = &iovecs_[i];
+        msgs_[i].msg_hdr.msg_iovlen = 1;
+        msgs_[i].msg_hdr.msg_name = &addrs_[i];
+    }
+}
+
+DatagramRing::~DatagramRing()
+{
+    delete[] storage_;
+}
+
+struct mmsghdr* DatagramRing::prepare(int* count, bool coalesced)
+{
+    assert(*count > 0);
+    coalesced_ = coalesced;
+    if (coalesced)
+    {
+        assert(canCoalesce());
+        *count = std::min(*count, MAX_COALESCED_BATCH);
+        if (head_ + *count * span_ > slots_)
+        {
+            head_ = 0;
+        }
+        // adjacent slots make one buffer, and the addresses of their
+        // first slots are free
+        for (int i = 0; i < *count; ++i)
+        {
+            size_t slot = head_ + i * span_;
+            coalescedIovecs_[i].iov_base = storage_ + slot * slotSize_;
+            coalescedIovecs_[i].iov_len = MAX_COALESCED_SIZE;
+            struct msghdr& hdr = coalescedMsgs_[i].msg_hdr;
+            hdr.msg_name = &addrs_[slot];
+            hdr.msg_namelen = sizeof addrs_[0];
+            hdr.msg_control = coalescedControls_[i].space;
+            hdr.msg_controllen = sizeof coalescedControls_[i].space;
+        }
+        return coalescedMsgs_;
+    }
+
+    if (head_ + MAX_BATCH > slots_)
+    {
+        head_ = 0;
+    }
+    *count = std::min(*count, MAX_BATCH);
+    // the kernel lowers them to what it wrote
+    for (int i = 0; i < *count; ++i)
+    {
+        msgs_[head_ + i].msg_hdr.msg_namelen = sizeof addrs_[0];
+    }
+    return &msgs_[head_];
+}
+
+void DatagramRing::commit(int received, std::vector<Datagram>* datagrams)
+{
+    if (coalesced_)
+    {
+        commitCoalesced(received, datagrams);
+        return;
+    }
+
+    assert(head_ + received <= slots_);
+    for (int i = 0; i < received; ++i)
+    {
+        const struct mmsghdr& msg = msgs_[head_ + i];
+        Datagram datagram = {
+            StringPiece(static_cast<const char*>(msg.msg_hdr.msg_iov->iov_base),
+                        static_cast<int>(msg.msg_len)),
+            InetAddress(addrs_[head_ + i]),
+            (msg.msg_hdr.msg_flags & MSG_TRUNC) != 0
+        };
+        datagrams->push_back(datagram);
+    }
+    head_ += received;
+}
+
+void DatagramRing::commitCoalesced(int received, std::vector<Datagram>* datagrams)
+{
+    assert(head_ + received * span_ <= slots_);
+    for (int i = 0; i < received; ++i)
+    {
+        struct msghdr& hdr = coalescedMsgs_[i].msg_hdr;
+        const char* data = static_cast<const char*>(hdr.msg_iov->iov_base);
+        size_t len = coalescedMsgs_[i].msg_len;
+        size_t segmentSize = len;
+        for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&hdr); cmsg != NULL; cmsg = CMSG_NXTHDR(&hdr, cmsg))
+        {
+            if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO)
+            {
+                int size;
+                ::memcpy(&size, CMSG_DATA(cmsg), sizeof size);
+                if (size > 0)
+                {
+                    segmentSize = size;
+                }
+            }
+        }
+
+        InetAddress peer(*static_cast<const struct sockaddr_in*>(hdr.msg_name));
+        bool truncated = (hdr.msg_flags & MSG_TRUNC) != 0;
+        // an empty datagram is still one
+        size_t offset = 0;
+        do
+        {
+            size_t size = std::min(segmentSize, len - offset);
+            Datagram datagram = {
+                StringPiece(data + offset, static_cast<int>(size)),
+                peer,
+                truncated && offset + size == len
+            };
+            datagrams->push_back(datagram);
+            offset += size;
+        }
+        while (offset < len);
+    }
+    head_ += received * span_;
+}
+
+} // namespace net
+
+} // namespace tesla
@@ -0,0 +1,125 @@
+/*
+ *
+ * Author:
+ *     Thomas Liu
+ * Date:
+ *     10/18/2026
+ * Description:
+ *     Preallocated ring of datagram slots of an EventLoop
+ *
+ *
+ * Licensed under the Apache License, Version 2.0
+ *
+ */
+
+#ifndef TESLA_NET_DATAGRAMRING_H
+#define TESLA_NET_DATAGRAMRING_H
+
+#include <tesla/base/Noncopyable.hpp>
+#include <tesla/base/StringPiece.hpp>
+
+#include <tesla/net/InetAddress.h>
+
+#include <vector>
+
+#include <stddef.h>
+#include <sys/socket.h>
+
+namespace tesla
+{
+
+namespace net
+{
+
+///
+/// A datagram received into the DatagramRing of a loop.
+///
+struct Datagram
+{
+    tesla::base::StringPiece data;
+    InetAddress peer;
+    bool truncated; // longer than a slot, the rest is lost
+};
+
+///
+/// Slots for the datagrams received by the UDP endpoints of a loop,
+/// allocated once, with their headers for recvmmsg(2) set up once.
+///
+/// Each batch takes the slots after those of the last batch,
+/// wrapping around at the end, so a Datagram stays valid while
+/// the next slots() - MAX_BATCH datagrams are received.
+///
+/// A batch for a socket with UDP_GRO takes MAX_COALESCED_SIZE bytes
+/// of adjacent slots per message, as the kernel may coalesce datagrams
+/// of a peer into one, and commit() splits them back by the size
+/// the kernel reports.
+///
+class DatagramRing
+    : private tesla::base::Noncopyable
+{
+public:
+    static const int MAX_BATCH = 64;
+    static const size_t DEFAULT_SLOTS = 1024;
+    static const size_t DEFAULT_SLOT_SIZE = 2048; // an Ethernet frame fits
+    /// a coalesced message, at most 64k of IPv4
+    static const size_t MAX_COALESCED_SIZE = 65536;
+    static const int MAX_COALESCED_BATCH = 8;
+
+    DatagramRing(size_t slots, size_t slotSize);
+    ~DatagramRing();
+
+    size_t slots() const
+    {
+        return slots_;
+    }
+    size_t slotSize() const
+    {
+        return slotSize_;
+    }
+
+    /// Whether the ring holds MAX_COALESCED_BATCH coalesced messages
+    /// with room to spare, the lower bound of the batches to keep.
+    bool canCoalesce() const
+    {
+        return slots_ * slotSize_ >= 2 * MAX_COALESCED_BATCH * MAX_COALESCED_SIZE;
+    }
+
+    /// The headers of the next @c *count slots, at most MAX_BATCH,
+    /// for one recvmmsg(2), @c *count is lowered at the end of the ring.
+    /// With @c coalesced, for a socket with UDP_GRO, at most
+    /// MAX_COALESCED_BATCH messages, see canCoalesce().
+    struct mmsghdr* prepare(int* count, bool coalesced = false);
+    /// Appends the datagrams of the first @c received messages of the
+    /// last prepare() to @c datagrams, the next prepare() starts after them.
+    void commit(int received, std::vector<Datagram>* datagrams);
+
+private:
+    /// cmsg room for the UDP_GRO segment size of a message
+    union GroControl
+    {
+        struct cmsghdr header;
+        char space[CMSG_SPACE(sizeof(int))];
+    };
+
+    void commitCoalesced(int received, std::vector<Datagram>* datagrams);
+
+    const size_t slots_;
+    const size_t slotSize_;
+    char* storage_;
+    std::vector<struct mmsghdr> msgs_;
+    std::vector<struct iovec> iovecs_;
+    std::vector<struct sockaddr_in> addrs_;
+    size_t head_;
+    // a coalesced batch, MAX_COALESCED_BATCH messages over span_ slots each
+    const size_t span_;
+    bool coalesced_; // of the last prepare()
+    struct mmsghdr coalescedMsgs_[MAX_COALESCED_BATCH];
+    struct iovec coalescedIovecs_[MAX_COALESCED_BATCH];
+    GroControl coalescedControls_[MAX_COALESCED_BATCH];
+}; // class DatagramRing
+
+} // namespace net
+
+} // namespace tesla
+
+#endif  // TESLA_NET_DATAGRAMRING_H
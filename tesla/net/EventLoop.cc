@@ -4,6 +4,9 @@
 #include <tesla/net/EventLoop.h>
 #include <tesla/net/Channel.h>
 #include <tesla/net/Backend.h>
+#include <tesla/net/Buffer.h>
+#include <tesla/net/DatagramRing.h>
+#include <tesla/net/LoopPool.h>
 #include <tesla/net/SockOps.h>
 #include <tesla/net/TimerQueue.h>
 
@@ -13,8 +16,10 @@
 #include <boost/bind.hpp>
 #endif // __GXX_EXPERIMENTAL_CXX0X__
 
+#include <errno.h>
 #include <signal.h>
 #include <sys/eventfd.h>
+#include <sys/signalfd.h>
 
 namespace tesla
 {
@@ -23,6 +28,11 @@ namespace net
 {
 
 using namespace tesla::base;
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+using std::bind;
+#else // __GXX_EXPERIMENTAL_CXX0X__
+using boost::bind;
+#endif // __GXX_EXPERIMENTAL_CXX0X__
 
 /// this is stored in tls
 __thread EventLoop* t_loopInThisThread = 0;
@@ -59,18 +69,33 @@ EventLoop* EventLoop::getEventLoopOfCurrentThread()
     return t_loopInThisThread;
 }
 
-EventLoop::EventLoop()
+EventLoop::EventLoop(TimerOption timerOption)
     : threadId_(CurrentThread::tid())
     , looping_(false)
     , quit_(false)
     , eventHandling_(false)
     , callingPendingFunctors_(false)
     , iteration_(0)
+    , spinMicroseconds_(0)
+    , socketBusyPollMicroseconds_(0)
+    , spinHits_(0)
+    , blockingWaits_(0)
     , currentActiveChannel_(NULL)
     , backend_(Backend::newDefaultBackend(this))
     , wakeupFd_(createEventfd())
+    , wakeupPending_(0)
+    , wakeupWrites_(0)
+    , signalFd_(-1)
+    , readBufferSize_(BufferPool::MAX_CHUNK_SIZE - Buffer::CHEAP_PERPEND)
+    , maxReadBytes_(256 * 1024)
+    , datagramSlots_(DatagramRing::DEFAULT_SLOTS)
+    , datagramSlotSize_(DatagramRing::DEFAULT_SLOT_SIZE)
+    , connectionCount_(0)
+    , pendingOutputBytes_(0)
+    , pool_(new LoopPool(this))
     , wakeupChannel_(new Channel(this, wakeupFd_))
-    , timerQueue_(new TimerQueue(this))
+    , timerQueue_(TimerQueue::newTimerQueue(this, timerOption))
+    , readBuffer_(new Buffer)
 {
     LOG_DEBUG << "EventLoop " << this << "created in thread " << threadId_;
 
@@ -84,7 +109,7 @@ EventLoop::EventLoop()
         t_loopInThisThread = this;
     }
     wakeupChannel_->setReadCallback(
-        boost::bind(&EventLoop::handleRead, this));
+        bind(&EventLoop::handleRead, this));
     // we are always reading the wakeupfd
     wakeupChannel_->enableReading();
 }
@@ -94,6 +119,13 @@ EventLoop::~EventLoop()
     LOG_DEBUG << "EventLoop " << this << " of thread " << threadId_
               << " destructs in thread " << CurrentThread::tid();
     ::close(wakeupFd_);
+    if (signalChannel_)
+    {
+        signalChannel_->disableAll();
+        signalChannel_->remove();
+        ::close(signalFd_);
+    }
+    pool_->close();
     t_loopInThisThread = NULL;
 }
 
@@ -108,7 +140,14 @@ void EventLoop::loop()
     while (!quit_)
     {
         activeChannels_.clear();
-        pollReturnTime_ = backend_->run(POLL_TIME_MS, &activeChannels_);
+        if (spinMicroseconds_ > 0)
+        {
+            pollReturnTime_ = spinThenPoll();
+        }
+        else
+        {
+            pollReturnTime_ = backend_->run(POLL_TIME_MS, &activeChannels_);
+        }
         ++iteration_;
         if (Logger::getLogLevel() <= Logger::TRACE)
         {
@@ -131,12 +170,107 @@ void EventLoop::loop()
     looping_ = false;
 }
 
+Timestamp EventLoop::spinThenPoll()
+{
+    // while the flag is set, wakeup() leaves the eventfd alone,
+    // the spin sees the functors in the queue.
+    __atomic_exchange_n(&wakeupPending_, 1, __ATOMIC_SEQ_CST);
+
+    Timestamp start(Timestamp::now());
+    Timestamp now(start);
+    bool hit = false;
+    while (!quit_)
+    {
+        now = backend_->run(0, &activeChannels_);
+        if (!activeChannels_.empty() || !pendingFunctors_.empty())
+        {
+            hit = true;
+            break;
+        }
+        if (now.microSecondsSinceEpoch() - start.microSecondsSinceEpoch()
+                >= spinMicroseconds_)
+        {
+            break;
+        }
+#if defined(__i386__) || defined(__x86_64__)
+        __builtin_ia32_pause();
+#endif
+    }
+
+    // an RMW, so it reads the flag of any wakeup() skipped during the
+    // spin, and the functor pushed before it is seen below.
+    __atomic_exchange_n(&wakeupPending_, 0, __ATOMIC_SEQ_CST);
+    if (hit)
+    {
+        ++spinHits_;
+        return now;
+    }
+    if (quit_)
+    {
+        return now;
+    }
+    ++blockingWaits_;
+    return backend_->run(pendingFunctors_.empty() ? POLL_TIME_MS : 0,
+                         &activeChannels_);
+}
+
+void EventLoop::setBusyPoll(int spinMicroseconds, int socketMicroseconds)
+{
+    assertInLoopThread();
+    assert(spinMicroseconds >= 0 && socketMicroseconds >= 0);
+    spinMicroseconds_ = spinMicroseconds;
+    socketBusyPollMicroseconds_ = socketMicroseconds;
+}
+
+void EventLoop::setReadBufferSize(size_t bytes)
+{
+    assertInLoopThread();
+    readBufferSize_ = bytes;
+}
+
+void EventLoop::setMaxReadBytes(size_t bytes)
+{
+    assertInLoopThread();
+    maxReadBytes_ = bytes;
+}
+
+Buffer* EventLoop::readBuffer(int sockfd)
+{
+    if (readBufferSize_ == 0)
+    {
+        int rcvbuf = SockOps::getReceiveBufferSize(sockfd);
+        readBufferSize_ = rcvbuf > 0
+                          ? static_cast<size_t>(rcvbuf)
+                          : BufferPool::MAX_CHUNK_SIZE - Buffer::CHEAP_PERPEND;
+    }
+    readBuffer_->ensureWritableBytes(readBufferSize_);
+    return readBuffer_.get();
+}
+
+void EventLoop::setDatagramRing(size_t slots, size_t slotSize)
+{
+    assertInLoopThread();
+    assert(!datagramRing_);
+    datagramSlots_ = slots;
+    datagramSlotSize_ = slotSize;
+}
+
+DatagramRing* EventLoop::datagramRing()
+{
+    assertInLoopThread();
+    if (!datagramRing_)
+    {
+        datagramRing_.reset(new DatagramRing(datagramSlots_, datagramSlotSize_));
+    }
+    return datagramRing_.get();
+}
+
 void EventLoop::quit()
 {
     quit_ = true;
     // There is a chance that loop() just executes while(!quit_) and exists,
     // then EventLoop destructs, then we are accessing an invalid object.
-    // Can be fixed using mutex_ in both places.
+    // FIXME: needs some synchronization between quit() and the dtor.
     if (!isInLoopThread())
     {
         wakeup();
@@ -157,10 +291,7 @@ void EventLoop::runInLoop(const Functor& cb)
 
 void EventLoop::queueInLoop(const Functor& cb)
 {
-    {
-        MutexLockGuard lock(mutex_);
-        pendingFunctors_.push_back(cb);
-    }
+    pendingFunctors_.push(cb);
 
     if (!isInLoopThread() || callingPendingFunctors_)
     {
@@ -170,19 +301,19 @@ void EventLoop::queueInLoop(const Functor& cb)
 
 TimerId EventLoop::runAt(const Timestamp& time, const TimerCallback& cb)
 {
-    return timerQueue_->addTimer(cb, time, 0.0);
+    return timerQueue_->addTimer(cb, time, 0.0, 0.0);
 }
 
-TimerId EventLoop::runAfter(double delay, const TimerCallback& cb)
+TimerId EventLoop::runAfter(double delay, const TimerCallback& cb, double slack)
 {
     Timestamp time(addTime(Timestamp::now(), delay));
-    return runAt(time, cb);
+    return timerQueue_->addTimer(cb, time, 0.0, slack);
 }
 
-TimerId EventLoop::runEvery(double interval, const TimerCallback& cb)
+TimerId EventLoop::runEvery(double interval, const TimerCallback& cb, double slack)
 {
     Timestamp time(addTime(Timestamp::now(), interval));
-    return timerQueue_->addTimer(cb, time, interval);
+    return timerQueue_->addTimer(cb, time, interval, slack);
 }
 
 #if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
@@ -201,10 +332,7 @@ void EventLoop::runInLoop(Functor&& cb)
 
 void EventLoop::queueInLoop(Functor&& cb)
 {
-    {
-        MutexLockGuard lock(mutex_);
-        pendingFunctors_.push_back(std::move(cb));  // emplace_back
-    }
+    pendingFunctors_.push(std::move(cb));
 
     if (!isInLoopThread() || callingPendingFunctors_)
     {
@@ -214,22 +342,37 @@ void EventLoop::queueInLoop(Functor&& cb)
 
 TimerId EventLoop::runAt(const Timestamp& time, TimerCallback&& cb)
 {
-    return timerQueue_->addTimer(std::move(cb), time, 0.0);
+    return timerQueue_->addTimer(std::move(cb), time, 0.0, 0.0);
 }
 
-TimerId EventLoop::runAfter(double delay, TimerCallback&& cb)
+TimerId EventLoop::runAfter(double delay, TimerCallback&& cb, double slack)
 {
     Timestamp time(addTime(Timestamp::now(), delay));
-    return runAt(time, std::move(cb));
+    return timerQueue_->addTimer(std::move(cb), time, 0.0, slack);
 }
 
-TimerId EventLoop::runEvery(double interval, TimerCallback&& cb)
+TimerId EventLoop::runEvery(double interval, TimerCallback&& cb, double slack)
 {
     Timestamp time(addTime(Timestamp::now(), interval));
-    return timerQueue_->addTimer(std::move(cb), time, interval);
+    return timerQueue_->addTimer(std::move(cb), time, interval, slack);
 }
 #endif
 
+int64_t EventLoop::savedSyscalls() const
+{
+    return backend_->savedSyscalls();
+}
+
+int64_t EventLoop::timerfdResets() const
+{
+    return timerQueue_->timerfdResets();
+}
+
+int64_t EventLoop::mergedTimerWakeups() const
+{
+    return timerQueue_->mergedWakeups();
+}
+
 void EventLoop::cancel(TimerId timerId)
 {
     return timerQueue_->cancel(timerId);
@@ -264,6 +407,12 @@ void EventLoop::abortNotInLoopThread()
 
 void EventLoop::wakeup()
 {
+    // only the first wakeup since the last handleRead() writes
+    if (__atomic_exchange_n(&wakeupPending_, 1, __ATOMIC_SEQ_CST))
+    {
+        return;
+    }
+    __atomic_fetch_add(&wakeupWrites_, 1, __ATOMIC_RELAXED);
     uint64_t one = 1;
     ssize_t n = SockOps::write(wakeupFd_, &one, sizeof one);
     if (n != sizeof one)
@@ -280,6 +429,70 @@ void EventLoop::handleRead()
     {
         LOG_ERROR << "EventLoop::handleRead() reads " << n << " bytes instead of 8";
     }
+    // cleared after the read, or a wakeup written meanwhile would be
+    // drained while the flag stays set, and later ones would be lost.
+    // functors queued before this are run in this iteration.
+    __atomic_store_n(&wakeupPending_, 0, __ATOMIC_SEQ_CST);
+}
+
+void EventLoop::onSignal(int signo, const SignalCallback& cb)
+{
+    assertInLoopThread();
+    signalCallbacks_[signo] = cb;
+
+    sigset_t mask;
+    ::sigemptyset(&mask);
+    for (std::map<int, SignalCallback>::const_iterator it = signalCallbacks_.begin();
+            it != signalCallbacks_.end(); ++it)
+    {
+        ::sigaddset(&mask, it->first);
+    }
+    // a signal not blocked is delivered the old way, never to the signalfd
+    int err = ::pthread_sigmask(SIG_BLOCK, &mask, NULL);
+    if (err != 0)
+    {
+        errno = err;
+        LOG_SYSERR << "EventLoop::onSignal pthread_sigmask";
+    }
+
+    // updates the mask of the signalfd once it exists
+    int fd = ::signalfd(signalFd_, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (fd < 0)
+    {
+        LOG_SYSFATAL << "EventLoop::onSignal signalfd";
+    }
+    if (!signalChannel_)
+    {
+        signalFd_ = fd;
+        signalChannel_.reset(new Channel(this, signalFd_));
+        signalChannel_->setReadCallback(
+            bind(&EventLoop::handleSignal, this));
+        signalChannel_->enableReading();
+    }
+}
+
+void EventLoop::handleSignal()
+{
+    struct signalfd_siginfo infos[8];
+    ssize_t n;
+    while ((n = SockOps::read(signalFd_, infos, sizeof infos)) > 0)
+    {
+        for (size_t i = 0; i < static_cast<size_t>(n) / sizeof infos[0]; ++i)
+        {
+            int signo = static_cast<int>(infos[i].ssi_signo);
+            std::map<int, SignalCallback>::const_iterator it = signalCallbacks_.find(signo);
+            if (it != signalCallbacks_.end() && it->second)
+            {
+                // a copy, the callback may replace itself
+                SignalCallback cb(it->second);
+                cb(signo);
+            }
+        }
+    }
+    if (n < 0 && errno != EAGAIN)
+    {
+        LOG_SYSERR << "EventLoop::handleSignal";
+    }
 }
 
 void EventLoop::doPendingFunctors()
@@ -287,10 +500,8 @@ void EventLoop::doPendingFunctors()
     std::vector<Functor> functors;
     callingPendingFunctors_ = true;
 
-    {
-        MutexLockGuard lock(mutex_);
-        functors.swap(pendingFunctors_);
-    }
+    // only what is queued by now, later ones run in the next iteration
+    pendingFunctors_.takeAll(&functors);
 
     for (size_t i = 0; i < functors.size(); ++i)
     {
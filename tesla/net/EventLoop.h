@@ -15,6 +15,7 @@
 #ifndef TESLA_NET_EVENTLOOP_H
 #define TESLA_NET_EVENTLOOP_H
 
+#include <map>
 #include <vector>
 
 #if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
@@ -25,7 +26,7 @@
 #include <boost/scoped_ptr.hpp>
 #endif // __GXX_EXPERIMENTAL_CXX0X__
 
-#include <tesla/base/Mutex.hpp>
+#include <tesla/base/MpscQueue.hpp>
 #include <tesla/base/CurrentThread.h>
 #include <tesla/base/Timestamp.h>
 #include <tesla/base/Noncopyable.hpp>
@@ -40,6 +41,9 @@ namespace net
 
 class Channel;
 class Backend;
+class LoopPool;
+class Buffer;
+class DatagramRing;
 class TimerQueue;
 
 ///
@@ -56,7 +60,15 @@ public:
     typedef boost::function<void()> Functor;
 #endif // __GXX_EXPERIMENTAL_CXX0X__
 
-    EventLoop();
+    /// How timers are kept.
+    enum TimerOption
+    {
+        DefaultTimers,  // WheelTimers if TESLA_TIMING_WHEEL is set, SortedTimers otherwise
+        SortedTimers,   // sorted set, O(log n) insert and cancel
+        WheelTimers,    // hierarchical timing wheel of 1ms ticks, O(1) insert and cancel
+    };
+
+    explicit EventLoop(TimerOption timerOption = DefaultTimers);
     ~EventLoop();  // force out-line dtor, for scoped_ptr members.
 
     ///
@@ -86,6 +98,68 @@ public:
         return iteration_;
     }
 
+    /// how many interest updates the backend kept away from the kernel,
+    /// see TESLA_EPOLL_CHANGELIST
+    int64_t savedSyscalls() const;
+
+    ///
+    /// Busy-polls for low latency, on a core of its own.
+    /// Before blocking, the loop polls with zero timeout for up to
+    /// @c spinMicroseconds, checking queued functors between polls,
+    /// which are then run without an eventfd write.
+    /// Connections established later set SO_BUSY_POLL to
+    /// @c socketMicroseconds if it's positive, which needs CAP_NET_ADMIN
+    /// above net.core.busy_read.
+    /// 0 turns spinning off, the default.
+    /// Not thread safe, but in loop
+    ///
+    void setBusyPoll(int spinMicroseconds, int socketMicroseconds = 0);
+    int socketBusyPoll() const
+    {
+        return socketBusyPollMicroseconds_;
+    }
+    /// spins that found work, and spins that ran out and blocked
+    int64_t spinHits() const
+    {
+        return spinHits_;
+    }
+    int64_t blockingWaits() const
+    {
+        return blockingWaits_;
+    }
+
+    ///
+    /// Size of the read buffer shared by the connections of the loop,
+    /// where Buffer::readFd() puts what does not fit in an input buffer.
+    /// 64k by default, 0 sizes it to SO_RCVBUF of the first socket read.
+    /// Not thread safe, but in loop
+    ///
+    void setReadBufferSize(size_t bytes);
+    ///
+    /// A readable connection reads until EAGAIN, but no more than
+    /// @c bytes per event, so that one sender does not starve the rest.
+    /// 0 reads once per event. 256k by default.
+    /// Not thread safe, but in loop
+    ///
+    void setMaxReadBytes(size_t bytes);
+    size_t maxReadBytes() const
+    {
+        return maxReadBytes_;
+    }
+    /// internal usage, the shared read buffer, empty,
+    /// @c sockfd is the socket to size it by
+    Buffer* readBuffer(int sockfd);
+
+    ///
+    /// Slots of the ring the UDP endpoints of the loop receive into,
+    /// DatagramRing::DEFAULT_SLOTS of DatagramRing::DEFAULT_SLOT_SIZE
+    /// bytes by default. Larger datagrams are truncated.
+    /// Not thread safe, but in loop, before the first endpoint starts
+    ///
+    void setDatagramRing(size_t slots, size_t slotSize);
+    /// internal usage, the ring of setDatagramRing(), made on first use
+    DatagramRing* datagramRing();
+
     /// Runs callback immediately in the loop thread.
     /// It wakes up the loop, and run the cb.
     /// If in the same loop thread, cb is run within the function.
@@ -109,15 +183,18 @@ public:
     ///
     TimerId runAt(const tesla::base::Timestamp& time, const TimerCallback& cb);
     ///
-    /// Runs callback after @c delay seconds.
+    /// Runs callback after @c delay seconds,
+    /// or up to @c slack seconds later, so that close timers
+    /// share one expiration and one wakeup.
     /// Safe to call from other threads.
     ///
-    TimerId runAfter(double delay, const TimerCallback& cb);
+    TimerId runAfter(double delay, const TimerCallback& cb, double slack = 0.0);
     ///
-    /// Runs callback every @c interval seconds.
+    /// Runs callback every @c interval seconds, each run may be
+    /// up to @c slack seconds late.
     /// Safe to call from other threads.
     ///
-    TimerId runEvery(double interval, const TimerCallback& cb);
+    TimerId runEvery(double interval, const TimerCallback& cb, double slack = 0.0);
     ///
     /// Cancels the timer.
     /// Safe to call from other threads.
@@ -126,15 +203,66 @@ public:
 
 #if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
     TimerId runAt(const tesla::base::Timestamp& time, TimerCallback&& cb);
-    TimerId runAfter(double delay, TimerCallback&& cb);
-    TimerId runEvery(double interval, TimerCallback&& cb);
+    TimerId runAfter(double delay, TimerCallback&& cb, double slack = 0.0);
+    TimerId runEvery(double interval, TimerCallback&& cb, double slack = 0.0);
 #endif
 
+    ///
+    /// Runs @c cb in the loop as signal @c signo arrives, read from
+    /// a signalfd, so unlike a signal handler it may do anything, as
+    /// stopping to accept and closing idle connections on SIGTERM.
+    /// The signal is blocked in the calling thread, and must be in all
+    /// others, or one of them takes it the old way: call it before
+    /// other threads start, they inherit the mask. It stays blocked
+    /// after the loop is gone. One loop per signal, a later call for
+    /// the same signal replaces the callback.
+    /// Not thread safe, but in loop
+    ///
+    void onSignal(int signo, const SignalCallback& cb);
+
+    /// timerfd_settime(2) calls, and timers that fired in a wakeup
+    /// paid for by another timer, see slack of runAfter()
+    int64_t timerfdResets() const;
+    int64_t mergedTimerWakeups() const;
+
     /// internal usage
     void wakeup();
+    /// eventfd writes actually made, the rest were coalesced
+    int64_t wakeupWrites() const
+    {
+        return __atomic_load_n(&wakeupWrites_, __ATOMIC_RELAXED);
+    }
     void updateChannel(Channel* channel);
     void removeChannel(Channel* channel);
 
+    /// slab pool for the objects of its connections
+    LoopPool* pool()
+    {
+        return pool_;
+    }
+
+    ///
+    /// Load of the loop, for placing new connections.
+    /// Updated in the loop thread, read from any thread.
+    ///
+    int connectionCount() const
+    {
+        return __atomic_load_n(&connectionCount_, __ATOMIC_RELAXED);
+    }
+    /// bytes queued in the output buffers of its connections
+    int64_t pendingOutputBytes() const
+    {
+        return __atomic_load_n(&pendingOutputBytes_, __ATOMIC_RELAXED);
+    }
+    void addConnectionCount(int delta)
+    {
+        __atomic_fetch_add(&connectionCount_, delta, __ATOMIC_RELAXED);
+    }
+    void addPendingOutputBytes(int64_t delta)
+    {
+        __atomic_fetch_add(&pendingOutputBytes_, delta, __ATOMIC_RELAXED);
+    }
+
     pid_t threadId() const { return threadId_; }
     void assertInLoopThread()
     {
@@ -158,6 +286,9 @@ public:
 private:
     void abortNotInLoopThread();
     void handleRead();  // waked up
+    void handleSignal();
+    /// polls for the busy-poll budget, then blocks
+    tesla::base::Timestamp spinThenPoll();
     void doPendingFunctors();
 
     void printActiveChannels() const; // for debug use
@@ -172,26 +303,52 @@ private:
     int64_t iteration_;
     tesla::base::Timestamp pollReturnTime_;
 
+    int spinMicroseconds_;
+    int socketBusyPollMicroseconds_;
+    int64_t spinHits_;
+    int64_t blockingWaits_;
+
     int wakeupFd_;
+    int wakeupPending_; /* atomic, set until handleRead() drains wakeupFd_ */
+    int64_t wakeupWrites_; /* atomic */
+
+    int signalFd_; // -1 until onSignal()
+    std::map<int, SignalCallback> signalCallbacks_;
+
+    size_t readBufferSize_;
+    size_t maxReadBytes_;
+    size_t datagramSlots_;
+    size_t datagramSlotSize_;
+
+    int connectionCount_; /* atomic */
+    int64_t pendingOutputBytes_; /* atomic */
+
+    /// closed as the loop destructs, freed with the last block out
+    LoopPool* pool_;
 
 #if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
     // unlike in TimerQueue, which is an internal class,
     // we don't expose Channel to client.
-    std::scoped_ptr<Channel> wakeupChannel_;
-    std::scoped_ptr<Backend> backend_;
-    std::scoped_ptr<TimerQueue> timerQueue_;
+    std::unique_ptr<Channel> wakeupChannel_;
+    std::unique_ptr<Backend> backend_;
+    std::unique_ptr<TimerQueue> timerQueue_;
+    std::unique_ptr<Buffer> readBuffer_;
+    std::unique_ptr<DatagramRing> datagramRing_;
+    std::unique_ptr<Channel> signalChannel_;
 #else // __GXX_EXPERIMENTAL_CXX0X__
     // unlike in TimerQueue, which is an internal class,
     // we don't expose Channel to client.
     boost::scoped_ptr<Channel> wakeupChannel_;
     boost::scoped_ptr<Backend> backend_;
     boost::scoped_ptr<TimerQueue> timerQueue_;
+    boost::scoped_ptr<Buffer> readBuffer_;
+    boost::scoped_ptr<DatagramRing> datagramRing_;
+    boost::scoped_ptr<Channel> signalChannel_;
 #endif // __GXX_EXPERIMENTAL_CXX0X__
 
     ChannelList activeChannels_;
     Channel* currentActiveChannel_;
-    tesla::base::MutexLock mutex_;
-    std::vector<Functor> pendingFunctors_; // @GuardedBy mutex_
+    tesla::base::MpscQueue<Functor> pendingFunctors_; // lock-free, pushed by any thread
 }; // class EventLoop
 
 } // namespace net
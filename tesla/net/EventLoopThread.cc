@@ -14,14 +14,20 @@ namespace net
 {
 
 using namespace tesla::base;
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+using std::bind;
+#else // __GXX_EXPERIMENTAL_CXX0X__
+using boost::bind;
+#endif // __GXX_EXPERIMENTAL_CXX0X__
 
 EventLoopThread::EventLoopThread(const ThreadInitCallback& cb)
     : loop_(NULL),
       exiting_(false),
-      thread_(boost::bind(&EventLoopThread::threadFunc, this), "EventLoopThread"), // FIXME: number it
+      thread_(bind(&EventLoopThread::threadFunc, this), "EventLoopThread"), // FIXME: number it
       mutex_(),
       cond_(mutex_),
-      callback_(cb)
+      callback_(cb),
+      affinityIndex_(0)
 {
 }
 
@@ -55,6 +61,8 @@ EventLoop* EventLoopThread::startLoop()
 
 void EventLoopThread::threadFunc()
 {
+    // pinned first, so the loop and what it allocates are on this node
+    affinity_.apply(affinityIndex_);
     EventLoop loop;
 
     if (callback_)
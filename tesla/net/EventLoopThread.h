@@ -16,6 +16,7 @@
 #define TESLA_NET_EVENTLOOPTHREAD_H
 
 #include <tesla/base/Condition.h>
+#include <tesla/base/CpuAffinity.h>
 #include <tesla/base/Mutex.hpp>
 #include <tesla/base/Thread.h>
 #include <tesla/base/Noncopyable.hpp>
@@ -31,10 +32,21 @@ class EventLoopThread
     : private tesla::base::Noncopyable
 {
 public:
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+    typedef std::function<void(EventLoop*)> ThreadInitCallback;
+#else // __GXX_EXPERIMENTAL_CXX0X__
     typedef boost::function<void(EventLoop*)> ThreadInitCallback;
+#endif // __GXX_EXPERIMENTAL_CXX0X__
 
     EventLoopThread(const ThreadInitCallback& cb = ThreadInitCallback());
     ~EventLoopThread();
+    /// Pins the thread by the @c index th cpu of the plan,
+    /// before the loop is created. Must be called before startLoop().
+    void setAffinity(const tesla::base::CpuAffinity& affinity, int index)
+    {
+        affinity_ = affinity;
+        affinityIndex_ = index;
+    }
     EventLoop* startLoop();
 
 private:
@@ -46,6 +58,8 @@ private:
     tesla::base::MutexLock mutex_;
     tesla::base::Condition cond_;
     ThreadInitCallback callback_;
+    tesla::base::CpuAffinity affinity_;
+    int affinityIndex_;
 };
 
 } // namespace net
@@ -1,6 +1,7 @@
 #include <tesla/net/EventLoopThreadpool.h>
 #include <tesla/net/EventLoop.h>
 #include <tesla/net/EventLoopThread.h>
+#include <tesla/net/InetAddress.h>
 
 #include <vector>
 #if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
@@ -21,7 +22,9 @@ EventLoopThreadPool::EventLoopThreadPool(EventLoop* baseLoop)
     : baseLoop_(baseLoop),
       started_(false),
       nThreads_(0),
-      next_(0)
+      next_(0),
+      placement_(RoundRobin),
+      seed_(static_cast<uint32_t>(reinterpret_cast<uintptr_t>(this)) | 1)
 {
 }
 
@@ -40,6 +43,7 @@ void EventLoopThreadPool::start(const ThreadInitCallback& cb)
     for (int i = 0; i < nThreads_; ++i)
     {
         EventLoopThread* t = new EventLoopThread(cb);
+        t->setAffinity(affinity_, i);
         threads_.push_back(t);
         loops_.push_back(t->startLoop());
     }
@@ -68,6 +72,85 @@ EventLoop* EventLoopThreadPool::getNextLoop()
     return loop;
 }
 
+EventLoop* EventLoopThreadPool::getNextLoop(const InetAddress& peerAddr)
+{
+    baseLoop_->assertInLoopThread();
+    assert(started_);
+    if (loops_.size() <= 1 || placement_ == RoundRobin)
+    {
+        return getNextLoop();
+    }
+
+    // the counters are relaxed atomics of other threads,
+    // a slightly stale view is good enough for placing.
+    size_t n = loops_.size();
+    size_t index = 0;
+    switch (placement_)
+    {
+    case LeastConnections:
+        for (size_t i = 1; i < n; ++i)
+        {
+            if (loops_[i]->connectionCount() < loops_[index]->connectionCount())
+            {
+                index = i;
+            }
+        }
+        break;
+    case LeastPendingBytes:
+        for (size_t i = 1; i < n; ++i)
+        {
+            int64_t pi = loops_[i]->pendingOutputBytes();
+            int64_t pindex = loops_[index]->pendingOutputBytes();
+            // a burst of new connections has nothing queued yet
+            if (pi < pindex
+                    || (pi == pindex
+                        && loops_[i]->connectionCount() < loops_[index]->connectionCount()))
+            {
+                index = i;
+            }
+        }
+        break;
+    case PowerOfTwoChoices:
+    {
+        size_t a = nextRandom() % n;
+        size_t b = nextRandom() % (n - 1);
+        if (b >= a)
+        {
+            ++b;
+        }
+        index = lessLoaded(a, b);
+        break;
+    }
+    case PeerHash:
+        // Fibonacci hashing of the address, the port is left out
+        index = static_cast<size_t>(
+                    (static_cast<uint64_t>(peerAddr.ipNetEndian() * 2654435761u) * n) >> 32);
+        break;
+    default:
+        assert(false);
+    }
+    return loops_[index];
+}
+
+size_t EventLoopThreadPool::lessLoaded(size_t a, size_t b) const
+{
+    int ca = loops_[a]->connectionCount();
+    int cb = loops_[b]->connectionCount();
+    if (ca != cb)
+    {
+        return ca < cb ? a : b;
+    }
+    return loops_[a]->pendingOutputBytes() <= loops_[b]->pendingOutputBytes() ? a : b;
+}
+
+uint32_t EventLoopThreadPool::nextRandom()
+{
+    seed_ ^= seed_ << 13;
+    seed_ ^= seed_ >> 17;
+    seed_ ^= seed_ << 5;
+    return seed_;
+}
+
 std::vector<EventLoop*> EventLoopThreadPool::getAllLoops()
 {
     baseLoop_->assertInLoopThread();
@@ -16,6 +16,8 @@
 #define TESLA_NET_EVENTLOOPTHREADPOOL_H
 
 #include <vector>
+
+#include <stdint.h>
 #if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
 #include <functional>
 #include <memory>
@@ -23,6 +25,7 @@
 #include <boost/function.hpp>
 #endif // __GXX_EXPERIMENTAL_CXX0X__
 
+#include <tesla/base/CpuAffinity.h>
 #include <tesla/base/Noncopyable.hpp>
 
 #include <boost/ptr_container/ptr_vector.hpp>
@@ -35,6 +38,7 @@ namespace net
 
 class EventLoop;
 class EventLoopThread;
+class InetAddress;
 
 class EventLoopThreadPool
     : private tesla::base::Noncopyable
@@ -47,24 +51,61 @@ public:
     typedef boost::function<void(EventLoop*)> ThreadInitCallback;
 #endif // __GXX_EXPERIMENTAL_CXX0X__
 
+    /// How getNextLoop(peerAddr) places a new connection.
+    enum Placement
+    {
+        RoundRobin,
+        /// the loop with the fewest connections
+        LeastConnections,
+        /// the loop with the fewest bytes queued for sending
+        LeastPendingBytes,
+        /// the less loaded of two loops picked at random
+        PowerOfTwoChoices,
+        /// the loop the peer's ip hashes to, same host same loop
+        PeerHash,
+    };
+
     EventLoopThreadPool(EventLoop* baseLoop);
     ~EventLoopThreadPool();
     void setThreadNum(int numThreads)
     {
         nThreads_ = numThreads;
     }
+    /// The i-th loop thread pins itself by the plan.
+    /// Must be called before start().
+    void setAffinity(const tesla::base::CpuAffinity& affinity)
+    {
+        affinity_ = affinity;
+    }
+    void setPlacement(Placement placement)
+    {
+        placement_ = placement;
+    }
+    Placement placement() const
+    {
+        return placement_;
+    }
     void start(const ThreadInitCallback& cb = ThreadInitCallback());
-    // valid after calling start()
+    // valid after calling start(), round-robin
     EventLoop* getNextLoop();
+    // valid after calling start(), by the placement policy
+    EventLoop* getNextLoop(const InetAddress& peerAddr);
     // valid after calling start()
     std::vector<EventLoop*> getAllLoops();
 
 private:
+    /// index of the less loaded loop, by connections then pending bytes
+    size_t lessLoaded(size_t a, size_t b) const;
+    /// xorshift, for PowerOfTwoChoices
+    uint32_t nextRandom();
 
     EventLoop* baseLoop_;
     bool started_;
     int nThreads_;
     int next_;
+    Placement placement_;
+    uint32_t seed_;
+    tesla::base::CpuAffinity affinity_;
     boost::ptr_vector<EventLoopThread> threads_;
     std::vector<EventLoop*> loops_;
 };
@@ -0,0 +1,68 @@
+#include <tesla/net/FileRegion.h>
+
+#include <algorithm>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+
+namespace tesla
+{
+
+namespace net
+{
+
+using namespace tesla::base;
+
+FileRegion::File::~File()
+{
+    if (owned)
+    {
+        ::close(fd);
+    }
+}
+
+FileRegion::FileRegion(int fd, off_t offset, size_t count, bool ownsFd)
+    : file_(new File),
+      offset_(offset),
+      size_(count)
+{
+    file_->fd = fd;
+    file_->owned = ownsFd;
+}
+
+FileRegion FileRegion::open(StringArg path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return FileRegion();
+    }
+    struct stat st;
+    int savedErrno = ::fstat(fd, &st) < 0 ? errno
+                     : S_ISREG(st.st_mode) ? 0 : EINVAL;
+    if (savedErrno != 0)
+    {
+        ::close(fd);
+        errno = savedErrno;
+        return FileRegion();
+    }
+    return FileRegion(fd, 0, static_cast<size_t>(st.st_size), true);
+}
+
+ssize_t FileRegion::sendTo(int sockfd, size_t maxBytes)
+{
+    off_t offset = offset_;
+    ssize_t n = ::sendfile(sockfd, fd(), &offset, std::min(size_, maxBytes));
+    if (n > 0)
+    {
+        removePrefix(n);
+    }
+    return n;
+}
+
+} // namespace net
+
+} // namespace tesla
@@ -0,0 +1,108 @@
+/*
+ *
+ * Author:
+ *     Thomas Liu
+ * Date:
+ *     10/18/2026
+ * Description:
+ *     A part of a file to be sent with sendfile(2)
+ *
+ *
+ * Licensed under the Apache License, Version 2.0
+ *
+ */
+
+#ifndef TESLA_NET_FILEREGION_H
+#define TESLA_NET_FILEREGION_H
+
+#include <tesla/base/Copyable.hpp>
+#include <tesla/base/StringPiece.hpp>
+
+#include <boost/shared_ptr.hpp>
+
+#include <assert.h>
+#include <sys/types.h>
+
+namespace tesla
+{
+namespace net
+{
+
+///
+/// Bytes of a file, sent by the kernel straight from the page cache,
+/// see TcpConnection::sendFile().
+///
+/// All copies share the file descriptor, it is closed with the last
+/// one if the region owns it. Each copy has its own offset and
+/// sendfile(2) does not move the file position, so one opened file
+/// may be sent on many connections at once.
+class FileRegion
+    : public tesla::base::Copyable
+{
+public:
+    FileRegion()
+        : offset_(0),
+          size_(0)
+    {
+    }
+
+    /// @c count bytes from @c offset of @c fd,
+    /// which is closed with the last copy if @c ownsFd
+    FileRegion(int fd, off_t offset, size_t count, bool ownsFd);
+
+    /// The whole regular file, opened read-only.
+    /// @return an empty region with fd() of -1 on error, errno is kept
+    static FileRegion open(tesla::base::StringArg path);
+
+    // default copy-ctor, dtor and assignment are fine
+
+    int fd() const
+    {
+        return file_ ? file_->fd : -1;
+    }
+
+    off_t offset() const
+    {
+        return offset_;
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+
+    void removePrefix(size_t n)
+    {
+        assert(n <= size_);
+        offset_ += static_cast<off_t>(n);
+        size_ -= n;
+    }
+
+    /// Sends at most @c maxBytes to @c sockfd, and removes them.
+    /// @return result of sendfile(2)
+    ssize_t sendTo(int sockfd, size_t maxBytes);
+
+private:
+    struct File
+    {
+        int fd;
+        bool owned;
+
+        ~File();
+    };
+
+    boost::shared_ptr<File> file_;
+    off_t offset_;
+    size_t size_;
+}; // class FileRegion
+
+} // namespace net
+
+} // namespace tesla
+
+#endif  // TESLA_NET_FILEREGION_H
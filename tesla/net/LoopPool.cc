@@ -0,0 +1,163 @@
+#include <tesla/base/CurrentThread.h>
+
+#include <tesla/net/LoopPool.h>
+#include <tesla/net/EventLoop.h>
+
+#include <assert.h>
+#include <string.h>
+
+namespace tesla
+{
+
+namespace net
+{
+
+const size_t LoopPool::MAX_BLOCK_SIZE;
+const size_t LoopPool::CLASS_SIZE;
+const size_t LoopPool::CLASSES;
+const size_t LoopPool::SLAB_SIZE;
+
+LoopPool::LoopPool(EventLoop* loop)
+    : threadId_(loop->threadId()),
+      refs_(1),
+      remoteReleased_(NULL),
+      slabCur_(NULL),
+      slabEnd_(NULL),
+      reusedBlocks_(0),
+      carvedBlocks_(0),
+      heapBlocks_(0),
+      remoteReleases_(0)
+{
+    ::memset(freeLists_, 0, sizeof freeLists_);
+}
+
+LoopPool::~LoopPool()
+{
+    for (size_t i = 0; i < slabs_.size(); ++i)
+    {
+        ::operator delete(slabs_[i]);
+    }
+}
+
+void LoopPool::close()
+{
+    unref();
+}
+
+void LoopPool::unref()
+{
+    if (__atomic_sub_fetch(&refs_, 1, __ATOMIC_ACQ_REL) == 0)
+    {
+        delete this;
+    }
+}
+
+void* LoopPool::allocate(size_t size)
+{
+    size_t total = size + sizeof(Header);
+    if (total > MAX_BLOCK_SIZE || tesla::base::CurrentThread::tid() != threadId_)
+    {
+        __atomic_fetch_add(&heapBlocks_, 1, __ATOMIC_RELAXED);
+        Header* header = static_cast<Header*>(::operator new(total));
+        header->owner = NULL;
+        header->sizeClass = 0;
+        return header + 1;
+    }
+
+    size_t sizeClass = (total - 1) / CLASS_SIZE;
+    if (freeLists_[sizeClass] == NULL
+            && __atomic_load_n(&remoteReleased_, __ATOMIC_RELAXED) != NULL)
+    {
+        takeRemoteReleases();
+    }
+
+    Header* header;
+    FreeBlock* block = freeLists_[sizeClass];
+    if (block != NULL)
+    {
+        freeLists_[sizeClass] = block->next;
+        header = reinterpret_cast<Header*>(block) - 1;
+        ++reusedBlocks_;
+    }
+    else
+    {
+        header = carve(sizeClass);
+        ++carvedBlocks_;
+    }
+    __atomic_fetch_add(&refs_, 1, __ATOMIC_RELAXED);
+    header->owner = this;
+    header->sizeClass = sizeClass;
+    return header + 1;
+}
+
+void LoopPool::release(void* p)
+{
+    if (p == NULL)
+    {
+        return;
+    }
+    Header* header = static_cast<Header*>(p) - 1;
+    LoopPool* pool = header->owner;
+    if (pool == NULL)
+    {
+        ::operator delete(header);
+        return;
+    }
+
+    FreeBlock* block = static_cast<FreeBlock*>(p);
+    if (tesla::base::CurrentThread::tid() == pool->threadId_)
+    {
+        block->next = pool->freeLists_[header->sizeClass];
+        pool->freeLists_[header->sizeClass] = block;
+    }
+    else
+    {
+        // only the loop pops, and it takes the whole list, so no ABA
+        __atomic_fetch_add(&pool->remoteReleases_, 1, __ATOMIC_RELAXED);
+        FreeBlock* head = __atomic_load_n(&pool->remoteReleased_, __ATOMIC_RELAXED);
+        do
+        {
+            block->next = head;
+        }
+        while (!__atomic_compare_exchange_n(&pool->remoteReleased_, &head, block,
+                                            true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    }
+    // the block pushed is dropped with the pool, once closed
+    pool->unref();
+}
+
+LoopPool::Header* LoopPool::carve(size_t sizeClass)
+{
+    size_t blockSize = (sizeClass + 1) * CLASS_SIZE;
+    if (static_cast<size_t>(slabEnd_ - slabCur_) < blockSize)
+    {
+        // the tail of the old slab is given up, less than a block
+        char* slab = static_cast<char*>(::operator new(SLAB_SIZE));
+        slabs_.push_back(slab);
+        slabCur_ = slab;
+        slabEnd_ = slab + SLAB_SIZE;
+    }
+    Header* header = reinterpret_cast<Header*>(slabCur_);
+    slabCur_ += blockSize;
+    return header;
+}
+
+void LoopPool::takeRemoteReleases()
+{
+    FreeBlock* block = __atomic_exchange_n(&remoteReleased_,
+                                           static_cast<FreeBlock*>(NULL),
+                                           __ATOMIC_ACQUIRE);
+    while (block != NULL)
+    {
+        FreeBlock* next = block->next;
+        size_t sizeClass = (reinterpret_cast<Header*>(block) - 1)->sizeClass;
+        assert(sizeClass < CLASSES);
+        block->next = freeLists_[sizeClass];
+        freeLists_[sizeClass] = block;
+        block = next;
+    }
+}
+
+} // namespace net
+
+} // namespace tesla
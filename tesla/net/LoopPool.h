@@ -0,0 +1,207 @@
+/*
+ *
+ * Author:
+ *     Thomas Liu
+ * Date:
+ *     10/18/2026
+ * Description:
+ *     Per-loop slab pool for objects of the loop thread
+ *
+ *
+ * Licensed under the Apache License, Version 2.0
+ *
+ */
+
+#ifndef TESLA_NET_LOOPPOOL_H
+#define TESLA_NET_LOOPPOOL_H
+
+#include <tesla/base/Noncopyable.hpp>
+
+#include <new>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+namespace tesla
+{
+
+namespace net
+{
+
+class EventLoop;
+
+///
+/// Slab pool owned by an EventLoop, for objects that live and die
+/// with its connections, TcpConnection and its shared_ptr control block.
+///
+/// Blocks are carved from 64k slabs into size classes of 64 bytes,
+/// and kept on free lists for reuse, slabs are freed with the pool.
+/// Only the loop thread takes blocks from the pool, other threads
+/// get them from the heap. A block released in another thread is
+/// pushed onto a lock-free list, the loop takes them all back at once,
+/// so the free lists are never touched by two threads.
+///
+/// The pool is refcounted by the loop and its outstanding blocks,
+/// a connection kept past its loop frees the pool with its last block.
+class LoopPool
+    : private tesla::base::Noncopyable
+{
+public:
+    explicit LoopPool(EventLoop* loop);
+
+    /// Drops the reference of the loop, as it destructs.
+    void close();
+
+    /// From the pool in the loop thread, from the heap elsewhere
+    /// or if @c size is above MAX_BLOCK_SIZE.
+    void* allocate(size_t size);
+    /// Any thread, any block of allocate().
+    static void release(void* p);
+
+    /// blocks reused from the free lists, carved from slabs,
+    /// taken from the heap, and released by other threads
+    int64_t reusedBlocks() const
+    {
+        return reusedBlocks_;
+    }
+    int64_t carvedBlocks() const
+    {
+        return carvedBlocks_;
+    }
+    int64_t heapBlocks() const
+    {
+        return __atomic_load_n(&heapBlocks_, __ATOMIC_RELAXED);
+    }
+    int64_t remoteReleases() const
+    {
+        return __atomic_load_n(&remoteReleases_, __ATOMIC_RELAXED);
+    }
+
+    static const size_t MAX_BLOCK_SIZE = 4096;
+
+private:
+    /// by close() or release() only
+    ~LoopPool();
+
+    static const size_t CLASS_SIZE = 64;
+    static const size_t CLASSES = MAX_BLOCK_SIZE / CLASS_SIZE;
+    static const size_t SLAB_SIZE = 64 * 1024;
+
+    /// in front of every block, 16 bytes to keep the block aligned
+    struct Header
+    {
+        LoopPool* owner;  // NULL for a heap block
+        size_t sizeClass;
+    };
+    /// a free block, over the memory the caller used
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+    Header* carve(size_t sizeClass);
+    void takeRemoteReleases();
+    void unref();
+
+    /// of the loop, which may be gone as blocks are released
+    const pid_t threadId_;
+    int refs_; /* atomic, the loop and the outstanding blocks */
+    FreeBlock* freeLists_[CLASSES];
+    FreeBlock* remoteReleased_; /* atomic, pushed by other threads */
+    std::vector<char*> slabs_;
+    char* slabCur_;
+    char* slabEnd_;
+
+    int64_t reusedBlocks_;
+    int64_t carvedBlocks_;
+    int64_t heapBlocks_; /* atomic */
+    int64_t remoteReleases_; /* atomic */
+}; // class LoopPool
+
+///
+/// Standard allocator over a LoopPool, for allocate_shared().
+///
+template <typename T>
+class LoopAllocator
+{
+public:
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+
+    template <typename U>
+    struct rebind
+    {
+        typedef LoopAllocator<U> other;
+    };
+
+    explicit LoopAllocator(LoopPool* pool)
+        : pool_(pool)
+    { }
+    template <typename U>
+    LoopAllocator(const LoopAllocator<U>& other)
+        : pool_(other.pool())
+    { }
+
+    LoopPool* pool() const
+    {
+        return pool_;
+    }
+
+    pointer allocate(size_type n, const void* = 0)
+    {
+        return static_cast<pointer>(pool_->allocate(n * sizeof(T)));
+    }
+    void deallocate(pointer p, size_type)
+    {
+        LoopPool::release(p);
+    }
+
+    pointer address(reference x) const
+    {
+        return &x;
+    }
+    const_pointer address(const_reference x) const
+    {
+        return &x;
+    }
+    size_type max_size() const
+    {
+        return static_cast<size_type>(-1) / sizeof(T);
+    }
+    void construct(pointer p, const T& value)
+    {
+        new (p) T(value);
+    }
+    void destroy(pointer p)
+    {
+        p->~T();
+    }
+
+private:
+    LoopPool* pool_;
+}; // class LoopAllocator
+
+template <typename T, typename U>
+bool operator==(const LoopAllocator<T>& lhs, const LoopAllocator<U>& rhs)
+{
+    return lhs.pool() == rhs.pool();
+}
+
+template <typename T, typename U>
+bool operator!=(const LoopAllocator<T>& lhs, const LoopAllocator<U>& rhs)
+{
+    return lhs.pool() != rhs.pool();
+}
+
+} // namespace net
+
+} // namespace tesla
+
+#endif  // TESLA_NET_LOOPPOOL_H
@@ -0,0 +1,119 @@
+/*
+ *
+ * Author:
+ *     Thomas Liu
+ * Date:
+ *     10/18/2026
+ * Description:
+ *     Read-only view into refcounted storage, the unit of zero-copy sending
+ *
+ *
+ * Licensed under the Apache License, Version 2.0
+ *
+ */
+
+#ifndef TESLA_NET_SLICE_HPP
+#define TESLA_NET_SLICE_HPP
+
+#include <tesla/base/Copyable.hpp>
+#include <tesla/base/StringPiece.hpp>
+#include <tesla/base/Types.hpp>
+
+#include <tesla/net/Buffer.h>
+
+#include <boost/shared_ptr.hpp>
+
+#include <assert.h>
+
+namespace tesla
+{
+namespace net
+{
+
+///
+/// Immutable bytes shared by all copies of a Slice.
+///
+/// Copying a Slice only bumps a refcount, so one message can be queued
+/// on many TcpConnections without copying it per connection.
+class Slice
+    : public tesla::base::Copyable
+{
+public:
+    Slice()
+        : data_(NULL),
+          size_(0)
+    {
+    }
+
+    /// Copies @c data once into the shared storage.
+    explicit Slice(const tesla::base::StringPiece& data)
+    {
+        boost::shared_ptr<tesla::base::string> str(
+            new tesla::base::string(data.data(), data.size()));
+        data_ = str->data();
+        size_ = str->size();
+        holder_ = str;
+    }
+
+    /// Takes over the readable bytes of @c buf without copying,
+    /// @c buf is left empty.
+    explicit Slice(Buffer* buf)
+    {
+        boost::shared_ptr<Buffer> storage(new Buffer);
+        storage->swap(*buf);
+        data_ = storage->peek();
+        size_ = storage->readableBytes();
+        holder_ = storage;
+    }
+
+    /// Takes over the content of @c str without copying,
+    /// @c str is left empty.
+    explicit Slice(tesla::base::string* str)
+    {
+        boost::shared_ptr<tesla::base::string> storage(new tesla::base::string);
+        storage->swap(*str);
+        data_ = storage->data();
+        size_ = storage->size();
+        holder_ = storage;
+    }
+
+    // default copy-ctor, dtor and assignment are fine
+
+    const char* data() const
+    {
+        return data_;
+    }
+
+    size_t size() const
+    {
+        return size_;
+    }
+
+    bool empty() const
+    {
+        return size_ == 0;
+    }
+
+    void removePrefix(size_t n)
+    {
+        assert(n <= size_);
+        data_ += n;
+        size_ -= n;
+    }
+
+    tesla::base::StringPiece toStringPiece() const
+    {
+        return tesla::base::StringPiece(data_, static_cast<int>(size_));
+    }
+
+private:
+    boost::shared_ptr<void> holder_;
+    const char* data_;
+    size_t size_;
+}; // class Slice
+
+} // namespace net
+
+} // namespace tesla
+
+#endif  // TESLA_NET_SLICE_HPP
@@ -6,9 +6,11 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <netinet/udp.h>  // UDP_SEGMENT, UDP_GRO
 #include <stdio.h>  // snprintf
 #include <strings.h>  // bzero
 #include <sys/socket.h>
+#include <sys/uio.h>  // readv, writev
 #include <unistd.h>
 
 namespace tesla
@@ -70,6 +72,16 @@ int SockOps::createNonblockingOrDie()
     return sockfd;
 }
 
+int SockOps::createNonblockingUdpOrDie()
+{
+    int sockfd = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_UDP);
+    if (sockfd < 0)
+    {
+        LOG_SYSFATAL << "createNonblockingUdpOrDie failed";
+    }
+    return sockfd;
+}
+
 void SockOps::bindOrDie(int sockfd, const struct sockaddr_in& addr)
 {
     int ret = ::bind(sockfd, sockaddr_cast(&addr), static_cast<socklen_t>(sizeof addr));
@@ -98,7 +110,7 @@ int SockOps::accept(int sockfd, struct sockaddr_in* addr)
     int connfd = ::accept4(sockfd, sockaddr_cast(addr),
                            &addrlen, SOCK_NONBLOCK | SOCK_CLOEXEC);
 #endif
-    if (connfd < 0)
+    if (connfd < 0 && errno != EAGAIN)  // EAGAIN ends a drained backlog
     {
         int savedErrno = errno;
         LOG_SYSERR << "Socket::accept";
@@ -152,6 +164,21 @@ ssize_t SockOps::write(int sockfd, const void *buf, size_t count)
     return ::write(sockfd, buf, count);
 }
 
+ssize_t SockOps::writev(int sockfd, const struct iovec *iov, int iovcnt)
+{
+    return ::writev(sockfd, iov, iovcnt);
+}
+
+int SockOps::recvmmsg(int sockfd, struct mmsghdr* msgvec, unsigned int vlen)
+{
+    return ::recvmmsg(sockfd, msgvec, vlen, 0, NULL);
+}
+
+int SockOps::sendmmsg(int sockfd, struct mmsghdr* msgvec, unsigned int vlen)
+{
+    return ::sendmmsg(sockfd, msgvec, vlen, 0);
+}
+
 void SockOps::close(int sockfd)
 {
     if (::close(sockfd) < 0)
@@ -212,6 +239,54 @@ int SockOps::getSocketError(int sockfd)
     }
 }
 
+int SockOps::getReceiveBufferSize(int sockfd)
+{
+    int optval;
+    socklen_t optlen = static_cast<socklen_t>(sizeof optval);
+
+    if (::getsockopt(sockfd, SOL_SOCKET, SO_RCVBUF, &optval, &optlen) < 0)
+    {
+        LOG_SYSERR << "SockOps::getReceiveBufferSize";
+        return 0;
+    }
+    return optval;
+}
+
+void SockOps::setReceiveBufferSize(int sockfd, int bytes)
+{
+    if (::setsockopt(sockfd, SOL_SOCKET, SO_RCVBUF, &bytes, static_cast<socklen_t>(sizeof bytes)) < 0)
+    {
+        LOG_SYSERR << "SockOps::setReceiveBufferSize";
+    }
+}
+
+bool SockOps::setUdpSegment(int sockfd, int segmentSize)
+{
+#ifdef UDP_SEGMENT
+    return ::setsockopt(sockfd, SOL_UDP, UDP_SEGMENT,
+                        &segmentSize, static_cast<socklen_t>(sizeof segmentSize)) == 0;
+#else
+    (void)sockfd;
+    (void)segmentSize;
+    errno = ENOPROTOOPT;
+    return false;
+#endif
+}
+
+bool SockOps::setUdpGro(int sockfd, bool on)
+{
+#ifdef UDP_GRO
+    int optval = on ? 1 : 0;
+    return ::setsockopt(sockfd, SOL_UDP, UDP_GRO,
+                        &optval, static_cast<socklen_t>(sizeof optval)) == 0;
+#else
+    (void)sockfd;
+    (void)on;
+    errno = ENOPROTOOPT;
+    return false;
+#endif
+}
+
 struct sockaddr_in SockOps::getLocalAddr(int sockfd)
 {
     struct sockaddr_in localaddr;
@@ -18,6 +18,8 @@
 #include <arpa/inet.h>
 #include <tesla/base/Noncopyable.hpp>
 
+struct mmsghdr;
+
 namespace tesla
 {
 
@@ -32,6 +34,10 @@ public:
     /// Creates a non-blocking socket file descriptor,
     /// abort if any error.
     static int createNonblockingOrDie();
+    ///
+    /// Creates a non-blocking UDP socket file descriptor,
+    /// abort if any error.
+    static int createNonblockingUdpOrDie();
 
     static int connect(int sockfd, const struct sockaddr_in& addr);
     static void bindOrDie(int sockfd, const struct sockaddr_in& addr);
@@ -40,9 +46,20 @@ public:
     static ssize_t read(int sockfd, void *buf, size_t count);
     static ssize_t readv(int sockfd, const struct iovec *iov, int iovcnt);
     static ssize_t write(int sockfd, const void *buf, size_t count);
+    static ssize_t writev(int sockfd, const struct iovec *iov, int iovcnt);
+    /// datagrams received or sent, -1 on error
+    static int recvmmsg(int sockfd, struct mmsghdr* msgvec, unsigned int vlen);
+    static int sendmmsg(int sockfd, struct mmsghdr* msgvec, unsigned int vlen);
     static void close(int sockfd);
     static void shutdownWrite(int sockfd);
     static int getSocketError(int sockfd);
+    /// SO_RCVBUF, 0 on error
+    static int getReceiveBufferSize(int sockfd);
+    static void setReceiveBufferSize(int sockfd, int bytes);
+    /// UDP_SEGMENT, 0 to probe for GSO, false if the kernel lacks it
+    static bool setUdpSegment(int sockfd, int segmentSize);
+    /// UDP_GRO, false if the kernel lacks it
+    static bool setUdpGro(int sockfd, bool on);
     static struct sockaddr_in getLocalAddr(int sockfd);
     static struct sockaddr_in getPeerAddr(int sockfd);
     static bool selfConnect(int sockfd);
@@ -7,6 +7,7 @@
 #include <netinet/in.h>
 #include <netinet/tcp.h>
 #include <strings.h>  // bzero
+#include <unistd.h>
 
 namespace tesla
 {
@@ -56,6 +57,24 @@ void Socket::setTcpNoDelay(bool on)
     // FIXME CHECK
 }
 
+void Socket::setBusyPoll(int microseconds)
+{
+#ifdef SO_BUSY_POLL
+    int optval = microseconds;
+    int ret = ::setsockopt(sockfd_, SOL_SOCKET, SO_BUSY_POLL,
+                           &optval, static_cast<socklen_t>(sizeof optval));
+    if (ret < 0)
+    {
+        LOG_SYSERR << "SO_BUSY_POLL failed.";
+    }
+#else
+    if (microseconds > 0)
+    {
+        LOG_ERROR << "SO_BUSY_POLL is not supported.";
+    }
+#endif
+}
+
 void Socket::setReuseAddr(bool on)
 {
     int optval = on ? 1 : 0;
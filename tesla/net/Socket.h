@@ -81,6 +81,12 @@ public:
     ///
     void setKeepAlive(bool on);
 
+    ///
+    /// SO_BUSY_POLL, microseconds to busy poll the device queue
+    /// on a blocking read, 0 to disable
+    ///
+    void setBusyPoll(int microseconds);
+
 private:
     const int sockfd_;
 };
@@ -6,8 +6,7 @@
 #include <tesla/net/SockOps.h>
 
 #if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
-typedef std::shared_ptr<Connector> ConnectorPtr;
-#include <memory>
+#include <functional>
 #else // __GXX_EXPERIMENTAL_CXX0X__
 #include <boost/bind.hpp>
 #endif // __GXX_EXPERIMENTAL_CXX0X__
@@ -21,10 +20,16 @@ namespace net
 {
 
 using namespace tesla::base;
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+using std::bind;
+using namespace std::placeholders;
+#else // __GXX_EXPERIMENTAL_CXX0X__
+using boost::bind;
+#endif // __GXX_EXPERIMENTAL_CXX0X__
 
 void internalRemoveConnection(EventLoop* loop, const TcpConnectionPtr& conn)
 {
-    loop->queueInLoop(boost::bind(&TcpConnection::connectDestroyed, conn));
+    loop->queueInLoop(bind(&TcpConnection::connectDestroyed, conn));
 }
 
 void removeConnector(const ConnectorPtr& connector)
@@ -45,16 +50,16 @@ TcpClient::TcpClient(EventLoop* loop,
       nextConnId_(1)
 {
     connector_->setNewConnectionCallback(
-        boost::bind(&TcpClient::newConnection, this, _1));
+        bind(&TcpClient::newConnection, this, _1));
     // FIXME setConnectFailedCallback
     LOG_INFO << "TcpClient::TcpClient[" << name_
-             << "] - connector " << get_pointer(connector_);
+             << "] - connector " << connector_.get();
 }
 
 TcpClient::~TcpClient()
 {
     LOG_INFO << "TcpClient::~TcpClient[" << name_
-             << "] - connector " << get_pointer(connector_);
+             << "] - connector " << connector_.get();
     TcpConnectionPtr conn;
     {
         MutexLockGuard lock(mutex_);
@@ -63,15 +68,15 @@ TcpClient::~TcpClient()
     if (conn)
     {
         // FIXME: not 100% safe, if we are in different thread
-        CloseCallback cb = boost::bind(internalRemoveConnection, loop_, _1);
+        CloseCallback cb = bind(internalRemoveConnection, loop_, _1);
         loop_->runInLoop(
-            boost::bind(&TcpConnection::setCloseCallback, conn, cb));
+            bind(&TcpConnection::setCloseCallback, conn, cb));
     }
     else
     {
         connector_->stop();
         // FIXME: HACK
-        loop_->runAfter(1, boost::bind(removeConnector, connector_));
+        loop_->runAfter(1, bind(removeConnector, connector_));
     }
 }
 
@@ -114,18 +119,17 @@ void TcpClient::newConnection(int sockfd)
 
     InetAddress localAddr(SockOps::getLocalAddr(sockfd));
     // FIXME poll with zero timeout to double confirm the new connection
-    // FIXME use make_shared if necessary
-    TcpConnectionPtr conn(new TcpConnection(loop_,
-                                            connName,
-                                            sockfd,
-                                            localAddr,
-                                            peerAddr));
+    TcpConnectionPtr conn(newTcpConnection(loop_,
+                                           connName,
+                                           sockfd,
+                                           localAddr,
+                                           peerAddr));
 
     conn->setConnectionCallback(connectionCallback_);
     conn->setMessageCallback(messageCallback_);
     conn->setWriteCompleteCallback(writeCompleteCallback_);
     conn->setCloseCallback(
-        boost::bind(&TcpClient::removeConnection, this, _1)); // FIXME: unsafe
+        bind(&TcpClient::removeConnection, this, _1)); // FIXME: unsafe
     {
         MutexLockGuard lock(mutex_);
         connection_ = conn;
@@ -144,7 +148,7 @@ void TcpClient::removeConnection(const TcpConnectionPtr& conn)
         connection_.reset();
     }
 
-    loop_->queueInLoop(boost::bind(&TcpConnection::connectDestroyed, conn));
+    loop_->queueInLoop(bind(&TcpConnection::connectDestroyed, conn));
     if (retry_ && connect_)
     {
         LOG_INFO << "TcpClient::connect[" << name_ << "] - Reconnecting to "
@@ -4,6 +4,7 @@
 #include <tesla/net/TcpConnection.h>
 #include <tesla/net/Channel.h>
 #include <tesla/net/EventLoop.h>
+#include <tesla/net/LoopPool.h>
 #include <tesla/net/Socket.h>
 #include <tesla/net/SockOps.h>
 
@@ -12,6 +13,7 @@
 #include <memory>
 #else // __GXX_EXPERIMENTAL_CXX0X__
 #include <boost/bind.hpp>
+#include <boost/make_shared.hpp>
 #endif // __GXX_EXPERIMENTAL_CXX0X__
 
 #include <errno.h>
@@ -26,6 +28,7 @@ namespace net
 using namespace tesla::base;
 #if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
 using std::bind;
+using namespace std::placeholders;
 #else // __GXX_EXPERIMENTAL_CXX0X__
 using boost::bind;
 #endif // __GXX_EXPERIMENTAL_CXX0X__
@@ -45,6 +48,23 @@ void defaultMessageCallback(const TcpConnectionPtr&,
     buf->retrieveAll();
 }
 
+TcpConnectionPtr newTcpConnection(EventLoop* loop,
+                                  const string& name,
+                                  int sockfd,
+                                  const InetAddress& localAddr,
+                                  const InetAddress& peerAddr)
+{
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+    return std::allocate_shared<TcpConnection>(
+               LoopAllocator<TcpConnection>(loop->pool()),
+               loop, name, sockfd, localAddr, peerAddr);
+#else // __GXX_EXPERIMENTAL_CXX0X__
+    return boost::allocate_shared<TcpConnection>(
+               LoopAllocator<TcpConnection>(loop->pool()),
+               loop, name, sockfd, localAddr, peerAddr);
+#endif // __GXX_EXPERIMENTAL_CXX0X__
+}
+
 TcpConnection::TcpConnection(EventLoop* loop,
                              const string& name,
                              int sockfd,
@@ -53,25 +73,33 @@ TcpConnection::TcpConnection(EventLoop* loop,
     : loop_(CHECK_NOTNULL(loop)),
       name_(name),
       state_(Connecting),
-      socket_(new Socket(sockfd)),
-      channel_(new Channel(loop, sockfd)),
+      socket_(sockfd),
+      channel_(loop, sockfd),
       localAddr_(localAddr),
       peerAddr_(peerAddr),
-      highWaterMark_(64*1024*1024)
+      reportedOutputBytes_(0),
+      counted_(true),
+      highWaterMark_(64*1024*1024),
+      bufferIdleSeconds_(0.0),
+      bufferReleaseArmed_(false)
 {
-    channel_->setReadCallback(bind(&TcpConnection::handleRead, this, _1));
-    channel_->setWriteCallback(bind(&TcpConnection::handleWrite, this));
-    channel_->setCloseCallback(bind(&TcpConnection::handleClose, this));
-    channel_->setErrorCallback(bind(&TcpConnection::handleError, this));
+    channel_.setReadCallback(bind(&TcpConnection::handleRead, this, _1));
+    channel_.setWriteCallback(bind(&TcpConnection::handleWrite, this));
+    channel_.setCloseCallback(bind(&TcpConnection::handleClose, this));
+    channel_.setErrorCallback(bind(&TcpConnection::handleError, this));
     LOG_DEBUG << "TcpConnection::ctor[" <<  name_ << "] at " << this
               << " fd=" << sockfd;
-    socket_->setKeepAlive(true);
+    socket_.setKeepAlive(true);
+    // counted from placement on, so that a burst of accepts
+    // does not see the loop as idle
+    loop_->addConnectionCount(1);
 }
 
 TcpConnection::~TcpConnection()
 {
     LOG_DEBUG << "TcpConnection::dtor[" <<  name_ << "] at " << this
-              << " fd=" << channel_->fd();
+              << " fd=" << channel_.fd();
+    // the loop may be gone by now, the counts were settled in connectDestroyed()
 }
 
 void TcpConnection::send(const void* data, int len)
@@ -89,15 +117,16 @@ void TcpConnection::send(const StringPiece& message)
         }
         else
         {
-            loop_->runInLoop(bind(&TcpConnection::sendInLoop,
-                            this,     // FIXME
-                            message.as_string()));
+            // std::bind does not pick among overloads
+            void (TcpConnection::*fp)(const StringPiece& message) = &TcpConnection::sendInLoop;
+            loop_->runInLoop(bind(fp,
+                                  this,     // FIXME
+                                  message.as_string()));
             //std::forward<string>(message)));
         }
     }
 }
 
-// FIXME efficiency!!!
 void TcpConnection::send(Buffer* buf)
 {
     if (state_ == Connected)
@@ -109,10 +138,65 @@ void TcpConnection::send(Buffer* buf)
         }
         else
         {
-            loop_->runInLoop(bind(&TcpConnection::sendInLoop,
-                            this,     // FIXME
-                            buf->retrieveAllAsString()));
-            //std::forward<string>(message)));
+            // takes over the storage of buf, nothing is copied
+            loop_->runInLoop(bind(&TcpConnection::sendSliceInLoop,
+                                  shared_from_this(),
+                                  Slice(buf)));
+        }
+    }
+}
+
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+void TcpConnection::send(const char* message)
+{
+    send(StringPiece(message));
+}
+
+void TcpConnection::send(string&& message)
+{
+    send(Slice(&message));
+}
+
+void TcpConnection::send(Buffer&& message)
+{
+    send(Slice(&message));
+}
+#endif // __GXX_EXPERIMENTAL_CXX0X__
+
+void TcpConnection::send(const Slice& message)
+{
+    if (state_ == Connected)
+    {
+        if (loop_->isInLoopThread())
+        {
+            sendSliceInLoop(message);
+        }
+        else
+        {
+            // copying a Slice only bumps its refcount
+            loop_->runInLoop(bind(&TcpConnection::sendSliceInLoop,
+                                  shared_from_this(),
+                                  message));
+        }
+    }
+}
+
+void TcpConnection::sendFile(const FileRegion& file, Buffer* header)
+{
+    if (state_ == Connected)
+    {
+        // takes over the storage of header, nothing is copied
+        Slice headerSlice = header != NULL ? Slice(header) : Slice();
+        if (loop_->isInLoopThread())
+        {
+            sendFileInLoop(file, headerSlice);
+        }
+        else
+        {
+            loop_->runInLoop(bind(&TcpConnection::sendFileInLoop,
+                                  shared_from_this(),
+                                  file,
+                                  headerSlice));
         }
     }
 }
@@ -123,24 +207,90 @@ void TcpConnection::sendInLoop(const StringPiece& message)
 }
 
 void TcpConnection::sendInLoop(const void* data, size_t len)
+{
+    ssize_t nwrote = writeDirectly(data, len);
+    if (nwrote >= 0 && implicit_cast<size_t>(nwrote) < len)
+    {
+        size_t remaining = len - nwrote;
+        checkHighWaterMark(remaining);
+        outputBuffer_.append(static_cast<const char*>(data)+nwrote, remaining);
+        reportOutputBytes();
+        if (!channel_.isWriting())
+        {
+            channel_.enableWriting();
+        }
+    }
+}
+
+void TcpConnection::sendSliceInLoop(const Slice& message)
+{
+    ssize_t nwrote = writeDirectly(message.data(), message.size());
+    if (nwrote >= 0 && implicit_cast<size_t>(nwrote) < message.size())
+    {
+        Slice remaining(message);
+        remaining.removePrefix(nwrote);
+        checkHighWaterMark(remaining.size());
+        outputBuffer_.append(remaining);
+        reportOutputBytes();
+        if (!channel_.isWriting())
+        {
+            channel_.enableWriting();
+        }
+    }
+}
+
+void TcpConnection::sendFileInLoop(const FileRegion& file, const Slice& header)
 {
     loop_->assertInLoopThread();
-    ssize_t nwrote = 0;
-    size_t remaining = len;
-    bool faultError = false;
     if (state_ == Disconnected)
     {
         LOG_WARN << "disconnected, give up writing";
         return;
     }
+    bool queued = channel_.isWriting() || outputBuffer_.readableBytes() > 0;
+    checkHighWaterMark(header.size() + file.size());
+    outputBuffer_.append(header);
+    outputBuffer_.append(file);
+    // nothing was queued before, so the socket has room,
+    // sends a first part now rather than after a wakeup
+    if (!queued)
+    {
+        int savedErrno = 0;
+        ssize_t n = outputBuffer_.writeFd(channel_.fd(), &savedErrno);
+        if (n < 0 && savedErrno != EWOULDBLOCK)
+        {
+            errno = savedErrno;
+            LOG_SYSERR << "TcpConnection::sendFileInLoop";
+        }
+        // a dropped region writes nothing, but is done with too
+        if (outputBuffer_.readableBytes() == 0 && writeCompleteCallback_)
+        {
+            loop_->queueInLoop(bind(writeCompleteCallback_, shared_from_this()));
+        }
+    }
+    reportOutputBytes();
+    if (outputBuffer_.readableBytes() > 0 && !channel_.isWriting())
+    {
+        channel_.enableWriting();
+    }
+}
+
+ssize_t TcpConnection::writeDirectly(const void* data, size_t len)
+{
+    loop_->assertInLoopThread();
+    ssize_t nwrote = 0;
+    if (state_ == Disconnected)
+    {
+        LOG_WARN << "disconnected, give up writing";
+        return -1;
+    }
     // if no thing in output queue, try writing directly
-    if (!channel_->isWriting() && outputBuffer_.readableBytes() == 0)
+    if (!channel_.isWriting() && outputBuffer_.readableBytes() == 0)
     {
-        nwrote = SockOps::write(channel_->fd(), data, len);
+        nwrote = SockOps::write(channel_.fd(), data, len);
         if (nwrote >= 0)
         {
-            remaining = len - nwrote;
-            if (remaining == 0 && writeCompleteCallback_)
+            if (implicit_cast<size_t>(nwrote) == len && writeCompleteCallback_)
             {
                 loop_->queueInLoop(bind(writeCompleteCallback_, shared_from_this()));
             }
@@ -153,27 +303,33 @@ void TcpConnection::sendInLoop(const void* data, size_t len)
                 LOG_SYSERR << "TcpConnection::sendInLoop";
                 if (errno == EPIPE || errno == ECONNRESET) // FIXME: any others?
                 {
-                    faultError = true;
+                    return -1;
                 }
             }
         }
     }
+    return nwrote;
+}
 
-    assert(remaining <= len);
-    if (!faultError && remaining > 0)
+void TcpConnection::checkHighWaterMark(size_t remaining)
+{
+    size_t oldLen = outputBuffer_.readableBytes();
+    if (oldLen + remaining >= highWaterMark_
+            && oldLen < highWaterMark_
+            && highWaterMarkCallback_)
     {
-        size_t oldLen = outputBuffer_.readableBytes();
-        if (oldLen + remaining >= highWaterMark_
-                && oldLen < highWaterMark_
-                && highWaterMarkCallback_)
-        {
-            loop_->queueInLoop(bind(highWaterMarkCallback_, shared_from_this(), oldLen + remaining));
-        }
-        outputBuffer_.append(static_cast<const char*>(data)+nwrote, remaining);
-        if (!channel_->isWriting())
-        {
-            channel_->enableWriting();
-        }
+        loop_->queueInLoop(bind(highWaterMarkCallback_, shared_from_this(), oldLen + remaining));
+    }
+}
+
+void TcpConnection::reportOutputBytes()
+{
+    size_t queued = outputBuffer_.readableBytes();
+    if (counted_ && queued != reportedOutputBytes_)
+    {
+        loop_->addPendingOutputBytes(static_cast<int64_t>(queued)
+                                     - static_cast<int64_t>(reportedOutputBytes_));
+        reportedOutputBytes_ = queued;
     }
 }
 
@@ -191,10 +347,10 @@ void TcpConnection::shutdown()
 void TcpConnection::shutdownInLoop()
 {
     loop_->assertInLoopThread();
-    if (!channel_->isWriting())
+    if (!channel_.isWriting())
     {
         // we are not writing
-        socket_->shutdownWrite();
+        socket_.shutdownWrite();
     }
 }
 
@@ -232,7 +388,7 @@ void TcpConnection::forceCloseInLoop()
 
 void TcpConnection::setTcpNoDelay(bool on)
 {
-    socket_->setTcpNoDelay(on);
+    socket_.setTcpNoDelay(on);
 }
 
 void TcpConnection::connectEstablished()
@@ -240,8 +396,17 @@ void TcpConnection::connectEstablished()
     loop_->assertInLoopThread();
     assert(state_ == Connecting);
     setState(Connected);
-    channel_->tie(shared_from_this());
-    channel_->enableReading();
+    if (loop_->socketBusyPoll() > 0)
+    {
+        socket_.setBusyPoll(loop_->socketBusyPoll());
+    }
+    channel_.tie(shared_from_this());
+    channel_.enableReading();
+    if (bufferIdleSeconds_ > 0.0)
+    {
+        lastActivity_ = loop_->pollReturnTime();
+        armBufferRelease(bufferIdleSeconds_);
+    }
 
     connectionCallback_(shared_from_this());
 }
@@ -252,20 +417,31 @@ void TcpConnection::connectDestroyed()
     if (state_ == Connected)
     {
         setState(Disconnected);
-        channel_->disableAll();
+        channel_.disableAll();
 
         connectionCallback_(shared_from_this());
     }
-    channel_->remove();
+    channel_.remove();
+
+    if (counted_)
+    {
+        counted_ = false;
+        loop_->addPendingOutputBytes(-static_cast<int64_t>(reportedOutputBytes_));
+        loop_->addConnectionCount(-1);
+        reportedOutputBytes_ = 0;
+    }
 }
 
 void TcpConnection::handleRead(Timestamp receiveTime)
 {
     loop_->assertInLoopThread();
     int savedErrno = 0;
-    ssize_t n = inputBuffer_.readFd(channel_->fd(), &savedErrno);
+    ssize_t n = inputBuffer_.readFd(channel_.fd(), &savedErrno,
+                                    loop_->readBuffer(channel_.fd()),
+                                    loop_->maxReadBytes());
     if (n > 0)
     {
+        noteActivity(receiveTime);
         messageCallback_(shared_from_this(), &inputBuffer_, receiveTime);
     }
     else if (n == 0)
@@ -283,39 +459,42 @@ void TcpConnection::handleRead(Timestamp receiveTime)
 void TcpConnection::handleWrite()
 {
     loop_->assertInLoopThread();
-    if (channel_->isWriting())
+    if (channel_.isWriting())
     {
-        ssize_t n = SockOps::write(channel_->fd(),
-                                   outputBuffer_.peek(),
-                                   outputBuffer_.readableBytes());
+        int savedErrno = 0;
+        // gathers the queued segments, retrieves what is written
+        ssize_t n = outputBuffer_.writeFd(channel_.fd(), &savedErrno);
+        reportOutputBytes();
         if (n > 0)
         {
-            outputBuffer_.retrieve(n);
-            if (outputBuffer_.readableBytes() == 0)
-            {
-                channel_->disableWriting();
-                if (writeCompleteCallback_)
-                {
-                    loop_->queueInLoop(bind(writeCompleteCallback_, shared_from_this()));
-                }
-                if (state_ == Disconnecting)
-                {
-                    shutdownInLoop();
-                }
-            }
+            noteActivity(loop_->pollReturnTime());
         }
-        else
+        else if (n < 0)
         {
+            errno = savedErrno;
             LOG_SYSERR << "TcpConnection::handleWrite";
             // if (state_ == Disconnecting)
             // {
             //   shutdownInLoop();
             // }
         }
+        // complete whatever was written, a dropped region writes nothing
+        if (outputBuffer_.readableBytes() == 0)
+        {
+            channel_.disableWriting();
+            if (writeCompleteCallback_)
+            {
+                loop_->queueInLoop(bind(writeCompleteCallback_, shared_from_this()));
+            }
+            if (state_ == Disconnecting)
+            {
+                shutdownInLoop();
+            }
+        }
     }
     else
     {
-        LOG_TRACE << "Connection fd = " << channel_->fd()
+        LOG_TRACE << "Connection fd = " << channel_.fd()
                   << " is down, no more writing";
     }
 }
@@ -323,11 +502,11 @@ void TcpConnection::handleWrite()
 void TcpConnection::handleClose()
 {
     loop_->assertInLoopThread();
-    LOG_TRACE << "fd = " << channel_->fd() << " state = " << state_;
+    LOG_TRACE << "fd = " << channel_.fd() << " state = " << state_;
     assert(state_ == Connected || state_ == Disconnecting);
     // we don't close fd, leave it to dtor, so we can find leaks easily.
     setState(Disconnected);
-    channel_->disableAll();
+    channel_.disableAll();
 
     TcpConnectionPtr guardThis(shared_from_this());
     connectionCallback_(guardThis);
@@ -335,9 +514,52 @@ void TcpConnection::handleClose()
     closeCallback_(guardThis);
 }
 
+void TcpConnection::noteActivity(Timestamp when)
+{
+    lastActivity_ = when;
+    if (!bufferReleaseArmed_ && bufferIdleSeconds_ > 0.0)
+    {
+        armBufferRelease(bufferIdleSeconds_);
+    }
+}
+
+void TcpConnection::armBufferRelease(double delay)
+{
+    bufferReleaseArmed_ = true;
+    // precision does not matter here, the slack lets idle
+    // connections share timer wakeups
+    loop_->runAfter(delay,
+                    makeWeakCallback(shared_from_this(),
+                                     &TcpConnection::releaseIdleBuffers),
+                    delay / 4);
+}
+
+void TcpConnection::releaseIdleBuffers()
+{
+    loop_->assertInLoopThread();
+    bufferReleaseArmed_ = false;
+    if (state_ != Connected)
+    {
+        return;
+    }
+    double quiet = static_cast<double>(Timestamp::now().microSecondsSinceEpoch()
+                                       - lastActivity_.microSecondsSinceEpoch())
+                   / Timestamp::MICROSECONDS_PER_SECOND;
+    if (quiet < bufferIdleSeconds_)
+    {
+        armBufferRelease(bufferIdleSeconds_ - quiet);
+    }
+    else
+    {
+        // the next read or write re-arms
+        inputBuffer_.release();
+        outputBuffer_.release();
+    }
+}
+
 void TcpConnection::handleError()
 {
-    int err = SockOps::getSocketError(channel_->fd());
+    int err = SockOps::getSocketError(channel_.fd());
     LOG_ERROR << "TcpConnection::handleError [" << name_
               << "] - SO_ERROR = " << err << " " << strerror_tl(err);
 }
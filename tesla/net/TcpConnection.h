@@ -22,10 +22,14 @@
 
 #include <tesla/net/Callbacks.hpp>
 #include <tesla/net/Buffer.h>
+#include <tesla/net/BufferChain.h>
+#include <tesla/net/Channel.h>
+#include <tesla/net/FileRegion.h>
 #include <tesla/net/InetAddress.h>
+#include <tesla/net/Slice.hpp>
+#include <tesla/net/Socket.h>
 
 #if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
-typedef std::shared_ptr<Connector> ConnectorPtr;
 #include <memory>
 #else // __GXX_EXPERIMENTAL_CXX0X__
 #include <boost/enable_shared_from_this.hpp>
@@ -40,19 +44,16 @@ namespace tesla
 namespace net
 {
 
-class Channel;
 class EventLoop;
-class Socket;
 
 ///
 /// TCP connection
 ///
-/// Should NOT be used directly
+/// Should NOT be used directly, created by newTcpConnection()
 class TcpConnection
     : private tesla::base::Noncopyable
 #if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
     , public std::enable_shared_from_this<TcpConnection>
-#include <memory>
 #else // __GXX_EXPERIMENTAL_CXX0X__
     , public boost::enable_shared_from_this<TcpConnection>
 #endif // __GXX_EXPERIMENTAL_CXX0X__
@@ -92,17 +93,34 @@ public:
     ///
     ///socket operations
     ///
-    // void send(tesla::base::string&& message); // C++11
     void send(const void* message, int len);
     void send(const tesla::base::StringPiece& message);
-    // void send(Buffer&& message); // C++11
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+    void send(const char* message); // keeps string literals unambiguous
+    void send(tesla::base::string&& message); // moves the storage, no copy
+    void send(Buffer&& message);              // moves the storage, no copy
+#endif // __GXX_EXPERIMENTAL_CXX0X__
     void send(Buffer* message);  // this one will swap data
+    void send(const Slice& message);  // shares the bytes, no copy
+    /// Sends the file region after what is queued, with sendfile(2),
+    /// the bytes never enter user space. The @c header, taken over
+    /// as send(Buffer*) does, goes right before it, in the same
+    /// TCP segments. Thread safe.
+    void sendFile(const FileRegion& file, Buffer* header = NULL);
     void shutdown(); // NOT thread safe, no simultaneous calling
     // void shutdownAndForceCloseAfter(double seconds); // NOT thread safe, no simultaneous calling
     void forceClose();
     void forceCloseWithDelay(double seconds);
     void setTcpNoDelay(bool on);
 
+    /// Gives the buffer storage back to the BufferPool after
+    /// @c seconds without reads or writes, 0 to keep it, the default.
+    /// Must be called before connectEstablished().
+    void setBufferIdleRelease(double seconds)
+    {
+        bufferIdleSeconds_ = seconds;
+    }
+
     ///
     /// get/set Context
     ///
@@ -157,7 +175,7 @@ public:
     {
         return &inputBuffer_;
     }
-    Buffer* outputBuffer()
+    BufferChain* outputBuffer()
     {
         return &outputBuffer_;
     }
@@ -177,11 +195,22 @@ private:
     void handleWrite();
     void handleClose();
     void handleError();
+    /// timer of setBufferIdleRelease()
+    void noteActivity(tesla::base::Timestamp when);
+    void releaseIdleBuffers();
+    void armBufferRelease(double delay);
 
     /// I/O operations in EventLoop thread
-    // void sendInLoop(tesla::base::string&& message);
     void sendInLoop(const tesla::base::StringPiece& message);
     void sendInLoop(const void* message, size_t len);
+    void sendSliceInLoop(const Slice& message);
+    void sendFileInLoop(const FileRegion& file, const Slice& header);
+    /// writes at once if nothing is queued,
+    /// returns bytes written, or -1 if the peer is gone
+    ssize_t writeDirectly(const void* message, size_t len);
+    void checkHighWaterMark(size_t remaining);
+    /// brings EventLoop::pendingOutputBytes() up to date
+    void reportOutputBytes();
     void shutdownInLoop();
     // void shutdownAndForceCloseInLoop(double seconds);
     void forceCloseInLoop();
@@ -196,14 +225,9 @@ private:
     /// one TcpConnection is binded in one loop
     EventLoop* loop_;
 
-#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
-    std::scoped_ptr<Socket> socket_;
-    std::scoped_ptr<Channel> channel_;
-#include <memory>
-#else // __GXX_EXPERIMENTAL_CXX0X__
-    boost::scoped_ptr<Socket> socket_;
-    boost::scoped_ptr<Channel> channel_;
-#endif // __GXX_EXPERIMENTAL_CXX0X__
+    /// by value, allocated with the connection, see newTcpConnection()
+    Socket socket_;
+    Channel channel_;
 
     /// local and peer InetAddress
     const InetAddress localAddr_;
@@ -218,11 +242,20 @@ private:
 
     /// I/O Buffer
     Buffer inputBuffer_;
-    Buffer outputBuffer_; // FIXME: use list<Buffer> as output buffer.
+    BufferChain outputBuffer_;
+    /// outputBuffer_ bytes counted in the loop's load
+    size_t reportedOutputBytes_;
+    /// in the loop's connection count, until connectDestroyed()
+    bool counted_;
 
     /// Watermark
     size_t highWaterMark_;
 
+    /// idle buffer release, the timer is re-armed lazily by activity
+    double bufferIdleSeconds_;
+    tesla::base::Timestamp lastActivity_;
+    bool bufferReleaseArmed_;
+
     /// Context
     boost::any context_;
 
@@ -235,11 +268,20 @@ private:
 
 #if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
 typedef std::shared_ptr<TcpConnection> TcpConnectionPtr;
-#include <memory>
 #else // __GXX_EXPERIMENTAL_CXX0X__
 typedef boost::shared_ptr<TcpConnection> TcpConnectionPtr;
 #endif // __GXX_EXPERIMENTAL_CXX0X__
 
+///
+/// Creates a TcpConnection of @c loop, with its shared_ptr control block,
+/// in one block of the loop's LoopPool if called in the loop thread.
+///
+TcpConnectionPtr newTcpConnection(EventLoop* loop,
+                                  const tesla::base::string& name,
+                                  int sockfd,
+                                  const InetAddress& localAddr,
+                                  const InetAddress& peerAddr);
+
 } // namespace net
 
 } // namespace tesla
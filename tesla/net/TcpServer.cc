@@ -1,4 +1,6 @@
+#include <tesla/base/CountdownLatch.h>
 #include <tesla/base/Logger.h>
+#include <tesla/base/WeakCallback.hpp>
 
 #include <tesla/net/TcpServer.h>
 #include <tesla/net/Acceptor.h>
@@ -23,10 +25,21 @@ namespace net
 using namespace tesla::base;
 #if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
 using std::bind;
+using namespace std::placeholders;
 #else // __GXX_EXPERIMENTAL_CXX0X__
 using boost::bind;
 #endif // __GXX_EXPERIMENTAL_CXX0X__
 
+void destroyAcceptor(Acceptor* acceptor, CountdownLatch* latch)
+{
+    delete acceptor;
+    latch->countDown();
+}
+
+void keepTcpServer(TcpServer*)
+{
+}
+
 TcpServer::TcpServer(EventLoop* loop,
                      const InetAddress& listenAddr,
                      const string& nameArg,
@@ -34,11 +47,16 @@ TcpServer::TcpServer(EventLoop* loop,
     : loop_(CHECK_NOTNULL(loop)),
       hostport_(listenAddr.toIpPort()),
       name_(nameArg),
-      acceptor_(new Acceptor(loop, listenAddr, option == ReusePort)),
+      listenAddr_(listenAddr),
+      option_(option),
+      acceptor_(new Acceptor(loop, listenAddr, option != NoReusePort)),
       evThreadpool_(new EventLoopThreadPool(loop)),
+      maxAcceptsPerWakeup_(64),
+      bufferIdleSeconds_(0.0),
       connectionCallback_(defaultConnectionCallback),
       messageCallback_(defaultMessageCallback),
-      nextConnId_(1)
+      nextConnId_(1),
+      self_(this, keepTcpServer)
 {
     acceptor_->setNewConnectionCallback(bind(&TcpServer::newConnection, this, _1, _2));
 }
@@ -48,6 +66,47 @@ TcpServer::~TcpServer()
     loop_->assertInLoopThread();
     LOG_TRACE << "TcpServer::~TcpServer [" << name_ << "] destructing";
 
+    // no acceptor may call back after this
+    if (!loopAcceptors_.empty())
+    {
+        CountdownLatch latch(static_cast<int>(loopAcceptors_.size()));
+        for (size_t i = 0; i < loopAcceptors_.size(); ++i)
+        {
+            Acceptor* acceptor = loopAcceptors_[i];
+            acceptor->getLoop()->runInLoop(bind(&destroyAcceptor, acceptor, &latch));
+        }
+        latch.wait();
+        loopAcceptors_.clear();
+    }
+
+    // no newConnectionInLoop() may still be queued in an io loop after this
+    std::vector<EventLoop*> loops;
+    if (started_.atomicGet() != 0)
+    {
+        loops = evThreadpool_->getAllLoops();
+    }
+    if (!loops.empty() && loops.front() != loop_)
+    {
+        CountdownLatch latch(static_cast<int>(loops.size()));
+        for (size_t i = 0; i < loops.size(); ++i)
+        {
+            loops[i]->runInLoop(bind(&CountdownLatch::countDown, &latch));
+        }
+        latch.wait();
+    }
+
+    // addPendingConnections() still queued finds the server gone,
+    // the connections it would add are taken here
+    self_.reset();
+    {
+        MutexLockGuard lock(mutex_);
+        for (size_t i = 0; i < pendingConnections_.size(); ++i)
+        {
+            connections_[pendingConnections_[i]->name()] = pendingConnections_[i];
+        }
+        pendingConnections_.clear();
+    }
+
     for (ConnectionMap::iterator it(connections_.begin());
             it != connections_.end(); ++it)
     {
@@ -64,47 +123,126 @@ void TcpServer::setThreadNum(int numThreads)
     evThreadpool_->setThreadNum(numThreads);
 }
 
+void TcpServer::setMaxAcceptsPerWakeup(int n)
+{
+    assert(loopAcceptors_.empty());
+    maxAcceptsPerWakeup_ = n;
+    acceptor_->setMaxAcceptsPerWakeup(n);
+}
+
 void TcpServer::start()
 {
     if (started_.atomicSet(1) == 0)
     {
         evThreadpool_->start(threadInitCallback_);
 
-        assert(!acceptor_->listening());
-        loop_->runInLoop(bind(&Acceptor::listen, get_pointer(acceptor_)));
+        std::vector<EventLoop*> loops = evThreadpool_->getAllLoops();
+        if (option_ == ReusePortPerLoop && loops.front() != loop_)
+        {
+            // acceptor_ stays bound but never listens, only listening
+            // sockets of the reuseport group get connections.
+            for (size_t i = 0; i < loops.size(); ++i)
+            {
+                EventLoop* ioLoop = loops[i];
+                Acceptor* acceptor = new Acceptor(ioLoop, listenAddr_, true);
+                acceptor->setMaxAcceptsPerWakeup(maxAcceptsPerWakeup_);
+                acceptor->setNewConnectionCallback(
+                    bind(&TcpServer::newConnectionInLoop, this, ioLoop, _1, _2, false));
+                loopAcceptors_.push_back(acceptor);
+                ioLoop->runInLoop(bind(&Acceptor::listen, acceptor));
+            }
+        }
+        else
+        {
+            assert(!acceptor_->listening());
+            loop_->runInLoop(bind(&Acceptor::listen, acceptor_.get()));
+        }
     }
 }
 
 void TcpServer::newConnection(int sockfd, const InetAddress& peerAddr)
 {
     loop_->assertInLoopThread();
+    EventLoop* ioLoop = evThreadpool_->getNextLoop(peerAddr);
+    if (ioLoop == loop_)
+    {
+        TcpConnectionPtr conn(createConnection(ioLoop, sockfd, peerAddr));
+        connections_[conn->name()] = conn;
+        conn->connectEstablished();
+        return;
+    }
 
+    // counted now, for the placement of the next accepts, the connection
+    // is made in its loop, from its LoopPool. The destructor drains the
+    // io loops, so the queued this stays valid.
+    ioLoop->addConnectionCount(1);
+    ioLoop->queueInLoop(bind(&TcpServer::newConnectionInLoop,
+                             this, ioLoop, sockfd, peerAddr, true));
+}
+
+void TcpServer::newConnectionInLoop(EventLoop* ioLoop,
+                                    int sockfd,
+                                    const InetAddress& peerAddr,
+                                    bool counted)
+{
+    ioLoop->assertInLoopThread();
+    TcpConnectionPtr conn(createConnection(ioLoop, sockfd, peerAddr));
+    if (counted)
+    {
+        // the connection counts itself
+        ioLoop->addConnectionCount(-1);
+    }
+    {
+        MutexLockGuard lock(mutex_);
+        pendingConnections_.push_back(conn);
+    }
+    // the base loop keeps the books only, queued before any removeConnection
+    // of this connection, so the two can not be reordered.
+    loop_->runInLoop(makeWeakCallback(self_, &TcpServer::addPendingConnections));
+    conn->connectEstablished();
+}
+
+TcpConnectionPtr TcpServer::createConnection(EventLoop* ioLoop,
+                                             int sockfd,
+                                             const InetAddress& peerAddr)
+{
     char buf[32];
-    snprintf(buf, sizeof buf, ":%s#%d", hostport_.c_str(), nextConnId_);
-    ++nextConnId_;
+    snprintf(buf, sizeof buf, ":%s#%d", hostport_.c_str(),
+             __sync_fetch_and_add(&nextConnId_, 1));
     string connName = name_ + buf;
 
     LOG_INFO << "TcpServer::newConnection [" << name_
              << "] - new connection [" << connName
              << "] from " << peerAddr.toIpPort();
 
-    EventLoop* ioLoop = evThreadpool_->getNextLoop();
     InetAddress localAddr(SockOps::getLocalAddr(sockfd));
     // FIXME poll with zero timeout to double confirm the new connection
-    // FIXME use make_shared if necessary
-    TcpConnectionPtr conn(new TcpConnection(ioLoop,
-                                            connName,
-                                            sockfd,
-                                            localAddr,
-                                            peerAddr));
-    connections_[connName] = conn;
+    TcpConnectionPtr conn(newTcpConnection(ioLoop,
+                                           connName,
+                                           sockfd,
+                                           localAddr,
+                                           peerAddr));
 
     conn->setConnectionCallback(connectionCallback_);
     conn->setMessageCallback(messageCallback_);
     conn->setWriteCompleteCallback(writeCompleteCallback_);
     conn->setCloseCallback(bind(&TcpServer::removeConnection, this, _1)); // FIXME: unsafe
+    conn->setBufferIdleRelease(bufferIdleSeconds_);
+    return conn;
+}
 
-    ioLoop->runInLoop(bind(&TcpConnection::connectEstablished, conn));
+void TcpServer::addPendingConnections()
+{
+    loop_->assertInLoopThread();
+    std::vector<TcpConnectionPtr> connections;
+    {
+        MutexLockGuard lock(mutex_);
+        connections.swap(pendingConnections_);
+    }
+    for (size_t i = 0; i < connections.size(); ++i)
+    {
+        connections_[connections[i]->name()] = connections[i];
+    }
 }
 
 void TcpServer::removeConnection(const TcpConnectionPtr& conn)
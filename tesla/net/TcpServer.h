@@ -16,6 +16,7 @@
 #define TESLA_NET_TCPSERVER_H
 
 #include <tesla/base/Atomic.hpp>
+#include <tesla/base/Mutex.hpp>
 #include <tesla/base/Types.hpp>
 #include <tesla/base/Noncopyable.hpp>
 
@@ -26,9 +27,11 @@
 #else // __GXX_EXPERIMENTAL_CXX0X__
 #include <boost/scoped_ptr.hpp>
 #include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
 #endif // __GXX_EXPERIMENTAL_CXX0X__
 
 #include <map>
+#include <vector>
 
 namespace tesla
 {
@@ -57,6 +60,9 @@ public:
     {
         NoReusePort,
         ReusePort,
+        /// every I/O loop accepts on its own SO_REUSEPORT socket,
+        /// the kernel spreads the connections among them
+        ReusePortPerLoop,
     };
 
     //TcpServer(EventLoop* loop, const InetAddress& listenAddr);
@@ -81,20 +87,22 @@ public:
 
     /// Set the number of threads for handling input.
     ///
-    /// Always accepts new connection in loop's thread.
+    /// Accepts new connection in loop's thread, unless the option is
+    /// ReusePortPerLoop, then each I/O thread accepts its own ones.
     /// Must be called before call start
     /// @param numThreads
     /// - 0 means all I/O in loop's thread, no thread will created.
     ///   this is the default value.
     /// - 1 means all I/O in another thread.
     /// - N means a thread pool with N threads, new connections
-    ///   are assigned on a round-robin basis.
+    ///   are assigned on a round-robin basis, or by the placement
+    ///   set with evThreadPool()->setPlacement().
     void setThreadNum(int numThreads);
 
-    /// valid after calling start()
+    /// the loops valid after calling start()
     EventLoopThreadPool* evThreadPool()
     {
-        return get_pointer(evThreadpool_);
+        return evThreadpool_.get();
     }
 
     /// Starts the server if it's not listenning.
@@ -103,6 +111,19 @@ public:
     /// Thread safe.
     void start();
 
+    /// At most @c n connections are accepted per wakeup of the
+    /// acceptor, see Acceptor::setMaxAcceptsPerWakeup().
+    /// Not thread safe, but in loop
+    void setMaxAcceptsPerWakeup(int n);
+
+    /// New connections give their buffer storage back after
+    /// @c seconds idle, see TcpConnection::setBufferIdleRelease().
+    /// Not thread safe, but in loop
+    void setBufferIdleRelease(double seconds)
+    {
+        bufferIdleSeconds_ = seconds;
+    }
+
     /// Set thread-inited callback.
     /// Not thread safe, but in loop
     /// when all thread inited, invoke the user-callback
@@ -135,6 +156,18 @@ private:
 
     /// Not thread safe, but in loop
     void newConnection(int sockfd, const InetAddress& peerAddr);
+    /// In @c ioLoop, for newConnection() or for its own acceptor
+    /// in ReusePortPerLoop mode, @c counted if placement counted it
+    void newConnectionInLoop(EventLoop* ioLoop,
+                             int sockfd,
+                             const InetAddress& peerAddr,
+                             bool counted);
+    /// Thread safe
+    TcpConnectionPtr createConnection(EventLoop* ioLoop,
+                                      int sockfd,
+                                      const InetAddress& peerAddr);
+    /// Not thread safe, but in loop
+    void addPendingConnections();
     /// Thread safe
     void removeConnection(const TcpConnectionPtr& conn);
     /// Not thread safe, but in loop
@@ -145,14 +178,20 @@ private:
 
     const tesla::base::string hostport_;
     const tesla::base::string name_;
+    const InetAddress listenAddr_;
+    const Option option_;
 
 #if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
-    std::scoped_ptr<Acceptor> acceptor_; // avoid revealing Acceptor
-    std::scoped_ptr<EventLoopThreadPool> evThreadpool_;
+    std::unique_ptr<Acceptor> acceptor_; // avoid revealing Acceptor
+    std::unique_ptr<EventLoopThreadPool> evThreadpool_;
 #else // __GXX_EXPERIMENTAL_CXX0X__
     boost::scoped_ptr<Acceptor> acceptor_; // avoid revealing Acceptor
     boost::scoped_ptr<EventLoopThreadPool> evThreadpool_;
 #endif // __GXX_EXPERIMENTAL_CXX0X__
+    /// one per I/O loop in ReusePortPerLoop mode, destroyed in its loop
+    std::vector<Acceptor*> loopAcceptors_;
+    int maxAcceptsPerWakeup_;
+    double bufferIdleSeconds_;
 
     /// callbacks (for TcpConnections to use, managed here)
     ConnectionCallback connectionCallback_;
@@ -163,11 +202,23 @@ private:
     /// whether start is called, it's construct-initialized as 0
     tesla::base::AtomicInt32 started_;
 
-    /// mark the count of the current connection
+    /// mark the count of the current connection,
+    /// atomic in ReusePortPerLoop mode
     int nextConnId_;
 
     /// connections keyed by name
     ConnectionMap connections_;
+
+    /// made in the io loops, for addPendingConnections()
+    tesla::base::MutexLock mutex_;
+    std::vector<TcpConnectionPtr> pendingConnections_; // @GuardedBy mutex_
+    /// never deletes, expires as the server destructs, so that
+    /// functors queued to the base loop find it gone
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+    std::shared_ptr<TcpServer> self_;
+#else // __GXX_EXPERIMENTAL_CXX0X__
+    boost::shared_ptr<TcpServer> self_;
+#endif // __GXX_EXPERIMENTAL_CXX0X__
 }; // class TcpServer
 
 } // namespace net
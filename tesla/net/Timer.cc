@@ -1,5 +1,7 @@
 #include <tesla/net/Timer.h>
 
+#include <assert.h>
+
 namespace tesla
 {
 
@@ -14,7 +16,7 @@ void Timer::restart(Timestamp now)
 {
     if (repeat_)
     {
-        expiration_ = addTime(now, interval_);
+        expiration_ = withSlack(addTime(now, interval_), slack_);
     }
     else
     {
@@ -22,6 +24,36 @@ void Timer::restart(Timestamp now)
     }
 }
 
+Timestamp Timer::withSlack(Timestamp when, double slack)
+{
+    int64_t slackUs = static_cast<int64_t>(slack * Timestamp::MICROSECONDS_PER_SECOND);
+    if (slackUs <= 0)
+    {
+        return when;
+    }
+    int64_t granule = 1;
+    while (granule * 2 <= slackUs)
+    {
+        granule *= 2;
+    }
+    // granule <= slack, so it never moves before when
+    int64_t deadline = when.microSecondsSinceEpoch() + slackUs;
+    return Timestamp(deadline - deadline % granule);
+}
+
+void Timer::reset(const TimerCallback& cb, Timestamp when, double interval,
+                  double slack)
+{
+    assert(bucket_ == NULL);
+    callback_ = cb;
+    expiration_ = withSlack(when, slack);
+    interval_ = interval;
+    slack_ = slack;
+    repeat_ = interval > 0.0;
+    sequence_ = s_nCreated_.atomicIncrement();
+    canceled_ = false;
+}
+
 } // namesapce net
 
 } // namespace tesla
@@ -34,21 +34,35 @@ class Timer
     : private tesla::base::Noncopyable
 {
 public:
-    Timer(const TimerCallback& cb, tesla::base::Timestamp when, double interval)
+    Timer(const TimerCallback& cb, tesla::base::Timestamp when, double interval,
+          double slack = 0.0)
         : callback_(cb),
-          expiration_(when),
+          expiration_(withSlack(when, slack)),
           interval_(interval),
+          slack_(slack),
           repeat_(interval > 0.0),
-          sequence_(s_nCreated_.atomicIncrement())
+          sequence_(s_nCreated_.atomicIncrement()),
+          prev_(NULL),
+          next_(NULL),
+          bucket_(NULL),
+          level_(-1),
+          canceled_(false)
     { }
 
 #if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
-    Timer(TimerCallback&& cb, Timestamp when, double interval)
+    Timer(TimerCallback&& cb, tesla::base::Timestamp when, double interval,
+          double slack = 0.0)
         : callback_(std::move(cb)),
-          expiration_(when),
+          expiration_(withSlack(when, slack)),
           interval_(interval),
+          slack_(slack),
           repeat_(interval > 0.0),
-          sequence_(s_nCreated_.atomicIncrement())
+          sequence_(s_nCreated_.atomicIncrement()),
+          prev_(NULL),
+          next_(NULL),
+          bucket_(NULL),
+          level_(-1),
+          canceled_(false)
     { }
 #endif
 
@@ -72,17 +86,42 @@ public:
 
     void restart(tesla::base::Timestamp now);
 
+    /// Reuses a pooled timer for a new schedule, under a new sequence,
+    /// so stale TimerIds of it no longer match.
+    void reset(const TimerCallback& cb, tesla::base::Timestamp when, double interval,
+               double slack);
+    /// Drops the callback, and whatever it has bound, while pooled.
+    void clear()
+    {
+        callback_ = TimerCallback();
+    }
+
+    /// Latest time in [when, when + slack] that is a multiple of the
+    /// largest power of two microseconds not above slack,
+    /// so timers with close deadlines share one expiration.
+    static tesla::base::Timestamp withSlack(tesla::base::Timestamp when, double slack);
+
     static int64_t numCreated()
     {
         return s_nCreated_.atomicGet();
     }
 
 private:
-    const TimerCallback callback_;
+    friend class WheelTimerQueue;
+
+    TimerCallback callback_;
     tesla::base::Timestamp expiration_;
-    const double interval_;
-    const bool repeat_;
-    const int64_t sequence_;
+    double interval_;
+    double slack_;
+    bool repeat_;
+    int64_t sequence_;
+
+    /// intrusive links, used by WheelTimerQueue
+    Timer* prev_;
+    Timer* next_;
+    Timer** bucket_;  // head of the slot list, NULL if not linked
+    int level_;
+    bool canceled_;   // canceled while running
 
     static tesla::base::AtomicInt64 s_nCreated_;
 }; // class Timer
@@ -15,15 +15,13 @@
 #ifndef TESLA_NET_TIMERQUEUE_H
 #define TESLA_NET_TIMERQUEUE_H
 
-#include <set>
-#include <vector>
-
 #include <tesla/base/Noncopyable.hpp>
-#include <tesla/base/Mutex.hpp>
 #include <tesla/base/Timestamp.h>
 
 #include <tesla/net/Callbacks.hpp>
 #include <tesla/net/Channel.h>
+#include <tesla/net/EventLoop.h>
+#include <tesla/net/TimerId.hpp>
 
 namespace tesla
 {
@@ -31,69 +29,81 @@ namespace tesla
 namespace net
 {
 
-class EventLoop;
 class Timer;
-class TimerId;
 
 ///
-/// A best efforts timer queue.
+/// Base class of timer queues, a best efforts one.
 /// No guarantee that the callback will be on time.
 ///
+/// Owns a timerfd, which wakes the loop up when timers expire.
 class TimerQueue
     : private tesla::base::Noncopyable
 {
 public:
     TimerQueue(EventLoop* loop);
-    ~TimerQueue();
+    virtual ~TimerQueue();
 
     ///
     /// Schedules the callback to be run at given time,
     /// repeats if @c interval > 0.0.
+    /// It may run up to @c slack seconds late, see Timer::withSlack().
     ///
     /// Must be thread safe. Usually be called from other threads.
-    TimerId addTimer(const TimerCallback& cb,
-                     tesla::base::Timestamp when,
-                     double interval);
+    virtual TimerId addTimer(const TimerCallback& cb,
+                             tesla::base::Timestamp when,
+                             double interval,
+                             double slack) = 0;
 #if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
-    TimerId addTimer(TimerCallback&& cb,
-                     tesla::base::Timestamp when,
-                     double interval);
+    virtual TimerId addTimer(TimerCallback&& cb,
+                             tesla::base::Timestamp when,
+                             double interval,
+                             double slack) = 0;
 #endif
 
-    void cancel(TimerId timerId);
-
-private:
+    /// Must be thread safe.
+    virtual void cancel(TimerId timerId) = 0;
+
+    /// timerfd_settime(2) calls
+    int64_t timerfdResets() const
+    {
+        return timerfdResets_;
+    }
+    /// timers run by a wakeup that another timer of it has paid for
+    int64_t mergedWakeups() const
+    {
+        return mergedWakeups_;
+    }
+
+    static TimerQueue* newTimerQueue(EventLoop* loop,
+                                     EventLoop::TimerOption option);
+
+protected:
+    static Timer* timerOf(const TimerId& timerId)
+    {
+        return timerId.timer_;
+    }
+    static int64_t sequenceOf(const TimerId& timerId)
+    {
+        return timerId.sequence_;
+    }
+
+    /// Arms the timerfd, the loop wakes up at @c expiration.
+    void resetTimerfd(tesla::base::Timestamp expiration);
 
-    // FIXME: use unique_ptr<Timer> instead of raw pointers.
-    typedef std::pair<tesla::base::Timestamp, Timer*> Entry;
-    typedef std::set<Entry> TimerList;
-    typedef std::pair<Timer*, int64_t> ActiveTimer;
-    typedef std::set<ActiveTimer> ActiveTimerSet;
+    EventLoop* loop_;
 
-    void addTimerInLoop(Timer* timer);
-    void cancelInLoop(TimerId timerId);
-    // called when timerfd alarms
+private:
+    /// called when timerfd alarms, after it is read
+    /// @return number of timers run
+    virtual size_t handleExpired(tesla::base::Timestamp now) = 0;
     void handleRead();
-    // move out all expired timers
-    std::vector<Entry> getExpired(tesla::base::Timestamp now);
-    void reset(const std::vector<Entry>& expired, tesla::base::Timestamp now);
-
-    bool insert(Timer* timer);
-
-    EventLoop* loop_;
 
     /// timer eventfd and it's channel
     const int timerfd_;
     Channel timerfdChannel_;
 
-    // Timer list sorted by expiration
-    TimerList timers_;
-
-    /// timer sets
-    ActiveTimerSet activeTimers_;
-    ActiveTimerSet cancelingTimers_;
-
-    bool callingExpiredTimers_; /* atomic */
+    int64_t timerfdResets_;
+    int64_t mergedWakeups_;
 }; // class TimerQueue
 
 } // namespace net
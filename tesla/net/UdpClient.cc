@@ -1,3 +1,27 @@
-//make it not empty and can be compiled
 #include <tesla/net/UdpClient.h>
 
+namespace tesla
+{
+
+namespace net
+{
+
+using namespace tesla::base;
+
+UdpClient::UdpClient(EventLoop* loop,
+                     const InetAddress& serverAddr,
+                     const string& name)
+    : serverAddr_(serverAddr),
+      endpoint_(new UdpEndpoint(loop, name))
+{
+    endpoint_->connect(serverAddr_);
+}
+
+UdpClient::~UdpClient()
+{
+    endpoint_->stop();
+}
+
+} // namespace net
+
+} // namespace tesla
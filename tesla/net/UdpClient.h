@@ -1,5 +1,103 @@
-//make it not empty and can be compiled
+/*
+ *
+ * Author:
+ *     Thomas Liu
+ * Date:
+ *     10/18/2026
+ * Description:
+ *     UDP client, a UdpEndpoint connected to one server
+ *
+ *
+ * Licensed under the Apache License, Version 2.0
+ *
+ */
+
 #ifndef TESLA_NET_UDPCLIENT_H
 #define TESLA_NET_UDPCLIENT_H
 
-#endif
+#include <tesla/base/Noncopyable.hpp>
+
+#include <tesla/net/UdpEndpoint.h>
+
+namespace tesla
+{
+
+namespace net
+{
+
+///
+/// Sends to and receives from @c serverAddr only, on a connected
+/// socket, so the kernel skips the route lookup of every send.
+/// Errors of earlier sends, as ICMP port unreachable, are ignored.
+///
+class UdpClient
+    : private tesla::base::Noncopyable
+{
+public:
+    UdpClient(EventLoop* loop,
+              const InetAddress& serverAddr,
+              const tesla::base::string& name);
+    ~UdpClient();  // stops the endpoint
+
+    /// Not thread safe, set it before start().
+    /// The views are valid within the callback.
+    void setDatagramCallback(const UdpEndpoint::DatagramCallback& cb)
+    {
+        endpoint_->setDatagramCallback(cb);
+    }
+
+    /// See UdpEndpoint::enableGso() and UdpEndpoint::enableGro().
+    /// Not thread safe, call them before start().
+    void enableGso()
+    {
+        endpoint_->enableGso();
+    }
+    void enableGro()
+    {
+        endpoint_->enableGro();
+    }
+
+    /// Thread safe.
+    void start()
+    {
+        endpoint_->start();
+    }
+
+    /// Thread safe.
+    void send(const tesla::base::StringPiece& data)
+    {
+        endpoint_->send(data);
+    }
+    /// Datagrams of @c segmentSize bytes each. Thread safe.
+    void sendSegments(const tesla::base::StringPiece& data, size_t segmentSize)
+    {
+        endpoint_->sendSegments(data, segmentSize);
+    }
+
+    EventLoop* getLoop() const
+    {
+        return endpoint_->getLoop();
+    }
+    const tesla::base::string& name() const
+    {
+        return endpoint_->name();
+    }
+    const InetAddress& serverAddress() const
+    {
+        return serverAddr_;
+    }
+    const UdpEndpointPtr& endpoint() const
+    {
+        return endpoint_;
+    }
+
+private:
+    const InetAddress serverAddr_;
+    UdpEndpointPtr endpoint_;
+}; // class UdpClient
+
+} // namespace net
+
+} // namespace tesla
+
+#endif  // TESLA_NET_UDPCLIENT_H
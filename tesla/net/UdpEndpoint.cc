@@ -0,0 +1,403 @@
+#include <tesla/base/Logger.h>
+
+#include <tesla/net/EventLoop.h>
+#include <tesla/net/SockOps.h>
+#include <tesla/net/UdpEndpoint.h>
+
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+#include <functional>
+#else // __GXX_EXPERIMENTAL_CXX0X__
+#include <boost/bind.hpp>
+#endif // __GXX_EXPERIMENTAL_CXX0X__
+
+#include <algorithm>
+
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <string.h>
+
+namespace tesla
+{
+
+namespace net
+{
+
+using namespace tesla::base;
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+using std::bind;
+using namespace std::placeholders;
+#else // __GXX_EXPERIMENTAL_CXX0X__
+using boost::bind;
+#endif // __GXX_EXPERIMENTAL_CXX0X__
+
+const int UdpEndpoint::MAX_SEND_BATCH;
+const size_t UdpEndpoint::MAX_QUEUED_BYTES;
+const size_t UdpEndpoint::MAX_GSO_SEGMENTS;
+const size_t UdpEndpoint::MAX_GSO_BYTES;
+
+UdpEndpoint::UdpEndpoint(EventLoop* loop, const string& name)
+    : loop_(loop),
+      name_(name),
+      socket_(SockOps::createNonblockingUdpOrDie()),
+      channel_(loop, socket_.fd()),
+      started_(false),
+      maxReadDatagrams_(1024),
+      gsoRequested_(false),
+      groRequested_(false),
+      gso_(false),
+      gro_(false),
+      sentOutgoing_(0),
+      sendMsgs_(MAX_SEND_BATCH),
+      sendIovecs_(MAX_SEND_BATCH),
+      sendControls_(MAX_SEND_BATCH),
+      flushQueued_(false),
+      receivedDatagrams_(0),
+      receiveCalls_(0),
+      sentDatagrams_(0),
+      sendCalls_(0),
+      droppedDatagrams_(0)
+{
+    channel_.setReadCallback(bind(&UdpEndpoint::handleRead, this, _1));
+    channel_.setWriteCallback(bind(&UdpEndpoint::handleWrite, this));
+    datagrams_.reserve(DatagramRing::MAX_BATCH);
+    ::memset(&sendMsgs_[0], 0, MAX_SEND_BATCH * sizeof sendMsgs_[0]);
+    for (int i = 0; i < MAX_SEND_BATCH; ++i)
+    {
+        sendMsgs_[i].msg_hdr.msg_iov = &sendIovecs_[i];
+        sendMsgs_[i].msg_hdr.msg_iovlen = 1;
+    }
+}
+
+UdpEndpoint::~UdpEndpoint()
+{
+    LOG_DEBUG << "UdpEndpoint::dtor[" << name_ << "] at " << this;
+    assert(!started_);
+}
+
+void UdpEndpoint::bindAddress(const InetAddress& localAddr, bool reusePort)
+{
+    socket_.setReuseAddr(true);
+    socket_.setReusePort(reusePort);
+    socket_.bindAddress(localAddr);
+}
+
+void UdpEndpoint::connect(const InetAddress& peerAddr)
+{
+    if (SockOps::connect(socket_.fd(), peerAddr.getSockAddrInet()) < 0)
+    {
+        LOG_SYSERR << "UdpEndpoint::connect[" << name_ << "] to " << peerAddr.toIpPort();
+    }
+}
+
+void UdpEndpoint::setReceiveBufferSize(int bytes)
+{
+    SockOps::setReceiveBufferSize(socket_.fd(), bytes);
+}
+
+void UdpEndpoint::start()
+{
+    loop_->runInLoop(bind(&UdpEndpoint::startInLoop, shared_from_this()));
+}
+
+void UdpEndpoint::startInLoop()
+{
+    loop_->assertInLoopThread();
+    if (!started_)
+    {
+        started_ = true;
+        if (gsoRequested_)
+        {
+            // 0 sets no default size, it only tells whether the kernel knows it
+            gso_ = SockOps::setUdpSegment(socket_.fd(), 0);
+            if (!gso_)
+            {
+                LOG_WARN << "UdpEndpoint::startInLoop[" << name_
+                         << "] no UDP_SEGMENT, a message per datagram";
+            }
+        }
+        if (groRequested_)
+        {
+            if (!loop_->datagramRing()->canCoalesce())
+            {
+                LOG_WARN << "UdpEndpoint::startInLoop[" << name_
+                         << "] DatagramRing too small for UDP_GRO";
+            }
+            else
+            {
+                gro_ = SockOps::setUdpGro(socket_.fd(), true);
+                if (!gro_)
+                {
+                    LOG_WARN << "UdpEndpoint::startInLoop[" << name_
+                             << "] no UDP_GRO, a message per datagram";
+                }
+            }
+        }
+        channel_.tie(shared_from_this());
+        channel_.enableReading();
+    }
+}
+
+void UdpEndpoint::stop()
+{
+    loop_->runInLoop(bind(&UdpEndpoint::stopInLoop, shared_from_this()));
+}
+
+void UdpEndpoint::stopInLoop()
+{
+    loop_->assertInLoopThread();
+    if (started_)
+    {
+        started_ = false;
+        channel_.disableAll();
+        channel_.remove();
+        for (size_t i = sentOutgoing_; i < outgoing_.size(); ++i)
+        {
+            droppedDatagrams_ += segmentsOf(outgoing_[i]);
+        }
+        outgoing_.clear();
+        sentOutgoing_ = 0;
+        output_.retrieveAll();
+    }
+}
+
+void UdpEndpoint::sendTo(const InetAddress& peerAddr, const StringPiece& data)
+{
+    sendSegmentsTo(peerAddr, data, 0);
+}
+
+void UdpEndpoint::send(const StringPiece& data)
+{
+    sendSegments(data, 0);
+}
+
+void UdpEndpoint::sendSegmentsTo(const InetAddress& peerAddr,
+                                 const StringPiece& data,
+                                 size_t segmentSize)
+{
+    if (loop_->isInLoopThread())
+    {
+        sendInLoop(peerAddr, true, data, segmentSize);
+    }
+    else
+    {
+        loop_->runInLoop(bind(&UdpEndpoint::sendStringInLoop,
+                              shared_from_this(),
+                              peerAddr,
+                              true,
+                              data.as_string(),
+                              segmentSize));
+    }
+}
+
+void UdpEndpoint::sendSegments(const StringPiece& data, size_t segmentSize)
+{
+    if (loop_->isInLoopThread())
+    {
+        sendInLoop(InetAddress(), false, data, segmentSize);
+    }
+    else
+    {
+        loop_->runInLoop(bind(&UdpEndpoint::sendStringInLoop,
+                              shared_from_this(),
+                              InetAddress(),
+                              false,
+                              data.as_string(),
+                              segmentSize));
+    }
+}
+
+void UdpEndpoint::sendStringInLoop(const InetAddress& peerAddr, bool toPeer,
+                                   const string& data, size_t segmentSize)
+{
+    sendInLoop(peerAddr, toPeer, data, segmentSize);
+}
+
+void UdpEndpoint::sendInLoop(const InetAddress& peerAddr, bool toPeer,
+                             const StringPiece& data, size_t segmentSize)
+{
+    loop_->assertInLoopThread();
+    const size_t len = data.size();
+    if (segmentSize == 0 || segmentSize > len)
+    {
+        segmentSize = len;
+    }
+    if (!started_ || output_.readableBytes() + len > MAX_QUEUED_BYTES)
+    {
+        // as segmentsOf() counts the messages below, an empty datagram is one
+        droppedDatagrams_ += len == 0 ? 1 : (len + segmentSize - 1) / segmentSize;
+        return;
+    }
+
+    // a message per datagram, or per MAX_GSO_SEGMENTS with UDP_SEGMENT
+    size_t messageSize = segmentSize;
+    if (gso_ && segmentSize > 0)
+    {
+        size_t segments = std::min(MAX_GSO_SEGMENTS, MAX_GSO_BYTES / segmentSize);
+        messageSize = std::max(segments, static_cast<size_t>(1)) * segmentSize;
+    }
+    const size_t base = output_.readableBytes();
+    size_t offset = 0;
+    do
+    {
+        size_t size = std::min(messageSize, len - offset);
+        Outgoing outgoing = { base + offset,
+                              size,
+                              peerAddr.getSockAddrInet(),
+                              toPeer,
+                              size > segmentSize ? segmentSize : 0 };
+        outgoing_.push_back(outgoing);
+        offset += size;
+    }
+    while (offset < len);
+    output_.append(data);
+
+    // the datagrams of this iteration go out together, at its end,
+    // or once writable if the socket buffer is full
+    if (!flushQueued_ && !channel_.isWriting())
+    {
+        flushQueued_ = true;
+        loop_->queueInLoop(bind(&UdpEndpoint::flush, shared_from_this()));
+    }
+}
+
+void UdpEndpoint::flush()
+{
+    loop_->assertInLoopThread();
+    flushQueued_ = false;
+    if (!started_)
+    {
+        return;
+    }
+
+    while (sentOutgoing_ < outgoing_.size())
+    {
+        const int count = static_cast<int>(std::min(outgoing_.size() - sentOutgoing_,
+                                                    static_cast<size_t>(MAX_SEND_BATCH)));
+        for (int i = 0; i < count; ++i)
+        {
+            Outgoing& outgoing = outgoing_[sentOutgoing_ + i];
+            sendIovecs_[i].iov_base = const_cast<char*>(output_.peek()) + outgoing.offset;
+            sendIovecs_[i].iov_len = outgoing.len;
+            sendMsgs_[i].msg_hdr.msg_name = outgoing.toPeer ? &outgoing.peer : NULL;
+            sendMsgs_[i].msg_hdr.msg_namelen = outgoing.toPeer ? sizeof outgoing.peer : 0;
+            if (outgoing.segmentSize > 0)
+            {
+                GsoControl& control = sendControls_[i];
+                struct cmsghdr* cmsg = &control.header;
+                cmsg->cmsg_level = SOL_UDP;
+                cmsg->cmsg_type = UDP_SEGMENT;
+                cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+                uint16_t segmentSize = static_cast<uint16_t>(outgoing.segmentSize);
+                ::memcpy(CMSG_DATA(cmsg), &segmentSize, sizeof segmentSize);
+                sendMsgs_[i].msg_hdr.msg_control = control.space;
+                sendMsgs_[i].msg_hdr.msg_controllen = sizeof control.space;
+            }
+            else
+            {
+                sendMsgs_[i].msg_hdr.msg_control = NULL;
+                sendMsgs_[i].msg_hdr.msg_controllen = 0;
+            }
+        }
+
+        int sent = SockOps::sendmmsg(socket_.fd(), &sendMsgs_[0], count);
+        if (sent > 0)
+        {
+            ++sendCalls_;
+            for (int i = 0; i < sent; ++i)
+            {
+                sentDatagrams_ += segmentsOf(outgoing_[sentOutgoing_ + i]);
+            }
+            sentOutgoing_ += sent;
+        }
+        else if (errno == EAGAIN || errno == EWOULDBLOCK)
+        {
+            channel_.enableWriting();
+            return;
+        }
+        else if ((errno == EIO || errno == EINVAL)
+                 && outgoing_[sentOutgoing_].segmentSize > 0)
+        {
+            // no checksum offload on the route, or segments above its MTU
+            LOG_SYSERR << "UdpEndpoint::flush[" << name_ << "] UDP_SEGMENT off";
+            gso_ = false;
+            splitOutgoing(sentOutgoing_);
+        }
+        else
+        {
+            // the first message failed, ECONNREFUSED or so, the rest may not
+            LOG_SYSERR << "UdpEndpoint::flush[" << name_ << "]";
+            droppedDatagrams_ += segmentsOf(outgoing_[sentOutgoing_]);
+            ++sentOutgoing_;
+        }
+    }
+
+    outgoing_.clear();
+    sentOutgoing_ = 0;
+    output_.retrieveAll();
+    if (channel_.isWriting())
+    {
+        channel_.disableWriting();
+    }
+}
+
+void UdpEndpoint::splitOutgoing(size_t index)
+{
+    Outgoing message = outgoing_[index];
+    std::vector<Outgoing> datagrams;
+    for (size_t offset = 0; offset < message.len; offset += message.segmentSize)
+    {
+        Outgoing datagram = message;
+        datagram.offset = message.offset + offset;
+        datagram.len = std::min(message.segmentSize, message.len - offset);
+        datagram.segmentSize = 0;
+        datagrams.push_back(datagram);
+    }
+    outgoing_.erase(outgoing_.begin() + index);
+    outgoing_.insert(outgoing_.begin() + index, datagrams.begin(), datagrams.end());
+}
+
+void UdpEndpoint::handleWrite()
+{
+    flush();
+}
+
+void UdpEndpoint::handleRead(Timestamp receiveTime)
+{
+    loop_->assertInLoopThread();
+    DatagramRing* ring = loop_->datagramRing();
+    int budget = maxReadDatagrams_;
+    while (budget > 0)
+    {
+        int count = std::min(budget, static_cast<int>(DatagramRing::MAX_BATCH));
+        struct mmsghdr* msgs = ring->prepare(&count, gro_);
+        int received = SockOps::recvmmsg(socket_.fd(), msgs, count);
+        if (received < 0)
+        {
+            // a connected socket reports ECONNREFUSED of an earlier send
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != ECONNREFUSED)
+            {
+                LOG_SYSERR << "UdpEndpoint::handleRead[" << name_ << "]";
+            }
+            break;
+        }
+
+        ++receiveCalls_;
+        datagrams_.clear();
+        ring->commit(received, &datagrams_);
+        receivedDatagrams_ += datagrams_.size();
+        if (datagramCallback_)
+        {
+            datagramCallback_(datagrams_, receiveTime);
+        }
+        budget -= static_cast<int>(datagrams_.size());
+        if (received < count)
+        {
+            break; // drained
+        }
+    }
+}
+
+} // namespace net
+
+} // namespace tesla
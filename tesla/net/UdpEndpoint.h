@@ -0,0 +1,269 @@
+/*
+ *
+ * Author:
+ *     Thomas Liu
+ * Date:
+ *     10/18/2026
+ * Description:
+ *     UDP socket of an EventLoop, batched with recvmmsg and sendmmsg
+ *
+ *
+ * Licensed under the Apache License, Version 2.0
+ *
+ */
+
+#ifndef TESLA_NET_UDPENDPOINT_H
+#define TESLA_NET_UDPENDPOINT_H
+
+#include <tesla/base/Noncopyable.hpp>
+#include <tesla/base/StringPiece.hpp>
+#include <tesla/base/Timestamp.h>
+#include <tesla/base/Types.hpp>
+
+#include <tesla/net/Buffer.h>
+#include <tesla/net/Channel.h>
+#include <tesla/net/DatagramRing.h>
+#include <tesla/net/InetAddress.h>
+#include <tesla/net/Socket.h>
+
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+#include <functional>
+#include <memory>
+#else // __GXX_EXPERIMENTAL_CXX0X__
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#endif // __GXX_EXPERIMENTAL_CXX0X__
+
+#include <vector>
+
+#include <stdint.h>
+
+namespace tesla
+{
+
+namespace net
+{
+
+class EventLoop;
+
+///
+/// A UDP socket served by one loop, the common part
+/// of UdpServer and UdpClient.
+///
+/// Datagrams are received up to DatagramRing::MAX_BATCH per
+/// recvmmsg(2), into the DatagramRing of the loop, and handed to
+/// the DatagramCallback a batch at a time, as views into the ring.
+/// Datagrams sent in one iteration of the loop are queued and go out
+/// at its end, up to MAX_SEND_BATCH per sendmmsg(2).
+///
+/// With enableGso(), a buffer of equal-sized datagrams given to
+/// sendSegmentsTo() goes to the kernel as one message per
+/// MAX_GSO_SEGMENTS datagrams, which UDP_SEGMENT splits in the kernel
+/// or the NIC. With enableGro(), the kernel hands over datagrams of a
+/// peer coalesced by UDP_GRO, the DatagramRing splits them back.
+/// Either falls back to a message per datagram if the kernel lacks it.
+///
+/// Like TcpConnection it is owned by a shared_ptr, a queued send
+/// keeps it alive.
+///
+class UdpEndpoint
+    : private tesla::base::Noncopyable,
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+      public std::enable_shared_from_this<UdpEndpoint>
+#else // __GXX_EXPERIMENTAL_CXX0X__
+      public boost::enable_shared_from_this<UdpEndpoint>
+#endif // __GXX_EXPERIMENTAL_CXX0X__
+{
+public:
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+    typedef std::function<void (const std::vector<Datagram>&,
+                                tesla::base::Timestamp)> DatagramCallback;
+#else // __GXX_EXPERIMENTAL_CXX0X__
+    typedef boost::function<void (const std::vector<Datagram>&,
+                                  tesla::base::Timestamp)> DatagramCallback;
+#endif // __GXX_EXPERIMENTAL_CXX0X__
+
+    static const int MAX_SEND_BATCH = 256;
+    /// queued beyond this, datagrams are dropped
+    static const size_t MAX_QUEUED_BYTES = 4 * 1024 * 1024;
+    /// datagrams per UDP_SEGMENT message, UDP_MAX_SEGMENTS of older kernels
+    static const size_t MAX_GSO_SEGMENTS = 64;
+    /// bytes per UDP_SEGMENT message, the largest UDP payload of IPv4
+    static const size_t MAX_GSO_BYTES = 65507;
+
+    UdpEndpoint(EventLoop* loop, const tesla::base::string& name);
+    ~UdpEndpoint();
+
+    /// abort if address in use
+    void bindAddress(const InetAddress& localAddr, bool reusePort);
+    /// Sends to and receives from @c peerAddr only.
+    void connect(const InetAddress& peerAddr);
+    void setReceiveBufferSize(int bytes);
+
+    /// Not thread safe, set it before start().
+    /// The views are valid within the callback.
+    void setDatagramCallback(const DatagramCallback& cb)
+    {
+        datagramCallback_ = cb;
+    }
+    /// Datagrams read per readable event, so that one busy socket
+    /// does not starve the rest of the loop. 1024 by default.
+    /// Not thread safe, set it before start().
+    void setMaxReadDatagrams(int datagrams)
+    {
+        maxReadDatagrams_ = datagrams;
+    }
+
+    /// UDP segmentation offload of sendSegmentsTo(), if the kernel has it.
+    /// Not thread safe, call it before start().
+    void enableGso()
+    {
+        gsoRequested_ = true;
+    }
+    /// UDP receive offload, if the kernel has it and the DatagramRing
+    /// of the loop holds coalesced messages, see DatagramRing::canCoalesce().
+    /// Not thread safe, call it before start().
+    void enableGro()
+    {
+        groRequested_ = true;
+    }
+    /// whether the offloads are in effect, known after start()
+    bool gso() const
+    {
+        return gso_;
+    }
+    bool gro() const
+    {
+        return gro_;
+    }
+
+    /// Thread safe.
+    void start();
+    /// Stops receiving and sending, thread safe.
+    void stop();
+
+    /// Thread safe.
+    void sendTo(const InetAddress& peerAddr, const tesla::base::StringPiece& data);
+    /// To the connected peer. Thread safe.
+    void send(const tesla::base::StringPiece& data);
+    /// Datagrams of @c segmentSize bytes each, the last may be shorter.
+    /// Thread safe.
+    void sendSegmentsTo(const InetAddress& peerAddr,
+                        const tesla::base::StringPiece& data,
+                        size_t segmentSize);
+    /// To the connected peer. Thread safe.
+    void sendSegments(const tesla::base::StringPiece& data, size_t segmentSize);
+
+    EventLoop* getLoop() const
+    {
+        return loop_;
+    }
+    const tesla::base::string& name() const
+    {
+        return name_;
+    }
+    int fd() const
+    {
+        return socket_.fd();
+    }
+
+    /// datagrams received, recvmmsg(2) calls that returned some
+    int64_t receivedDatagrams() const
+    {
+        return receivedDatagrams_;
+    }
+    int64_t receiveCalls() const
+    {
+        return receiveCalls_;
+    }
+    /// datagrams sent, counting each of a UDP_SEGMENT message,
+    /// sendmmsg(2) calls that sent some
+    int64_t sentDatagrams() const
+    {
+        return sentDatagrams_;
+    }
+    int64_t sendCalls() const
+    {
+        return sendCalls_;
+    }
+    /// datagrams dropped as the queue was full or sending failed
+    int64_t droppedDatagrams() const
+    {
+        return droppedDatagrams_;
+    }
+
+private:
+    /// a queued datagram, its bytes in output_
+    struct Outgoing
+    {
+        size_t offset;
+        size_t len;
+        struct sockaddr_in peer;
+        bool toPeer; // false on a connected socket
+        size_t segmentSize; // for UDP_SEGMENT, 0 for one datagram
+    };
+    /// cmsg room for the UDP_SEGMENT size of a message
+    union GsoControl
+    {
+        struct cmsghdr header;
+        char space[CMSG_SPACE(sizeof(uint16_t))];
+    };
+
+    static size_t segmentsOf(const Outgoing& outgoing)
+    {
+        return outgoing.segmentSize == 0
+            ? 1 : (outgoing.len + outgoing.segmentSize - 1) / outgoing.segmentSize;
+    }
+
+    void startInLoop();
+    void stopInLoop();
+    void sendInLoop(const InetAddress& peerAddr, bool toPeer,
+                    const tesla::base::StringPiece& data, size_t segmentSize);
+    void sendStringInLoop(const InetAddress& peerAddr, bool toPeer,
+                          const tesla::base::string& data, size_t segmentSize);
+    /// a message of outgoing_ into one per datagram, without GSO
+    void splitOutgoing(size_t index);
+    void handleRead(tesla::base::Timestamp receiveTime);
+    void handleWrite();
+    void flush();
+
+    EventLoop* loop_;
+    const tesla::base::string name_;
+    Socket socket_;
+    Channel channel_;
+    bool started_;
+    DatagramCallback datagramCallback_;
+    int maxReadDatagrams_;
+    bool gsoRequested_;
+    bool groRequested_;
+    bool gso_;
+    bool gro_;
+
+    std::vector<Datagram> datagrams_;       // the batch handed to the callback
+    Buffer output_;                         // bytes of the queued datagrams
+    std::vector<Outgoing> outgoing_;
+    size_t sentOutgoing_;                   // of outgoing_, sent already
+    std::vector<struct mmsghdr> sendMsgs_;  // for sendmmsg(2), reused
+    std::vector<struct iovec> sendIovecs_;
+    std::vector<GsoControl> sendControls_;
+    bool flushQueued_;
+
+    int64_t receivedDatagrams_;
+    int64_t receiveCalls_;
+    int64_t sentDatagrams_;
+    int64_t sendCalls_;
+    int64_t droppedDatagrams_;
+}; // class UdpEndpoint
+
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+typedef std::shared_ptr<UdpEndpoint> UdpEndpointPtr;
+#else // __GXX_EXPERIMENTAL_CXX0X__
+typedef boost::shared_ptr<UdpEndpoint> UdpEndpointPtr;
+#endif // __GXX_EXPERIMENTAL_CXX0X__
+
+} // namespace net
+
+} // namespace tesla
+
+#endif  // TESLA_NET_UDPENDPOINT_H
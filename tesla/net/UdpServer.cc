@@ -0,0 +1,27 @@
+#include <tesla/net/UdpServer.h>
+
+namespace tesla
+{
+
+namespace net
+{
+
+using namespace tesla::base;
+
+UdpServer::UdpServer(EventLoop* loop,
+                     const InetAddress& listenAddr,
+                     const string& name,
+                     bool reusePort)
+    : endpoint_(new UdpEndpoint(loop, name))
+{
+    endpoint_->bindAddress(listenAddr, reusePort);
+}
+
+UdpServer::~UdpServer()
+{
+    endpoint_->stop();
+}
+
+} // namespace net
+
+} // namespace tesla
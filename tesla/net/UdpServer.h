@@ -0,0 +1,101 @@
+/*
+ *
+ * Author:
+ *     Thomas Liu
+ * Date:
+ *     10/18/2026
+ * Description:
+ *     UDP server, a bound UdpEndpoint
+ *
+ *
+ * Licensed under the Apache License, Version 2.0
+ *
+ */
+
+#ifndef TESLA_NET_UDPSERVER_H
+#define TESLA_NET_UDPSERVER_H
+
+#include <tesla/base/Noncopyable.hpp>
+
+#include <tesla/net/UdpEndpoint.h>
+
+namespace tesla
+{
+
+namespace net
+{
+
+///
+/// Receives on @c listenAddr in one loop. With @c reusePort several
+/// servers, one per loop, may bind the same address, the kernel
+/// spreads the datagrams among them by peer.
+///
+class UdpServer
+    : private tesla::base::Noncopyable
+{
+public:
+    UdpServer(EventLoop* loop,
+              const InetAddress& listenAddr,
+              const tesla::base::string& name,
+              bool reusePort = false);
+    ~UdpServer();  // stops the endpoint
+
+    /// Not thread safe, set it before start().
+    /// The views are valid within the callback.
+    void setDatagramCallback(const UdpEndpoint::DatagramCallback& cb)
+    {
+        endpoint_->setDatagramCallback(cb);
+    }
+
+    /// See UdpEndpoint::enableGso() and UdpEndpoint::enableGro().
+    /// Not thread safe, call them before start().
+    void enableGso()
+    {
+        endpoint_->enableGso();
+    }
+    void enableGro()
+    {
+        endpoint_->enableGro();
+    }
+
+    /// Thread safe.
+    void start()
+    {
+        endpoint_->start();
+    }
+
+    /// Thread safe.
+    void sendTo(const InetAddress& peerAddr, const tesla::base::StringPiece& data)
+    {
+        endpoint_->sendTo(peerAddr, data);
+    }
+    /// Datagrams of @c segmentSize bytes each. Thread safe.
+    void sendSegmentsTo(const InetAddress& peerAddr,
+                        const tesla::base::StringPiece& data,
+                        size_t segmentSize)
+    {
+        endpoint_->sendSegmentsTo(peerAddr, data, segmentSize);
+    }
+
+    EventLoop* getLoop() const
+    {
+        return endpoint_->getLoop();
+    }
+    const tesla::base::string& name() const
+    {
+        return endpoint_->name();
+    }
+    const UdpEndpointPtr& endpoint() const
+    {
+        return endpoint_;
+    }
+
+private:
+    UdpEndpointPtr endpoint_;
+}; // class UdpServer
+
+} // namespace net
+
+} // namespace tesla
+
+#endif  // TESLA_NET_UDPSERVER_H
@@ -1,6 +1,9 @@
+#include <tesla/base/Logger.h>
+
 #include <tesla/net/Backend.h>
 #include <tesla/net/backend/PollBackend.h>
 #include <tesla/net/backend/EpollBackend.h>
+#include <tesla/net/backend/IoUringBackend.h>
 
 #include <stdlib.h>
 
@@ -18,9 +21,17 @@ Backend* Backend::newDefaultBackend(EventLoop* loop)
     {
         return new PollBackend(loop);
     }
+    else if (::getenv("TESLA_USE_IOURING") && IoUringBackend::isSupported())
+    {
+        return new IoUringBackend(loop);
+    }
     else
     {
-        return new EpollBackend(loop);
+        if (::getenv("TESLA_USE_IOURING"))
+        {
+            LOG_WARN << "io_uring is not supported, fall back to epoll";
+        }
+        return new EpollBackend(loop, ::getenv("TESLA_EPOLL_CHANGELIST") != NULL);
     }
 }
 
@@ -31,10 +31,11 @@ const int INDEX_NEW = -1;
 const int INDEX_ADDED = 1;
 const int INDEX_DELETED = 2;
 
-EpollBackend::EpollBackend(EventLoop* loop)
+EpollBackend::EpollBackend(EventLoop* loop, bool changeList)
     : Backend(loop),
       epollfd_(::epoll_create1(EPOLL_CLOEXEC)),
-      events_(INIT_EVENTLIST_SIZE)
+      events_(INIT_EVENTLIST_SIZE),
+      changeList_(changeList)
 {
     if (epollfd_ < 0)
     {
@@ -49,6 +50,10 @@ EpollBackend::~EpollBackend()
 
 Timestamp EpollBackend::run(int timeoutMs, ChannelList* activeChannels)
 {
+    if (changeList_)
+    {
+        flushChanges();
+    }
     int numEvents = ::epoll_wait(epollfd_,
                                  &*events_.begin(),
                                  static_cast<int>(events_.size()),
@@ -118,7 +123,14 @@ void EpollBackend::updateChannel(Channel* channel)
             assert(channels_[fd] == channel);
         }
         channel->setIndex(INDEX_ADDED);
-        update(EPOLL_CTL_ADD, channel);
+        if (changeList_)
+        {
+            changes_.push_back(fd);
+        }
+        else
+        {
+            update(EPOLL_CTL_ADD, channel);
+        }
     }
     else
     {
@@ -130,14 +142,34 @@ void EpollBackend::updateChannel(Channel* channel)
         assert(index == INDEX_ADDED);
         if (channel->isNoneEvent())
         {
-            update(EPOLL_CTL_DEL, channel);
+            if (changeList_)
+            {
+                changes_.push_back(fd);
+            }
+            else
+            {
+                update(EPOLL_CTL_DEL, channel);
+            }
             channel->setIndex(INDEX_DELETED);
         }
         else
         {
-            update(EPOLL_CTL_MOD, channel);
+            if (changeList_)
+            {
+                changes_.push_back(fd);
+            }
+            else
+            {
+                update(EPOLL_CTL_MOD, channel);
+            }
         }
     }
+
+    if (changeList_)
+    {
+        // one epoll_ctl saved, unless flushChanges() issues it later
+        ++savedSyscalls_;
+    }
 }
 
 void EpollBackend::removeChannel(Channel* channel)
@@ -154,13 +186,64 @@ void EpollBackend::removeChannel(Channel* channel)
     (void)n;
     assert(n == 1);
 
-    if (index == INDEX_ADDED)
+    if (changeList_)
+    {
+        // can't be deferred, the fd may be closed right after
+        if (index == INDEX_ADDED)
+        {
+            ++savedSyscalls_;
+        }
+        EventsMap::iterator it = registered_.find(fd);
+        if (it != registered_.end())
+        {
+            registered_.erase(it);
+            update(EPOLL_CTL_DEL, channel);
+        }
+    }
+    else if (index == INDEX_ADDED)
     {
         update(EPOLL_CTL_DEL, channel);
     }
     channel->setIndex(INDEX_NEW);
 }
 
+void EpollBackend::flushChanges()
+{
+    for (std::vector<int>::const_iterator it = changes_.begin();
+            it != changes_.end(); ++it)
+    {
+        int fd = *it;
+        ChannelMap::const_iterator ch = channels_.find(fd);
+        if (ch == channels_.end())
+        {
+            // removed before flushing
+            continue;
+        }
+        Channel* channel = ch->second;
+        int events = channel->events();
+        EventsMap::iterator reg = registered_.find(fd);
+        if (reg == registered_.end())
+        {
+            if (events != 0)
+            {
+                registered_[fd] = events;
+                update(EPOLL_CTL_ADD, channel);
+            }
+        }
+        else if (events == 0)
+        {
+            registered_.erase(reg);
+            update(EPOLL_CTL_DEL, channel);
+        }
+        else if (reg->second != events)
+        {
+            reg->second = events;
+            update(EPOLL_CTL_MOD, channel);
+        }
+    }
+    changes_.clear();
+}
+
 void EpollBackend::update(int operation, Channel* channel)
 {
     struct epoll_event event;
@@ -168,6 +251,10 @@ void EpollBackend::update(int operation, Channel* channel)
     event.events = channel->events();
     event.data.ptr = channel;
     int fd = channel->fd();
+    if (changeList_)
+    {
+        --savedSyscalls_;
+    }
     if (::epoll_ctl(epollfd_, operation, fd, &event) < 0)
     {
         if (operation == EPOLL_CTL_DEL)
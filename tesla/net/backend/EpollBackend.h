@@ -31,11 +31,14 @@ namespace net
 ///
 /// IO Multiplexing with epoll(4).
 ///
+/// In change-list mode, interest changes are only recorded and the net
+/// result per fd is flushed right before epoll_wait(2), changes that
+/// cancel each other out never reach the kernel.
 class EpollBackend
     : public Backend
 {
 public:
-    EpollBackend(EventLoop* loop);
+    EpollBackend(EventLoop* loop, bool changeList = false);
     virtual ~EpollBackend();
 
     virtual tesla::base::Timestamp run(int timeoutMs, ChannelList* activeChannels);
@@ -48,13 +51,20 @@ private:
     void fillActiveChannels(int numEvents,
                             ChannelList* activeChannels) const;
     void update(int operation, Channel* channel);
+    void flushChanges();
 
     typedef std::vector<struct epoll_event> EventList;
     typedef std::map<int, Channel*> ChannelMap;
+    typedef std::map<int, int> EventsMap;
 
     int epollfd_;
     EventList events_;
     ChannelMap channels_;
+
+    /// for change-list mode
+    const bool changeList_;
+    std::vector<int> changes_;  // fds changed since last flush, may repeat
+    EventsMap registered_;      // events the kernel knows, keyed by fd
 }; // class EpollBackend
 
 } // namespace net
@@ -0,0 +1,378 @@
+#include <tesla/base/Logger.h>
+#include <tesla/base/Types.hpp>
+
+#include <tesla/net/backend/IoUringBackend.h>
+#include <tesla/net/Channel.h>
+
+#include <algorithm>
+
+#include <assert.h>
+#include <errno.h>
+#include <poll.h>
+#include <strings.h>  // bzero
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace tesla
+{
+
+namespace net
+{
+
+using namespace tesla::base;
+
+const int INDEX_NEW = -1;
+const int INDEX_ADDED = 1;
+
+/// user_data of requests whose completions we don't care about,
+/// i.e. poll removals.
+const uint64_t IGNORED_USER_DATA = 0;
+
+int ioUringSetup(unsigned entries, struct io_uring_params* params)
+{
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+int ioUringEnter(int ringfd, unsigned toSubmit, unsigned minComplete,
+                 unsigned flags, const void* arg, size_t argsz)
+{
+    return static_cast<int>(::syscall(__NR_io_uring_enter, ringfd, toSubmit,
+                                      minComplete, flags, arg, argsz));
+}
+
+void* mapRing(int ringfd, size_t size, off_t offset)
+{
+    void* ring = ::mmap(NULL, size, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, ringfd, offset);
+    if (ring == MAP_FAILED)
+    {
+        LOG_SYSFATAL << "IoUringBackend mmap offset=" << offset;
+    }
+    return ring;
+}
+
+template<typename T>
+T* ringField(void* ring, unsigned offset)
+{
+    return static_cast<T*>(implicit_cast<void*>(static_cast<char*>(ring) + offset));
+}
+
+uint64_t makeUserData(int fd, uint32_t tag)
+{
+    return (static_cast<uint64_t>(tag) << 32) | static_cast<uint32_t>(fd);
+}
+
+IoUringBackend::IoUringBackend(EventLoop* loop)
+    : Backend(loop),
+      ringfd_(-1),
+      sqRing_(NULL),
+      sqRingSize_(0),
+      sqHead_(NULL),
+      sqTail_(NULL),
+      sqArray_(NULL),
+      sqMask_(0),
+      sqEntries_(0),
+      sqes_(NULL),
+      sqeTail_(0),
+      cqRing_(NULL),
+      cqRingSize_(0),
+      cqHead_(NULL),
+      cqTail_(NULL),
+      cqMask_(0),
+      cqes_(NULL),
+      nextTag_(1)
+{
+    struct io_uring_params params;
+    bzero(&params, sizeof params);
+    // completions of a whole batch of polls must fit in the ring
+    params.flags = IORING_SETUP_CQSIZE;
+    params.cq_entries = RING_ENTRIES * 4;
+    ringfd_ = ioUringSetup(RING_ENTRIES, &params);
+    if (ringfd_ < 0)
+    {
+        LOG_SYSFATAL << "IoUringBackend::IoUringBackend";
+    }
+    if (!(params.features & IORING_FEAT_EXT_ARG))
+    {
+        LOG_FATAL << "IoUringBackend needs IORING_FEAT_EXT_ARG (Linux 5.11)";
+    }
+
+    sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        sqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+        cqRingSize_ = 0;
+        sqRing_ = mapRing(ringfd_, sqRingSize_, IORING_OFF_SQ_RING);
+        cqRing_ = sqRing_;
+    }
+    else
+    {
+        sqRing_ = mapRing(ringfd_, sqRingSize_, IORING_OFF_SQ_RING);
+        cqRing_ = mapRing(ringfd_, cqRingSize_, IORING_OFF_CQ_RING);
+    }
+    sqes_ = static_cast<struct io_uring_sqe*>(
+                mapRing(ringfd_, params.sq_entries * sizeof(struct io_uring_sqe),
+                        IORING_OFF_SQES));
+
+    sqHead_ = ringField<unsigned>(sqRing_, params.sq_off.head);
+    sqTail_ = ringField<unsigned>(sqRing_, params.sq_off.tail);
+    sqArray_ = ringField<unsigned>(sqRing_, params.sq_off.array);
+    sqMask_ = *ringField<unsigned>(sqRing_, params.sq_off.ring_mask);
+    sqEntries_ = params.sq_entries;
+    sqeTail_ = *sqTail_;
+
+    cqHead_ = ringField<unsigned>(cqRing_, params.cq_off.head);
+    cqTail_ = ringField<unsigned>(cqRing_, params.cq_off.tail);
+    cqMask_ = *ringField<unsigned>(cqRing_, params.cq_off.ring_mask);
+    cqes_ = ringField<struct io_uring_cqe>(cqRing_, params.cq_off.cqes);
+}
+
+IoUringBackend::~IoUringBackend()
+{
+    ::munmap(sqes_, sqEntries_ * sizeof(struct io_uring_sqe));
+    if (cqRing_ != sqRing_)
+    {
+        ::munmap(cqRing_, cqRingSize_);
+    }
+    ::munmap(sqRing_, sqRingSize_);
+    ::close(ringfd_);
+}
+
+bool IoUringBackend::isSupported()
+{
+    struct io_uring_params params;
+    bzero(&params, sizeof params);
+    int ringfd = ioUringSetup(2, &params);
+    if (ringfd < 0)
+    {
+        return false;
+    }
+    ::close(ringfd);
+    return (params.features & IORING_FEAT_EXT_ARG) != 0;
+}
+
+Timestamp IoUringBackend::run(int timeoutMs, ChannelList* activeChannels)
+{
+    flushChanges();
+    // submits pending polls and waits for completions in one syscall
+    int ret = enter(1, IORING_ENTER_GETEVENTS, timeoutMs);
+    int savedErrno = errno;
+    Timestamp now(Timestamp::now());
+    size_t numBefore = activeChannels->size();
+    fillActiveChannels(activeChannels);
+    size_t numEvents = activeChannels->size() - numBefore;
+    if (numEvents > 0)
+    {
+        LOG_TRACE << numEvents << " events happended";
+    }
+    else if (ret >= 0 || savedErrno == ETIME)
+    {
+        LOG_TRACE << " nothing happended";
+    }
+    else
+    {
+        // error happens, log uncommon ones
+        if (savedErrno != EINTR)
+        {
+            errno = savedErrno;
+            LOG_SYSERR << "IoUringBackend::run()";
+        }
+    }
+    return now;
+}
+
+void IoUringBackend::fillActiveChannels(ChannelList* activeChannels)
+{
+    unsigned head = *cqHead_;
+    unsigned tail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+    for (; head != tail; ++head)
+    {
+        const struct io_uring_cqe& cqe = cqes_[head & cqMask_];
+        if (cqe.user_data == IGNORED_USER_DATA)
+        {
+            continue;
+        }
+        int fd = static_cast<int>(cqe.user_data & 0xffffffff);
+        uint32_t tag = static_cast<uint32_t>(cqe.user_data >> 32);
+        ChannelMap::iterator it = channels_.find(fd);
+        if (it == channels_.end() || !it->second.armed || it->second.tag != tag)
+        {
+            // completion of a poll we have removed or replaced
+            continue;
+        }
+        Registration& reg = it->second;
+        reg.armed = false;
+        if (cqe.res != -ECANCELED)
+        {
+            int revents = cqe.res >= 0 ? cqe.res
+                          : (cqe.res == -EBADF ? POLLNVAL : POLLERR);
+            reg.channel->setRevents(revents);
+            activeChannels->push_back(reg.channel);
+        }
+        // polls are one-shot, re-arm with the next submission
+        markDirty(fd, &reg);
+    }
+    __atomic_store_n(cqHead_, tail, __ATOMIC_RELEASE);
+}
+
+void IoUringBackend::updateChannel(Channel* channel)
+{
+    Backend::assertInLoopThread();
+    LOG_TRACE << "fd = " << channel->fd() << " events = " << channel->events();
+    int fd = channel->fd();
+    if (channel->index() == INDEX_NEW)
+    {
+        assert(channels_.find(fd) == channels_.end());
+        Registration reg = { channel, 0, 0, false, false };
+        channels_[fd] = reg;
+        channel->setIndex(INDEX_ADDED);
+    }
+    else
+    {
+        assert(channel->index() == INDEX_ADDED);
+        assert(channels_.find(fd) != channels_.end());
+        assert(channels_[fd].channel == channel);
+    }
+    // no syscall here, the net change is submitted in run()
+    markDirty(fd, &channels_[fd]);
+}
+
+void IoUringBackend::removeChannel(Channel* channel)
+{
+    Backend::assertInLoopThread();
+    int fd = channel->fd();
+    LOG_TRACE << "fd = " << fd;
+    ChannelMap::iterator it = channels_.find(fd);
+    assert(it != channels_.end());
+    assert(it->second.channel == channel);
+    assert(channel->isNoneEvent());
+    assert(channel->index() == INDEX_ADDED);
+    if (it->second.armed)
+    {
+        disarmPoll(&it->second);
+    }
+    channels_.erase(it);
+    channel->setIndex(INDEX_NEW);
+}
+
+void IoUringBackend::markDirty(int fd, Registration* reg)
+{
+    if (!reg->dirty)
+    {
+        reg->dirty = true;
+        changes_.push_back(fd);
+    }
+}
+
+void IoUringBackend::flushChanges()
+{
+    for (std::vector<int>::const_iterator it = changes_.begin();
+            it != changes_.end(); ++it)
+    {
+        ChannelMap::iterator ch = channels_.find(*it);
+        if (ch == channels_.end() || !ch->second.dirty)
+        {
+            // removed, or re-added and flushed already
+            continue;
+        }
+        Registration& reg = ch->second;
+        reg.dirty = false;
+        int events = reg.channel->events();
+        if (reg.armed && reg.armedEvents == events)
+        {
+            // changes cancelled each other out
+            continue;
+        }
+        if (reg.armed)
+        {
+            disarmPoll(&reg);
+        }
+        if (events != 0)
+        {
+            armPoll(*it, &reg, events);
+        }
+    }
+    changes_.clear();
+}
+
+void IoUringBackend::armPoll(int fd, Registration* reg, int events)
+{
+    struct io_uring_sqe* sqe = getSqe();
+    if (++nextTag_ == 0)
+    {
+        ++nextTag_;
+    }
+    reg->tag = nextTag_;
+    reg->armedEvents = events;
+    reg->armed = true;
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fd;
+    sqe->poll32_events = events;
+    sqe->user_data = makeUserData(fd, reg->tag);
+}
+
+void IoUringBackend::disarmPoll(Registration* reg)
+{
+    assert(reg->armed);
+    struct io_uring_sqe* sqe = getSqe();
+    sqe->opcode = IORING_OP_POLL_REMOVE;
+    sqe->fd = -1;
+    sqe->addr = makeUserData(reg->channel->fd(), reg->tag);
+    sqe->user_data = IGNORED_USER_DATA;
+    reg->armed = false;
+}
+
+struct io_uring_sqe* IoUringBackend::getSqe()
+{
+    if (sqeTail_ - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE) >= sqEntries_)
+    {
+        // ring is full, hand the batch to the kernel without waiting
+        if (enter(0, 0, 0) < 0)
+        {
+            LOG_SYSERR << "IoUringBackend::getSqe()";
+        }
+        if (sqeTail_ - __atomic_load_n(sqHead_, __ATOMIC_ACQUIRE) >= sqEntries_)
+        {
+            LOG_FATAL << "IoUringBackend submission queue overflow";
+        }
+    }
+    unsigned index = sqeTail_ & sqMask_;
+    struct io_uring_sqe* sqe = &sqes_[index];
+    bzero(sqe, sizeof *sqe);
+    sqArray_[index] = index;
+    ++sqeTail_;
+    return sqe;
+}
+
+int IoUringBackend::enter(unsigned minComplete, unsigned flags, int timeoutMs)
+{
+    unsigned toSubmit = sqeTail_ - *sqTail_;
+    if (toSubmit > 0)
+    {
+        __atomic_store_n(sqTail_, sqeTail_, __ATOMIC_RELEASE);
+    }
+
+    struct __kernel_timespec ts;
+    struct io_uring_getevents_arg arg;
+    bzero(&arg, sizeof arg);
+    if (flags & IORING_ENTER_GETEVENTS)
+    {
+        flags |= IORING_ENTER_EXT_ARG;
+        if (timeoutMs >= 0)
+        {
+            ts.tv_sec = timeoutMs / 1000;
+            ts.tv_nsec = (timeoutMs % 1000) * 1000 * 1000;
+            arg.ts = reinterpret_cast<uintptr_t>(&ts);
+        }
+    }
+    return ioUringEnter(ringfd_, toSubmit, minComplete, flags,
+                        (flags & IORING_ENTER_EXT_ARG) ? &arg : NULL,
+                        sizeof arg);
+}
+
+} // namespace net
+
+} // namespace tesla
@@ -0,0 +1,105 @@
+/*
+ *
+ * Author:
+ *     Thomas Liu
+ * Date:
+ *     10/18/2026
+ * Description:
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0
+ *
+ */
+
+#ifndef TESLA_NET_BACKEND_IOURINGBACKEND_H
+#define TESLA_NET_BACKEND_IOURINGBACKEND_H
+
+#include <tesla/net/Backend.h>
+
+#include <map>
+#include <vector>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace tesla
+{
+
+namespace net
+{
+
+///
+/// IO Multiplexing with io_uring(7).
+///
+/// Every interest change is recorded and turned into poll requests when
+/// run() is called, so all of them reach the kernel with the wait itself,
+/// in one io_uring_enter(2).
+class IoUringBackend
+    : public Backend
+{
+public:
+    IoUringBackend(EventLoop* loop);
+    virtual ~IoUringBackend();
+
+    virtual tesla::base::Timestamp run(int timeoutMs, ChannelList* activeChannels);
+    virtual void updateChannel(Channel* channel);
+    virtual void removeChannel(Channel* channel);
+
+    /// Whether the running kernel can host this backend.
+    static bool isSupported();
+
+private:
+    static const unsigned RING_ENTRIES = 256;
+
+    /// what we know about one registered fd
+    struct Registration
+    {
+        Channel* channel;
+        int armedEvents; // events of the in-flight poll, if armed
+        uint32_t tag;    // tells the in-flight poll from stale ones
+        bool armed;
+        bool dirty;      // in changes_, waiting for flushChanges()
+    };
+
+    typedef std::map<int, Registration> ChannelMap;
+
+    void flushChanges();
+    void fillActiveChannels(ChannelList* activeChannels);
+    void markDirty(int fd, Registration* reg);
+    void armPoll(int fd, Registration* reg, int events);
+    void disarmPoll(Registration* reg);
+    struct io_uring_sqe* getSqe();
+    int enter(unsigned minComplete, unsigned flags, int timeoutMs);
+
+    int ringfd_;
+
+    /// submission queue ring
+    void* sqRing_;
+    size_t sqRingSize_;
+    unsigned* sqHead_;
+    unsigned* sqTail_;
+    unsigned* sqArray_;
+    unsigned sqMask_;
+    unsigned sqEntries_;
+    struct io_uring_sqe* sqes_;
+    unsigned sqeTail_;    // local tail, published in enter()
+
+    /// completion queue ring
+    void* cqRing_;
+    size_t cqRingSize_;
+    unsigned* cqHead_;
+    unsigned* cqTail_;
+    unsigned cqMask_;
+    struct io_uring_cqe* cqes_;
+
+    uint32_t nextTag_;
+    ChannelMap channels_;
+    std::vector<int> changes_;
+}; // class IoUringBackend
+
+} // namespace net
+
+} // namespace tesla
+
+#endif  // TESLA_NET_BACKEND_IOURINGBACKEND_H
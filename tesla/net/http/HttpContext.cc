@@ -1 +1,379 @@
-make it not empty
\ No newline at end of file
+#include <tesla/net/Buffer.h>
+#include <tesla/net/http/HttpContext.h>
+
+#include <algorithm>
+
+#include <strings.h>
+
+namespace tesla
+{
+
+namespace net
+{
+
+using namespace tesla::base;
+
+const size_t HttpContext::MAX_HEADER_BYTES;
+const size_t HttpContext::MAX_BODY_BYTES;
+
+int hexValue(char c)
+{
+    if (c >= '0' && c <= '9')
+    {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f')
+    {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F')
+    {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+HttpContext::HttpContext()
+    : state_(ExpectRequestLine),
+      parsed_(0),
+      scanned_(0),
+      contentLength_(-1),
+      transferEncoded_(false),
+      chunked_(false),
+      chunkRemaining_(0),
+      trailerBytes_(0)
+{
+    path_.offset = path_.length = 0;
+    query_.offset = query_.length = 0;
+    body_.offset = body_.length = 0;
+}
+
+HttpContext::ParseResult HttpContext::parse(Buffer* buf, Timestamp receiveTime)
+{
+    if (state_ == GotAll)
+    {
+        return GotRequest;
+    }
+
+    for (;;)
+    {
+        const char* base = buf->peek();
+        size_t unparsed = buf->readableBytes() - parsed_;
+        if (state_ == ExpectBody)
+        {
+            if (unparsed < body_.length)
+            {
+                return NeedMore;
+            }
+            body_.offset = parsed_;
+            parsed_ += body_.length;
+            state_ = GotAll;
+        }
+        else if (state_ == ExpectChunkData)
+        {
+            if (unparsed < chunkRemaining_ + 2)
+            {
+                return NeedMore;
+            }
+            const char* data = base + parsed_;
+            if (data[chunkRemaining_] != '\r' || data[chunkRemaining_ + 1] != '\n')
+            {
+                return BadRequest;
+            }
+            chunkedBody_.append(data, chunkRemaining_);
+            parsed_ += chunkRemaining_ + 2;
+            scanned_ = parsed_;
+            state_ = ExpectChunkSize;
+        }
+        else
+        {
+            const char* lineEnd = NULL;
+            const char* line = nextLine(buf, &lineEnd);
+            if (line == NULL)
+            {
+                // the line so far, and the head or the trailer before it
+                size_t pending = state_ == ExpectChunkSize ? unparsed
+                                 : state_ == ExpectChunkTrailer ? trailerBytes_ + unparsed
+                                 : buf->readableBytes();
+                return pending > MAX_HEADER_BYTES ? BadRequest : NeedMore;
+            }
+
+            bool ok = true;
+            if (state_ == ExpectRequestLine)
+            {
+                // empty lines before a request are ignored
+                if (line != lineEnd)
+                {
+                    ok = parseRequestLine(line, lineEnd, base);
+                    state_ = ExpectHeaders;
+                }
+            }
+            else if (state_ == ExpectHeaders)
+            {
+                ok = parsed_ <= MAX_HEADER_BYTES
+                     && (line == lineEnd ? endHeaders() : parseHeader(line, lineEnd, base));
+            }
+            else if (state_ == ExpectChunkSize)
+            {
+                ok = parseChunkSize(line, lineEnd);
+            }
+            else
+            {
+                assert(state_ == ExpectChunkTrailer);
+                // trailer fields are not kept, but count as much as a head
+                trailerBytes_ += lineEnd - line + 2;
+                ok = trailerBytes_ <= MAX_HEADER_BYTES;
+                if (line == lineEnd)
+                {
+                    state_ = GotAll;
+                }
+            }
+            if (!ok)
+            {
+                return BadRequest;
+            }
+        }
+
+        if (state_ == GotAll)
+        {
+            makeRequest(base, receiveTime);
+            return GotRequest;
+        }
+    }
+}
+
+void HttpContext::retrieveRequest(Buffer* buf)
+{
+    assert(state_ == GotAll);
+    buf->retrieve(parsed_);
+    state_ = ExpectRequestLine;
+    parsed_ = 0;
+    scanned_ = 0;
+    path_.offset = path_.length = 0;
+    query_.offset = query_.length = 0;
+    body_.offset = body_.length = 0;
+    headers_.clear();
+    contentLength_ = -1;
+    transferEncoded_ = false;
+    chunked_ = false;
+    chunkRemaining_ = 0;
+    trailerBytes_ = 0;
+    chunkedBody_.clear();
+    request_.reset();
+}
+
+const char* HttpContext::nextLine(Buffer* buf, const char** lineEnd)
+{
+    const char* crlf = buf->resumeFindCRLF(&scanned_);
+    if (crlf == NULL)
+    {
+        return NULL;
+    }
+    const char* line = buf->peek() + parsed_;
+    *lineEnd = crlf;
+    parsed_ = crlf + 2 - buf->peek();
+    scanned_ = parsed_;
+    return line;
+}
+
+bool HttpContext::parseRequestLine(const char* begin, const char* end, const char* base)
+{
+    const char* space = std::find(begin, end, ' ');
+    if (space == end
+            || !request_.setMethod(StringPiece(begin, static_cast<int>(space - begin))))
+    {
+        return false;
+    }
+
+    const char* target = space + 1;
+    space = std::find(target, end, ' ');
+    if (space == end || space == target)
+    {
+        return false;
+    }
+    const char* question = std::find(target, space, '?');
+    path_ = spanOf(target, question, base);
+    if (question != space)
+    {
+        query_ = spanOf(question + 1, space, base);
+    }
+
+    StringPiece version(space + 1, static_cast<int>(end - space - 1));
+    if (version == "HTTP/1.1")
+    {
+        request_.setVersion(HttpRequest::Http11);
+    }
+    else if (version == "HTTP/1.0")
+    {
+        request_.setVersion(HttpRequest::Http10);
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+bool HttpContext::parseHeader(const char* begin, const char* end, const char* base)
+{
+    const char* colon = std::find(begin, end, ':');
+    // no obsolete line folding, and no space before the colon
+    if (colon == end || colon == begin
+            || *begin == ' ' || *begin == '\t'
+            || colon[-1] == ' ' || colon[-1] == '\t')
+    {
+        return false;
+    }
+    const char* value = colon + 1;
+    const char* valueEnd = end;
+    while (value < valueEnd && (*value == ' ' || *value == '\t'))
+    {
+        ++value;
+    }
+    while (valueEnd > value && (valueEnd[-1] == ' ' || valueEnd[-1] == '\t'))
+    {
+        --valueEnd;
+    }
+    headers_.push_back(HeaderSpan(spanOf(begin, colon, base),
+                                  spanOf(value, valueEnd, base)));
+
+    size_t fieldLength = colon - begin;
+    if (fieldLength == 17 && ::strncasecmp(begin, "Transfer-Encoding", 17) == 0)
+    {
+        // chunked must be the final coding, and only once, RFC 7230 3.3.1,
+        // codings of later fields come after those of earlier ones
+        if (chunked_)
+        {
+            return false;
+        }
+        const char* last = value;
+        for (const char* p = value; p < valueEnd; ++p)
+        {
+            if (*p == ',')
+            {
+                last = p + 1;
+            }
+        }
+        if (HttpRequest::hasToken(StringPiece(value, static_cast<int>(last - value)), "chunked"))
+        {
+            return false;
+        }
+        chunked_ = HttpRequest::hasToken(StringPiece(last, static_cast<int>(valueEnd - last)), "chunked");
+        transferEncoded_ = true;
+    }
+    else if (fieldLength == 14 && ::strncasecmp(begin, "Content-Length", 14) == 0)
+    {
+        int64_t length = 0;
+        if (value == valueEnd)
+        {
+            return false;
+        }
+        for (const char* p = value; p < valueEnd; ++p)
+        {
+            if (*p < '0' || *p > '9' || length > static_cast<int64_t>(MAX_BODY_BYTES))
+            {
+                return false;
+            }
+            length = length * 10 + (*p - '0');
+        }
+        // repeated ones must agree
+        if (contentLength_ >= 0 && contentLength_ != length)
+        {
+            return false;
+        }
+        contentLength_ = length;
+    }
+    return true;
+}
+
+bool HttpContext::endHeaders()
+{
+    if (transferEncoded_)
+    {
+        // both, or a body whose length is unknown, are a request
+        // smuggling attempt, RFC 7230 3.3.3
+        if (contentLength_ >= 0 || !chunked_)
+        {
+            return false;
+        }
+        state_ = ExpectChunkSize;
+    }
+    else if (contentLength_ > 0)
+    {
+        if (contentLength_ > static_cast<int64_t>(MAX_BODY_BYTES))
+        {
+            return false;
+        }
+        body_.length = static_cast<size_t>(contentLength_);
+        state_ = ExpectBody;
+    }
+    else
+    {
+        state_ = GotAll;
+    }
+    return true;
+}
+
+bool HttpContext::parseChunkSize(const char* begin, const char* end)
+{
+    size_t size = 0;
+    const char* p = begin;
+    for (; p < end && hexValue(*p) >= 0; ++p)
+    {
+        if (size > MAX_BODY_BYTES)
+        {
+            return false;
+        }
+        size = size * 16 + hexValue(*p);
+    }
+    // chunk extensions after ';' are ignored
+    if (p == begin || (p < end && *p != ';' && *p != ' ' && *p != '\t'))
+    {
+        return false;
+    }
+    if (chunkedBody_.size() + size > MAX_BODY_BYTES)
+    {
+        return false;
+    }
+
+    if (size == 0)
+    {
+        state_ = ExpectChunkTrailer;
+    }
+    else
+    {
+        chunkRemaining_ = size;
+        state_ = ExpectChunkData;
+    }
+    return true;
+}
+
+void HttpContext::makeRequest(const char* base, Timestamp receiveTime)
+{
+    request_.setPath(viewOf(path_, base));
+    request_.setQuery(viewOf(query_, base));
+    for (size_t i = 0; i < headers_.size(); ++i)
+    {
+        request_.addHeader(viewOf(headers_[i].first, base),
+                           viewOf(headers_[i].second, base));
+    }
+    request_.setBody(chunked_ ? StringPiece(chunkedBody_) : viewOf(body_, base));
+    request_.setReceiveTime(receiveTime);
+}
+
+HttpContext::Span HttpContext::spanOf(const char* begin, const char* end, const char* base)
+{
+    Span span;
+    span.offset = begin - base;
+    span.length = end - begin;
+    return span;
+}
+
+StringPiece HttpContext::viewOf(const Span& span, const char* base)
+{
+    return StringPiece(base + span.offset, static_cast<int>(span.length));
+}
+
+} // namespace net
+
+} // namespace tesla
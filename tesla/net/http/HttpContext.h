@@ -1 +1,130 @@
-make it not empty
\ No newline at end of file
+/*
+ *
+ * Author:
+ *     Thomas Liu
+ * Date:
+ *     10/18/2026
+ * Description:
+ *     Incremental HTTP/1.1 request parser over a Buffer
+ *
+ *
+ * Licensed under the Apache License, Version 2.0
+ *
+ */
+
+#ifndef TESLA_NET_HTTP_HTTPCONTEXT_H
+#define TESLA_NET_HTTP_HTTPCONTEXT_H
+
+#include <tesla/base/Copyable.hpp>
+#include <tesla/base/Types.hpp>
+
+#include <tesla/net/http/HttpRequest.h>
+
+#include <vector>
+
+#include <stdint.h>
+
+namespace tesla
+{
+
+namespace net
+{
+
+class Buffer;
+
+///
+/// Parses requests from the front of the input buffer of a connection.
+///
+/// parse() goes on where the last call stopped, so a request that
+/// arrives in pieces is scanned once. Until the request is complete,
+/// only offsets from peek() are kept, which stay valid when the buffer
+/// moves its storage, then the request is made of views into it.
+/// Pipelined requests are taken one at a time, each one is dropped
+/// from the buffer by retrieveRequest().
+///
+class HttpContext
+    : public tesla::base::Copyable
+{
+public:
+    enum ParseResult
+    {
+        NeedMore,
+        GotRequest,
+        BadRequest,
+    };
+
+    /// request line and headers, the longest accepted
+    static const size_t MAX_HEADER_BYTES = 64 * 1024;
+    /// Content-Length or decoded chunks, the longest accepted
+    static const size_t MAX_BODY_BYTES = 16 * 1024 * 1024;
+
+    HttpContext();
+
+    ParseResult parse(Buffer* buf, tesla::base::Timestamp receiveTime);
+
+    /// after GotRequest, valid until retrieveRequest()
+    const HttpRequest& request() const
+    {
+        return request_;
+    }
+
+    /// Drops the request from @c buf, for the next one.
+    void retrieveRequest(Buffer* buf);
+
+private:
+    enum State
+    {
+        ExpectRequestLine,
+        ExpectHeaders,
+        ExpectBody,
+        ExpectChunkSize,
+        ExpectChunkData,
+        ExpectChunkTrailer,
+        GotAll,
+    };
+
+    /// bytes from peek()
+    struct Span
+    {
+        size_t offset;
+        size_t length;
+    };
+    typedef std::pair<Span, Span> HeaderSpan;
+
+    /// the next line from @c parsed_, without CRLF, NULL if incomplete
+    const char* nextLine(Buffer* buf, const char** lineEnd);
+    bool parseRequestLine(const char* begin, const char* end, const char* base);
+    bool parseHeader(const char* begin, const char* end, const char* base);
+    bool endHeaders();
+    bool parseChunkSize(const char* begin, const char* end);
+    /// turns the spans into views from @c base
+    void makeRequest(const char* base, tesla::base::Timestamp receiveTime);
+
+    static Span spanOf(const char* begin, const char* end, const char* base);
+    static tesla::base::StringPiece viewOf(const Span& span, const char* base);
+
+    State state_;
+    /// bytes of the request consumed so far
+    size_t parsed_;
+    /// bytes searched for the end of the current line
+    size_t scanned_;
+
+    Span path_;
+    Span query_;
+    std::vector<HeaderSpan> headers_;
+    Span body_;
+    int64_t contentLength_; // -1 if none
+    bool transferEncoded_;  // a Transfer-Encoding was there
+    bool chunked_;          // and its final coding is chunked
+    size_t chunkRemaining_;
+    size_t trailerBytes_;
+    tesla::base::string chunkedBody_;
+
+    HttpRequest request_;
+}; // class HttpContext
+
+} // namespace net
+
+} // namespace tesla
+
+#endif  // TESLA_NET_HTTP_HTTPCONTEXT_H
@@ -1 +1,121 @@
-make it not empty
\ No newline at end of file
+#include <tesla/net/http/HttpRequest.h>
+
+#include <strings.h>
+
+namespace tesla
+{
+
+namespace net
+{
+
+using namespace tesla::base;
+
+bool equalsIgnoreCase(const StringPiece& lhs, const StringPiece& rhs)
+{
+    return lhs.size() == rhs.size()
+           && ::strncasecmp(lhs.data(), rhs.data(), lhs.size()) == 0;
+}
+
+StringPiece trimSpaces(const char* begin, const char* end)
+{
+    while (begin < end && (*begin == ' ' || *begin == '\t'))
+    {
+        ++begin;
+    }
+    while (end > begin && (end[-1] == ' ' || end[-1] == '\t'))
+    {
+        --end;
+    }
+    return StringPiece(begin, static_cast<int>(end - begin));
+}
+
+HttpRequest::HttpRequest()
+    : method_(Invalid),
+      version_(Unknown)
+{
+}
+
+const char* HttpRequest::methodString() const
+{
+    static const char* const names[] =
+    {
+        "UNKNOWN", "GET", "POST", "HEAD", "PUT", "DELETE", "OPTIONS", "PATCH",
+    };
+    return names[method_];
+}
+
+bool HttpRequest::setMethod(const StringPiece& method)
+{
+    static const char* const names[] =
+    {
+        "GET", "POST", "HEAD", "PUT", "DELETE", "OPTIONS", "PATCH",
+    };
+    static const Method methods[] =
+    {
+        Get, Post, Head, Put, Delete, Options, Patch,
+    };
+    // methods are case-sensitive
+    for (size_t i = 0; i < sizeof methods / sizeof methods[0]; ++i)
+    {
+        if (method == names[i])
+        {
+            method_ = methods[i];
+            return true;
+        }
+    }
+    method_ = Invalid;
+    return false;
+}
+
+StringPiece HttpRequest::getHeader(const StringPiece& field) const
+{
+    for (size_t i = 0; i < headers_.size(); ++i)
+    {
+        if (equalsIgnoreCase(headers_[i].first, field))
+        {
+            return headers_[i].second;
+        }
+    }
+    return StringPiece();
+}
+
+bool HttpRequest::keepAlive() const
+{
+    StringPiece connection = getHeader("Connection");
+    if (version_ == Http11)
+    {
+        return !hasToken(connection, "close");
+    }
+    return version_ == Http10 && hasToken(connection, "keep-alive");
+}
+
+void HttpRequest::reset()
+{
+    method_ = Invalid;
+    version_ = Unknown;
+    path_.clear();
+    query_.clear();
+    headers_.clear();
+    body_.clear();
+}
+
+bool HttpRequest::hasToken(const StringPiece& list, const StringPiece& token)
+{
+    const char* begin = list.data();
+    const char* end = list.data() + list.size();
+    while (begin < end)
+    {
+        const char* comma = static_cast<const char*>(::memchr(begin, ',', end - begin));
+        const char* tokenEnd = comma == NULL ? end : comma;
+        if (equalsIgnoreCase(trimSpaces(begin, tokenEnd), token))
+        {
+            return true;
+        }
+        begin = tokenEnd + 1;
+    }
+    return false;
+}
+
+} // namespace net
+
+} // namespace tesla
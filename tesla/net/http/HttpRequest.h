@@ -1 +1,145 @@
-make it not empty
\ No newline at end of file
+/*
+ *
+ * Author:
+ *     Thomas Liu
+ * Date:
+ *     10/18/2026
+ * Description:
+ *     HTTP request, views into the input buffer
+ *
+ *
+ * Licensed under the Apache License, Version 2.0
+ *
+ */
+
+#ifndef TESLA_NET_HTTP_HTTPREQUEST_H
+#define TESLA_NET_HTTP_HTTPREQUEST_H
+
+#include <tesla/base/Copyable.hpp>
+#include <tesla/base/StringPiece.hpp>
+#include <tesla/base/Timestamp.h>
+
+#include <utility>
+#include <vector>
+
+namespace tesla
+{
+
+namespace net
+{
+
+///
+/// A parsed HTTP request.
+///
+/// Nothing is copied out of the input buffer, the path, the headers
+/// and the body are views into it, valid while the request is passed
+/// to the HttpCallback. Copy what is needed later.
+/// A chunked body is decoded into storage of the HttpContext.
+///
+class HttpRequest
+    : public tesla::base::Copyable
+{
+public:
+    enum Method
+    {
+        Invalid, Get, Post, Head, Put, Delete, Options, Patch,
+    };
+    enum Version
+    {
+        Unknown, Http10, Http11,
+    };
+
+    typedef std::pair<tesla::base::StringPiece, tesla::base::StringPiece> Header;
+    typedef std::vector<Header> HeaderList;
+
+    HttpRequest();
+
+    Method method() const
+    {
+        return method_;
+    }
+    const char* methodString() const;
+    Version version() const
+    {
+        return version_;
+    }
+    /// the target up to '?'
+    const tesla::base::StringPiece& path() const
+    {
+        return path_;
+    }
+    /// after '?', empty if none
+    const tesla::base::StringPiece& query() const
+    {
+        return query_;
+    }
+    /// in arrival order, the fields as sent
+    const HeaderList& headers() const
+    {
+        return headers_;
+    }
+    /// the value of the first @c field, compared ignoring case,
+    /// empty if missing
+    tesla::base::StringPiece getHeader(const tesla::base::StringPiece& field) const;
+    const tesla::base::StringPiece& body() const
+    {
+        return body_;
+    }
+    tesla::base::Timestamp receiveTime() const
+    {
+        return receiveTime_;
+    }
+
+    /// whether the connection stays open after the response,
+    /// by the version and the Connection header
+    bool keepAlive() const;
+
+    /// for HttpContext
+    bool setMethod(const tesla::base::StringPiece& method);
+    void setVersion(Version version)
+    {
+        version_ = version;
+    }
+    void setPath(const tesla::base::StringPiece& path)
+    {
+        path_ = path;
+    }
+    void setQuery(const tesla::base::StringPiece& query)
+    {
+        query_ = query;
+    }
+    void addHeader(const tesla::base::StringPiece& field,
+                   const tesla::base::StringPiece& value)
+    {
+        headers_.push_back(Header(field, value));
+    }
+    void setBody(const tesla::base::StringPiece& body)
+    {
+        body_ = body;
+    }
+    void setReceiveTime(tesla::base::Timestamp time)
+    {
+        receiveTime_ = time;
+    }
+    /// keeps the capacity of the header list
+    void reset();
+
+    /// whether the comma separated @c list has @c token, ignoring case
+    static bool hasToken(const tesla::base::StringPiece& list,
+                         const tesla::base::StringPiece& token);
+
+private:
+    Method method_;
+    Version version_;
+    tesla::base::StringPiece path_;
+    tesla::base::StringPiece query_;
+    HeaderList headers_;
+    tesla::base::StringPiece body_;
+    tesla::base::Timestamp receiveTime_;
+}; // class HttpRequest
+
+} // namespace net
+
+} // namespace tesla
+
+#endif  // TESLA_NET_HTTP_HTTPREQUEST_H
@@ -1 +1,169 @@
-make it not empty
\ No newline at end of file
+#include <tesla/net/Buffer.h>
+#include <tesla/net/http/HttpResponse.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+namespace tesla
+{
+
+namespace net
+{
+
+using namespace tesla::base;
+
+__thread char t_dateHeader[48];
+__thread int t_dateHeaderLength;
+__thread time_t t_dateSecond;
+
+/// "HTTP/1.1 200 OK\r\n" of the known codes, NULL for others
+const char* statusLineOf(HttpResponse::StatusCode code)
+{
+    switch (code)
+    {
+    case HttpResponse::Ok200:
+        return "HTTP/1.1 200 OK\r\n";
+    case HttpResponse::NoContent204:
+        return "HTTP/1.1 204 No Content\r\n";
+    case HttpResponse::PartialContent206:
+        return "HTTP/1.1 206 Partial Content\r\n";
+    case HttpResponse::MovedPermanently301:
+        return "HTTP/1.1 301 Moved Permanently\r\n";
+    case HttpResponse::NotModified304:
+        return "HTTP/1.1 304 Not Modified\r\n";
+    case HttpResponse::BadRequest400:
+        return "HTTP/1.1 400 Bad Request\r\n";
+    case HttpResponse::Forbidden403:
+        return "HTTP/1.1 403 Forbidden\r\n";
+    case HttpResponse::NotFound404:
+        return "HTTP/1.1 404 Not Found\r\n";
+    case HttpResponse::InternalServerError500:
+        return "HTTP/1.1 500 Internal Server Error\r\n";
+    default:
+        return NULL;
+    }
+}
+
+/// "Content-Length: <n>\r\n" at the end of @c buf
+StringPiece formatContentLength(char* buf, size_t size, size_t length)
+{
+    char* end = buf + size;
+    char* p = end;
+    *--p = '\n';
+    *--p = '\r';
+    do
+    {
+        *--p = static_cast<char>('0' + length % 10);
+        length /= 10;
+    }
+    while (length != 0);
+    static const char prefix[] = "Content-Length: ";
+    p -= sizeof prefix - 1;
+    ::memcpy(p, prefix, sizeof prefix - 1);
+    return StringPiece(p, static_cast<int>(end - p));
+}
+
+void HttpResponse::addHeader(const StringPiece& key, const StringPiece& value)
+{
+    headers_.append(key.data(), key.size());
+    headers_.append(": ", 2);
+    headers_.append(value.data(), value.size());
+    headers_.append("\r\n", 2);
+}
+
+void HttpResponse::appendToBuffer(Buffer* output, bool withBody) const
+{
+    const char* statusLine = statusMessage_.empty() ? statusLineOf(statusCode_) : NULL;
+    if (statusLine != NULL)
+    {
+        output->append(statusLine, ::strlen(statusLine));
+    }
+    else
+    {
+        char buf[32];
+        snprintf(buf, sizeof buf, "HTTP/1.1 %d ", statusCode_);
+        output->append(buf);
+        output->append(statusMessage_.empty() ? reasonPhrase(statusCode_) : statusMessage_.c_str());
+        output->append("\r\n", 2);
+    }
+
+    for (int i = 0; i < numHeaderBlocks_; ++i)
+    {
+        output->append(headerBlocks_[i]);
+    }
+    if (closeConnection_)
+    {
+        output->append("Connection: close\r\n");
+    }
+    // 204 and 304 have no body to measure, RFC 7230 3.3.2
+    if (statusCode_ != NoContent204 && statusCode_ != NotModified304)
+    {
+        char buf[48];
+        output->append(formatContentLength(buf, sizeof buf,
+                                           bodyFile_.fd() >= 0 ? bodyFile_.size() : body_.size()));
+    }
+    output->append(headers_);
+
+    output->append("\r\n", 2);
+    if (withBody)
+    {
+        output->append(body_);
+    }
+}
+
+const char* HttpResponse::reasonPhrase(StatusCode code)
+{
+    switch (code)
+    {
+    case Ok200:
+        return "OK";
+    case NoContent204:
+        return "No Content";
+    case PartialContent206:
+        return "Partial Content";
+    case MovedPermanently301:
+        return "Moved Permanently";
+    case NotModified304:
+        return "Not Modified";
+    case BadRequest400:
+        return "Bad Request";
+    case Forbidden403:
+        return "Forbidden";
+    case NotFound404:
+        return "Not Found";
+    case InternalServerError500:
+        return "Internal Server Error";
+    default:
+        return "Unknown";
+    }
+}
+
+StringPiece HttpResponse::dateHeader(Timestamp now)
+{
+    time_t seconds = static_cast<time_t>(now.microSecondsSinceEpoch()
+                                         / Timestamp::MICROSECONDS_PER_SECOND);
+    if (seconds != t_dateSecond || t_dateHeaderLength == 0)
+    {
+        static const char days[][4] = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+        static const char months[][4] =
+        {
+            "Jan", "Feb", "Mar", "Apr", "May", "Jun",
+            "Jul", "Aug", "Sep", "Oct", "Nov", "Dec",
+        };
+        t_dateSecond = seconds;
+        struct tm tm_time;
+        ::gmtime_r(&seconds, &tm_time);
+        // not strftime(), whose names follow the locale
+        t_dateHeaderLength = snprintf(t_dateHeader, sizeof t_dateHeader,
+                                      "Date: %s, %02d %s %4d %02d:%02d:%02d GMT\r\n",
+                                      days[tm_time.tm_wday], tm_time.tm_mday,
+                                      months[tm_time.tm_mon], tm_time.tm_year + 1900,
+                                      tm_time.tm_hour, tm_time.tm_min, tm_time.tm_sec);
+    }
+    return StringPiece(t_dateHeader, t_dateHeaderLength);
+}
+
+} // namespace net
+
+} // namespace tesla
@@ -1 +1,153 @@
-make it not empty
\ No newline at end of file
+/*
+ *
+ * Author:
+ *     Thomas Liu
+ * Date:
+ *     10/18/2026
+ * Description:
+ *     HTTP response, serialized into a Buffer
+ *
+ *
+ * Licensed under the Apache License, Version 2.0
+ *
+ */
+
+#ifndef TESLA_NET_HTTP_HTTPRESPONSE_H
+#define TESLA_NET_HTTP_HTTPRESPONSE_H
+
+#include <tesla/base/Copyable.hpp>
+#include <tesla/base/StringPiece.hpp>
+#include <tesla/base/Timestamp.h>
+#include <tesla/base/Types.hpp>
+
+#include <tesla/net/FileRegion.h>
+
+#include <assert.h>
+
+namespace tesla
+{
+
+namespace net
+{
+
+class Buffer;
+
+///
+/// A response, serialized straight into the output of the server.
+///
+/// Status lines of the known codes and the headers are kept
+/// serialized, header blocks shared by all responses, as the Date
+/// line of dateHeader() and the common headers of the server, are
+/// appended as they are. A file body is not read in, the server
+/// sends it with sendfile(2) after the headers.
+///
+class HttpResponse
+    : public tesla::base::Copyable
+{
+public:
+    enum StatusCode
+    {
+        Unknown,
+        Ok200 = 200,
+        NoContent204 = 204,
+        PartialContent206 = 206,
+        MovedPermanently301 = 301,
+        NotModified304 = 304,
+        BadRequest400 = 400,
+        Forbidden403 = 403,
+        NotFound404 = 404,
+        InternalServerError500 = 500,
+    };
+
+    static const int MAX_HEADER_BLOCKS = 4;
+
+    explicit HttpResponse(bool close)
+        : statusCode_(Unknown),
+          closeConnection_(close),
+          numHeaderBlocks_(0)
+    {
+    }
+
+    void setStatusCode(StatusCode code)
+    {
+        statusCode_ = code;
+    }
+    StatusCode statusCode() const
+    {
+        return statusCode_;
+    }
+    /// the reason phrase, the standard one if not set
+    void setStatusMessage(const tesla::base::string& message)
+    {
+        statusMessage_ = message;
+    }
+
+    void setCloseConnection(bool on)
+    {
+        closeConnection_ = on;
+    }
+    bool closeConnection() const
+    {
+        return closeConnection_;
+    }
+
+    void setContentType(const tesla::base::StringPiece& contentType)
+    {
+        addHeader("Content-Type", contentType);
+    }
+    /// appended as given, a repeated key is sent twice
+    void addHeader(const tesla::base::StringPiece& key,
+                   const tesla::base::StringPiece& value);
+    /// Serialized header lines, each ending with CRLF,
+    /// which must outlive appendToBuffer().
+    void addHeaderBlock(const tesla::base::StringPiece& block)
+    {
+        assert(numHeaderBlocks_ < MAX_HEADER_BLOCKS);
+        headerBlocks_[numHeaderBlocks_++] = block;
+    }
+
+    void setBody(const tesla::base::string& body)
+    {
+        body_ = body;
+    }
+    const tesla::base::string& body() const
+    {
+        return body_;
+    }
+    /// the body is the file region instead, see TcpConnection::sendFile()
+    void setBodyFile(const FileRegion& file)
+    {
+        bodyFile_ = file;
+    }
+    const FileRegion& bodyFile() const
+    {
+        return bodyFile_;
+    }
+
+    /// The status line, the headers with Content-Length,
+    /// and the body unless @c withBody is false, as for HEAD.
+    /// A file body is left to the caller.
+    void appendToBuffer(Buffer* output, bool withBody = true) const;
+
+    static const char* reasonPhrase(StatusCode code);
+
+    /// "Date: <IMF-fixdate>\r\n" of @c now, formatted once a second
+    /// per thread, the view is valid until the next call in the thread.
+    static tesla::base::StringPiece dateHeader(tesla::base::Timestamp now);
+
+private:
+    StatusCode statusCode_;
+    tesla::base::string statusMessage_;
+    bool closeConnection_;
+    tesla::base::string headers_;
+    tesla::base::StringPiece headerBlocks_[MAX_HEADER_BLOCKS];
+    int numHeaderBlocks_;
+    tesla::base::string body_;
+    FileRegion bodyFile_;
+}; // class HttpResponse
+
+} // namespace net
+
+} // namespace tesla
+
+#endif  // TESLA_NET_HTTP_HTTPRESPONSE_H
@@ -1 +1,141 @@
-make it not empty
\ No newline at end of file
+#include <tesla/base/Logger.h>
+
+#include <tesla/net/http/HttpServer.h>
+#include <tesla/net/http/HttpContext.h>
+#include <tesla/net/http/HttpRequest.h>
+#include <tesla/net/http/HttpResponse.h>
+
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+#include <functional>
+#else // __GXX_EXPERIMENTAL_CXX0X__
+#include <boost/bind.hpp>
+#endif // __GXX_EXPERIMENTAL_CXX0X__
+
+namespace tesla
+{
+
+namespace net
+{
+
+using namespace tesla::base;
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+using std::bind;
+using namespace std::placeholders;
+#else // __GXX_EXPERIMENTAL_CXX0X__
+using boost::bind;
+#endif // __GXX_EXPERIMENTAL_CXX0X__
+
+void defaultHttpCallback(const HttpRequest&, HttpResponse* resp)
+{
+    resp->setStatusCode(HttpResponse::NotFound404);
+    resp->setCloseConnection(true);
+}
+
+HttpServer::HttpServer(EventLoop* loop,
+                       const InetAddress& listenAddr,
+                       const string& name,
+                       TcpServer::Option option)
+    : server_(loop, listenAddr, name, option),
+      httpCallback_(defaultHttpCallback)
+{
+    server_.setConnectionCallback(
+        bind(&HttpServer::onConnection, this, _1));
+    server_.setMessageCallback(
+        bind(&HttpServer::onMessage, this, _1, _2, _3));
+}
+
+void HttpServer::addCommonHeader(const string& key, const string& value)
+{
+    commonHeaders_ += key;
+    commonHeaders_ += ": ";
+    commonHeaders_ += value;
+    commonHeaders_ += "\r\n";
+}
+
+void HttpServer::start()
+{
+    LOG_INFO << "HttpServer[" << server_.name()
+             << "] starts listening on " << server_.hostport();
+    server_.start();
+}
+
+void HttpServer::onConnection(const TcpConnectionPtr& conn)
+{
+    if (conn->connected())
+    {
+        conn->setContext(HttpContext());
+    }
+}
+
+void HttpServer::onMessage(const TcpConnectionPtr& conn,
+                           Buffer* buf,
+                           Timestamp receiveTime)
+{
+    if (!conn->connected())
+    {
+        // closing after a response, the rest is not answered
+        buf->retrieveAll();
+        return;
+    }
+
+    HttpContext* context = boost::any_cast<HttpContext>(conn->getMutableContext());
+    Buffer output;
+    bool close = false;
+    while (!close)
+    {
+        HttpContext::ParseResult result = context->parse(buf, receiveTime);
+        if (result == HttpContext::NeedMore)
+        {
+            break;
+        }
+        if (result == HttpContext::BadRequest)
+        {
+            output.append("HTTP/1.1 400 Bad Request\r\nConnection: close\r\n"
+                          "Content-Length: 0\r\n\r\n");
+            close = true;
+            break;
+        }
+        close = onRequest(conn, context->request(), &output);
+        context->retrieveRequest(buf);
+    }
+
+    if (output.readableBytes() > 0)
+    {
+        conn->send(&output);
+    }
+    if (close)
+    {
+        conn->shutdown();
+    }
+}
+
+bool HttpServer::onRequest(const TcpConnectionPtr& conn,
+                           const HttpRequest& req,
+                           Buffer* output)
+{
+    bool keepAlive = req.keepAlive();
+    HttpResponse response(!keepAlive);
+    response.addHeaderBlock(HttpResponse::dateHeader(req.receiveTime()));
+    if (!commonHeaders_.empty())
+    {
+        response.addHeaderBlock(commonHeaders_);
+    }
+    if (keepAlive && req.version() == HttpRequest::Http10)
+    {
+        response.addHeader("Connection", "Keep-Alive");
+    }
+    httpCallback_(req, &response);
+
+    bool withBody = req.method() != HttpRequest::Head;
+    response.appendToBuffer(output, withBody);
+    if (withBody && response.bodyFile().fd() >= 0)
+    {
+        // the file never passes through a Buffer
+        conn->sendFile(response.bodyFile(), output);
+    }
+    return response.closeConnection();
+}
+
+} // namespace net
+
+} // namespace tesla
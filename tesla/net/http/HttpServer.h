@@ -1 +1,108 @@
-make it not empty
\ No newline at end of file
+/*
+ *
+ * Author:
+ *     Thomas Liu
+ * Date:
+ *     10/18/2026
+ * Description:
+ *     HTTP/1.1 server on top of TcpServer
+ *
+ *
+ * Licensed under the Apache License, Version 2.0
+ *
+ */
+
+#ifndef TESLA_NET_HTTP_HTTPSERVER_H
+#define TESLA_NET_HTTP_HTTPSERVER_H
+
+#include <tesla/base/Noncopyable.hpp>
+
+#include <tesla/net/TcpServer.h>
+
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+#include <functional>
+#else // __GXX_EXPERIMENTAL_CXX0X__
+#include <boost/function.hpp>
+#endif // __GXX_EXPERIMENTAL_CXX0X__
+
+namespace tesla
+{
+
+namespace net
+{
+
+class HttpRequest;
+class HttpResponse;
+
+///
+/// A simple embeddable HTTP/1.1 server, for status pages and APIs,
+/// not a full web server.
+///
+/// Connections are kept alive as the requests ask, pipelined requests
+/// are answered in order, the responses to the requests of one read
+/// go out in one send. Request bodies may be chunked.
+/// File bodies are sent with sendfile(2).
+///
+class HttpServer
+    : private tesla::base::Noncopyable
+{
+public:
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+    typedef std::function<void (const HttpRequest&, HttpResponse*)> HttpCallback;
+#else // __GXX_EXPERIMENTAL_CXX0X__
+    typedef boost::function<void (const HttpRequest&, HttpResponse*)> HttpCallback;
+#endif // __GXX_EXPERIMENTAL_CXX0X__
+
+    HttpServer(EventLoop* loop,
+               const InetAddress& listenAddr,
+               const tesla::base::string& name,
+               TcpServer::Option option = TcpServer::NoReusePort);
+
+    EventLoop* getLoop() const
+    {
+        return server_.getLoop();
+    }
+
+    /// Not thread safe, callback is registered before calling start().
+    /// The request is only valid within the callback.
+    void setHttpCallback(const HttpCallback& cb)
+    {
+        httpCallback_ = cb;
+    }
+
+    /// A header sent with every response, such as Server,
+    /// serialized once. Date is always sent.
+    /// Not thread safe, call it before start().
+    void addCommonHeader(const tesla::base::string& key, const tesla::base::string& value);
+
+    /// see TcpServer::setThreadNum()
+    void setThreadNum(int numThreads)
+    {
+        server_.setThreadNum(numThreads);
+    }
+
+    void start();
+
+private:
+    void onConnection(const TcpConnectionPtr& conn);
+    void onMessage(const TcpConnectionPtr& conn,
+                   Buffer* buf,
+                   tesla::base::Timestamp receiveTime);
+    /// Appends the response to @c output, sends @c output and then
+    /// the file if the body is one.
+    /// @return whether the connection is to be closed
+    bool onRequest(const TcpConnectionPtr& conn,
+                   const HttpRequest& request,
+                   Buffer* output);
+
+    TcpServer server_;
+    HttpCallback httpCallback_;
+    /// header lines of addCommonHeader()
+    tesla::base::string commonHeaders_;
+}; // class HttpServer
+
+} // namespace net
+
+} // namespace tesla
+
+#endif  // TESLA_NET_HTTP_HTTPSERVER_H
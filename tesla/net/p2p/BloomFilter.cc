@@ -0,0 +1,66 @@
+#include <tesla/net/p2p/BloomFilter.h>
+
+#include <algorithm>
+
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+
+namespace tesla
+{
+
+namespace net
+{
+
+BloomFilter::BloomFilter(size_t capacity, double falsePositiveRate)
+    : capacity_(std::max(capacity, static_cast<size_t>(1))),
+      probes_(1),
+      added_(0)
+{
+    assert(falsePositiveRate > 0 && falsePositiveRate < 1);
+    // m = -n ln(p) / ln(2)^2 bits, k = m / n ln(2) probes
+    const double ln2 = log(2.0);
+    double bits = -static_cast<double>(capacity_) * log(falsePositiveRate) / (ln2 * ln2);
+    words_.resize(static_cast<size_t>(ceil(bits / 64)));
+    probes_ = static_cast<int>(bits / static_cast<double>(capacity_) * ln2 + 0.5);
+    probes_ = std::min(std::max(probes_, 1), 16);
+}
+
+bool BloomFilter::mayContain(uint64_t hash) const
+{
+    const uint64_t bits = words_.size() * 64;
+    const uint64_t delta = (hash >> 32 | hash << 32) | 1;
+    for (int i = 0; i < probes_; ++i)
+    {
+        uint64_t bit = hash % bits;
+        if ((words_[bit / 64] & (static_cast<uint64_t>(1) << (bit % 64))) == 0)
+        {
+            return false;
+        }
+        hash += delta;
+    }
+    return true;
+}
+
+void BloomFilter::add(uint64_t hash)
+{
+    const uint64_t bits = words_.size() * 64;
+    const uint64_t delta = (hash >> 32 | hash << 32) | 1;
+    for (int i = 0; i < probes_; ++i)
+    {
+        uint64_t bit = hash % bits;
+        words_[bit / 64] |= static_cast<uint64_t>(1) << (bit % 64);
+        hash += delta;
+    }
+    ++added_;
+}
+
+void BloomFilter::clear()
+{
+    ::memset(&words_[0], 0, words_.size() * sizeof words_[0]);
+    added_ = 0;
+}
+
+} // namespace net
+
+} // namespace tesla
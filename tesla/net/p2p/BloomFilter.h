@@ -0,0 +1,79 @@
+/*
+ *
+ * Author:
+ *     Thomas Liu
+ * Date:
+ *     10/18/2026
+ * Description:
+ *     Bloom filter over 64-bit hashes
+ *
+ *
+ * Licensed under the Apache License, Version 2.0
+ *
+ */
+
+#ifndef TESLA_NET_P2P_BLOOMFILTER_H
+#define TESLA_NET_P2P_BLOOMFILTER_H
+
+#include <tesla/base/Noncopyable.hpp>
+
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace tesla
+{
+
+namespace net
+{
+
+///
+/// Set of keys that may answer yes for a key never added,
+/// never no for one added.
+///
+/// Keys come as well mixed 64-bit hashes, the probes are derived
+/// from them by double hashing, so nothing is hashed twice.
+///
+class BloomFilter
+    : private tesla::base::Noncopyable
+{
+public:
+    /// Sized for @c capacity keys at @c falsePositiveRate,
+    /// the rate grows beyond that.
+    BloomFilter(size_t capacity, double falsePositiveRate);
+
+    bool mayContain(uint64_t hash) const;
+    void add(uint64_t hash);
+    void clear();
+
+    size_t capacity() const
+    {
+        return capacity_;
+    }
+    /// keys added since clear()
+    size_t added() const
+    {
+        return added_;
+    }
+    size_t bits() const
+    {
+        return words_.size() * 64;
+    }
+    int probes() const
+    {
+        return probes_;
+    }
+
+private:
+    const size_t capacity_;
+    std::vector<uint64_t> words_;
+    int probes_;
+    size_t added_;
+}; // class BloomFilter
+
+} // namespace net
+
+} // namespace tesla
+
+#endif  // TESLA_NET_P2P_BLOOMFILTER_H
@@ -1 +1,363 @@
-make it not empty
\ No newline at end of file
+#include <tesla/base/Logger.h>
+#include <tesla/base/ProcessInfo.h>
+
+#include <tesla/net/Endian.hpp>
+#include <tesla/net/EventLoop.h>
+#include <tesla/net/p2p/P2pServer.h>
+
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+#include <functional>
+#else // __GXX_EXPERIMENTAL_CXX0X__
+#include <boost/bind.hpp>
+#endif // __GXX_EXPERIMENTAL_CXX0X__
+
+#include <algorithm>
+
+#include <string.h>
+
+namespace tesla
+{
+
+namespace net
+{
+
+using namespace tesla::base;
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+using std::bind;
+using namespace std::placeholders;
+#else // __GXX_EXPERIMENTAL_CXX0X__
+using boost::bind;
+#endif // __GXX_EXPERIMENTAL_CXX0X__
+
+const int P2pServer::DEFAULT_MAX_PEERS;
+const size_t P2pServer::SEEN_CAPACITY;
+const int32_t P2pServer::MAX_FRAME_SIZE;
+const size_t P2pServer::MAX_PEER_OUTPUT;
+
+/// the finalizer of splitmix64, spreads every input bit
+uint64_t p2pMix64(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+int64_t p2pNewNodeId(const InetAddress& listenAddr)
+{
+    uint64_t seed = p2pMix64(static_cast<uint64_t>(Timestamp::now().microSecondsSinceEpoch()));
+    seed = p2pMix64(seed ^ static_cast<uint64_t>(ProcessInfo::pid()));
+    seed = p2pMix64(seed ^ listenAddr.portNetEndian());
+    int64_t nodeId = static_cast<int64_t>(seed >> 1); // positive
+    return nodeId == 0 ? 1 : nodeId;
+}
+
+int64_t p2pReadInt64(const char* p)
+{
+    uint64_t be64;
+    ::memcpy(&be64, p, sizeof be64);
+    return static_cast<int64_t>(networkToHost64(be64));
+}
+
+P2pServer::P2pServer(EventLoop* loop,
+                     const InetAddress& listenAddr,
+                     const string& name,
+                     int maxPeers)
+    : loop_(loop),
+      nodeId_(p2pNewNodeId(listenAddr)),
+      maxPeers_(maxPeers),
+      sequence_(0),
+      seenFilter0_(SEEN_CAPACITY, 1e-4),
+      seenFilter1_(SEEN_CAPACITY, 1e-4),
+      seen_(&seenFilter0_),
+      seenOlder_(&seenFilter1_),
+      delivered_(0),
+      duplicates_(0),
+      sentFrames_(0),
+      droppedFrames_(0),
+      server_(loop, listenAddr, name)
+{
+    server_.setConnectionCallback(
+        bind(&P2pServer::onConnection, this, _1, false));
+    server_.setMessageCallback(
+        bind(&P2pServer::onMessage, this, _1, _2, _3));
+}
+
+P2pServer::~P2pServer()
+{
+}
+
+void P2pServer::start()
+{
+    LOG_INFO << "P2pServer[" << server_.name() << "] node " << nodeId_
+             << " starts listening on " << server_.hostport();
+    server_.start();
+}
+
+void P2pServer::connectTo(const InetAddress& peerAddr)
+{
+    loop_->runInLoop(bind(&P2pServer::connectInLoop, this, peerAddr));
+}
+
+void P2pServer::connectInLoop(const InetAddress& peerAddr)
+{
+    loop_->assertInLoopThread();
+    string key = peerAddr.toIpPort();
+    if (clients_.find(key) != clients_.end())
+    {
+        return;
+    }
+    TcpClientPtr client(new TcpClient(loop_, peerAddr, server_.name() + "-" + key));
+    client->setConnectionCallback(
+        bind(&P2pServer::onConnection, this, _1, true));
+    client->setMessageCallback(
+        bind(&P2pServer::onMessage, this, _1, _2, _3));
+    client->enableRetry();
+    clients_[key] = client;
+    client->connect();
+}
+
+void P2pServer::broadcast(const StringPiece& payload)
+{
+    if (loop_->isInLoopThread())
+    {
+        broadcastInLoop(payload);
+    }
+    else
+    {
+        loop_->runInLoop(bind(&P2pServer::broadcastString, this, payload.as_string()));
+    }
+}
+
+void P2pServer::broadcastString(const string& payload)
+{
+    broadcastInLoop(payload);
+}
+
+void P2pServer::broadcastInLoop(const StringPiece& payload)
+{
+    loop_->assertInLoopThread();
+    int64_t sequence = ++sequence_;
+    testAndMarkSeen(p2pMix64(static_cast<uint64_t>(nodeId_)) ^ static_cast<uint64_t>(sequence));
+
+    Buffer buf;
+    buf.appendInt8(Gossip);
+    buf.appendInt64(nodeId_);
+    buf.appendInt64(sequence);
+    buf.append(payload);
+    buf.prependInt32(static_cast<int32_t>(buf.readableBytes()));
+    sendToPeers(Slice(&buf), 0);
+}
+
+void P2pServer::onConnection(const TcpConnectionPtr& conn, bool outbound)
+{
+    loop_->assertInLoopThread();
+    if (conn->connected())
+    {
+        PeerContext context = { 0, outbound };
+        conn->setContext(context);
+        conn->setTcpNoDelay(true);
+
+        Buffer hello;
+        hello.appendInt32(9);
+        hello.appendInt8(Hello);
+        hello.appendInt64(nodeId_);
+        conn->send(&hello);
+    }
+    else
+    {
+        const PeerContext* context = boost::any_cast<PeerContext>(&conn->getContext());
+        if (context != NULL && context->nodeId != 0)
+        {
+            PeerMap::iterator it = peers_.find(context->nodeId);
+            if (it != peers_.end() && it->second == conn)
+            {
+                peers_.erase(it);
+                LOG_INFO << "P2pServer[" << server_.name() << "] peer "
+                         << context->nodeId << " down";
+                if (peerCallback_)
+                {
+                    peerCallback_(context->nodeId, false);
+                }
+            }
+        }
+    }
+}
+
+void P2pServer::onMessage(const TcpConnectionPtr& conn,
+                          Buffer* buf,
+                          Timestamp receiveTime)
+{
+    PeerContext* context = boost::any_cast<PeerContext>(conn->getMutableContext());
+    while (buf->readableBytes() >= sizeof(int32_t))
+    {
+        const int32_t len = buf->peekInt32();
+        if (len < 9 || len > MAX_FRAME_SIZE)
+        {
+            LOG_ERROR << "P2pServer[" << server_.name() << "] bad frame length "
+                      << len << " from " << conn->name();
+            buf->retrieveAll();
+            dropConnection(conn, context->outbound);
+            return;
+        }
+        const size_t frameSize = sizeof(int32_t) + len;
+        if (buf->readableBytes() < frameSize)
+        {
+            break;
+        }
+
+        const char* frame = buf->peek();
+        const int8_t type = static_cast<int8_t>(frame[sizeof(int32_t)]);
+        const int64_t nodeId = p2pReadInt64(frame + sizeof(int32_t) + 1);
+        if (type == Hello && context->nodeId == 0)
+        {
+            onHello(conn, context, nodeId);
+        }
+        else if (type == Gossip && context->nodeId != 0 && len >= 17)
+        {
+            onGossip(conn, StringPiece(frame, static_cast<int>(frameSize)),
+                     nodeId, receiveTime);
+        }
+        else
+        {
+            LOG_ERROR << "P2pServer[" << server_.name() << "] unexpected frame "
+                      << static_cast<int>(type) << " from " << conn->name();
+            buf->retrieveAll();
+            dropConnection(conn, context->outbound);
+            return;
+        }
+        buf->retrieve(frameSize);
+    }
+}
+
+void P2pServer::onHello(const TcpConnectionPtr& conn, PeerContext* context, int64_t nodeId)
+{
+    if (nodeId == nodeId_)
+    {
+        dropConnection(conn, context->outbound);
+        return;
+    }
+
+    PeerMap::iterator it = peers_.find(nodeId);
+    if (it != peers_.end())
+    {
+        // both ends keep the connection dialed by the smaller id
+        bool preferred = context->outbound ? nodeId_ < nodeId : nodeId < nodeId_;
+        if (!preferred)
+        {
+            dropConnection(conn, context->outbound);
+            return;
+        }
+        TcpConnectionPtr old = it->second;
+        it->second = conn;
+        context->nodeId = nodeId;
+        dropConnection(old, boost::any_cast<PeerContext>(old->getContext()).outbound);
+        return;
+    }
+
+    if (static_cast<int>(peers_.size()) >= maxPeers_)
+    {
+        LOG_WARN << "P2pServer[" << server_.name() << "] peer table full, drops "
+                 << conn->name();
+        dropConnection(conn, context->outbound);
+        return;
+    }
+    context->nodeId = nodeId;
+    peers_[nodeId] = conn;
+    LOG_INFO << "P2pServer[" << server_.name() << "] peer " << nodeId
+             << " up at " << conn->peerAddress().toIpPort();
+    if (peerCallback_)
+    {
+        peerCallback_(nodeId, true);
+    }
+}
+
+void P2pServer::onGossip(const TcpConnectionPtr& conn,
+                         const StringPiece& frame,
+                         int64_t origin,
+                         Timestamp receiveTime)
+{
+    const char* body = frame.data() + sizeof(int32_t) + 1 + sizeof(int64_t);
+    const int64_t sequence = p2pReadInt64(body);
+    if (testAndMarkSeen(p2pMix64(static_cast<uint64_t>(origin)) ^ static_cast<uint64_t>(sequence)))
+    {
+        ++duplicates_;
+        return;
+    }
+    ++delivered_;
+
+    // relayed as received, one copy shared by all peers
+    const PeerContext& context = boost::any_cast<const PeerContext&>(conn->getContext());
+    sendToPeers(Slice(frame), context.nodeId);
+    if (gossipCallback_)
+    {
+        const char* payload = body + sizeof(int64_t);
+        gossipCallback_(origin,
+                        StringPiece(payload, static_cast<int>(frame.end() - payload)),
+                        receiveTime);
+    }
+}
+
+void P2pServer::dropConnection(const TcpConnectionPtr& conn, bool outbound)
+{
+    if (outbound)
+    {
+        ClientMap::iterator it = clients_.find(conn->peerAddress().toIpPort());
+        if (it != clients_.end())
+        {
+            // for good, the peer is kept over another connection, or
+            // not at all, a retry would be dropped the same way
+            TcpClientPtr client(it->second);
+            clients_.erase(it);
+            client->disconnect();
+            // destroyed once this callback of its connection returns
+            loop_->queueInLoop(bind(&P2pServer::releaseClient, client));
+            return;
+        }
+    }
+    conn->shutdown();
+}
+
+void P2pServer::releaseClient(const TcpClientPtr&)
+{
+}
+
+bool P2pServer::testAndMarkSeen(uint64_t hash)
+{
+    if (seen_->mayContain(hash) || seenOlder_->mayContain(hash))
+    {
+        return true;
+    }
+    if (seen_->added() >= seen_->capacity())
+    {
+        std::swap(seen_, seenOlder_);
+        seen_->clear();
+    }
+    seen_->add(hash);
+    return false;
+}
+
+void P2pServer::sendToPeers(const Slice& frame, int64_t except)
+{
+    for (PeerMap::const_iterator it = peers_.begin(); it != peers_.end(); ++it)
+    {
+        if (it->first == except)
+        {
+            continue;
+        }
+        const TcpConnectionPtr& conn = it->second;
+        if (conn->outputBuffer()->readableBytes() > MAX_PEER_OUTPUT)
+        {
+            ++droppedFrames_;
+            continue;
+        }
+        conn->send(frame);
+        ++sentFrames_;
+    }
+}
+
+} // namespace net
+
+} // namespace tesla
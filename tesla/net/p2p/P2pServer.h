@@ -1 +1,227 @@
-make it not empty
\ No newline at end of file
+/*
+ *
+ * Author:
+ *     Thomas Liu
+ * Date:
+ *     10/18/2026
+ * Description:
+ *     Peer-to-peer node, a mesh of TCP peers flooding gossip
+ *
+ *
+ * Licensed under the Apache License, Version 2.0
+ *
+ */
+
+#ifndef TESLA_NET_P2P_P2PSERVER_H
+#define TESLA_NET_P2P_P2PSERVER_H
+
+#include <tesla/base/Noncopyable.hpp>
+#include <tesla/base/StringPiece.hpp>
+#include <tesla/base/Timestamp.h>
+#include <tesla/base/Types.hpp>
+
+#include <tesla/net/TcpClient.h>
+#include <tesla/net/TcpServer.h>
+#include <tesla/net/p2p/BloomFilter.h>
+
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+#include <functional>
+#include <memory>
+#else // __GXX_EXPERIMENTAL_CXX0X__
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#endif // __GXX_EXPERIMENTAL_CXX0X__
+
+#include <map>
+
+#include <stdint.h>
+
+namespace tesla
+{
+
+namespace net
+{
+
+///
+/// A node of a peer-to-peer mesh, all its peers in one loop.
+///
+/// Peers are accepted with a TcpServer and dialed with TcpClients.
+/// Both ends open with a Hello frame of their node id, so a node drops
+/// a connection to itself, and of two connections between a pair of
+/// nodes, as when both dial each other, both keep the one dialed by
+/// the smaller id. At most maxPeers are kept, others are closed after
+/// their Hello.
+///
+/// broadcast() floods a message, a node relays the messages it sees
+/// first to its peers but the one it came from. A message is serialized
+/// once, into a Slice shared by the output queues of all peers, and
+/// relayed as it was received. Seen messages are remembered in two
+/// generations of Bloom filters of SEEN_CAPACITY messages each, a false
+/// positive drops a message at this node, other paths usually carry it.
+/// A peer with more than MAX_PEER_OUTPUT bytes queued misses messages.
+///
+/// Frame: int32 length of the rest | int8 type | int64 node id | body,
+/// the node id is the sender of a Hello, the origin of a Gossip,
+/// whose body is int64 sequence | payload.
+///
+class P2pServer
+    : private tesla::base::Noncopyable
+{
+public:
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+    typedef std::function<void (int64_t origin,
+                                const tesla::base::StringPiece& payload,
+                                tesla::base::Timestamp)> GossipCallback;
+    typedef std::function<void (int64_t nodeId, bool up)> PeerCallback;
+#else // __GXX_EXPERIMENTAL_CXX0X__
+    typedef boost::function<void (int64_t origin,
+                                  const tesla::base::StringPiece& payload,
+                                  tesla::base::Timestamp)> GossipCallback;
+    typedef boost::function<void (int64_t nodeId, bool up)> PeerCallback;
+#endif // __GXX_EXPERIMENTAL_CXX0X__
+
+    static const int DEFAULT_MAX_PEERS = 32;
+    static const size_t SEEN_CAPACITY = 256 * 1024;
+    static const int32_t MAX_FRAME_SIZE = 1024 * 1024;
+    static const size_t MAX_PEER_OUTPUT = 8 * 1024 * 1024;
+
+    P2pServer(EventLoop* loop,
+              const InetAddress& listenAddr,
+              const tesla::base::string& name,
+              int maxPeers = DEFAULT_MAX_PEERS);
+    ~P2pServer();  // force out-line dtor, for TcpClient members.
+
+    /// random, unique among the nodes in practice
+    int64_t nodeId() const
+    {
+        return nodeId_;
+    }
+    const tesla::base::string& name() const
+    {
+        return server_.name();
+    }
+    EventLoop* getLoop() const
+    {
+        return loop_;
+    }
+
+    /// Called once per message, for those of other nodes.
+    /// Not thread safe, set it before start().
+    void setGossipCallback(const GossipCallback& cb)
+    {
+        gossipCallback_ = cb;
+    }
+    /// Called as a peer joins or leaves the peer table.
+    /// Not thread safe, set it before start().
+    void setPeerCallback(const PeerCallback& cb)
+    {
+        peerCallback_ = cb;
+    }
+
+    /// Thread safe.
+    void start();
+    /// Dials @c peerAddr, and again whenever the connection is lost.
+    /// If the peer is kept over another connection, or breaks the
+    /// protocol, it is not dialed again until the next connectTo().
+    /// Thread safe.
+    void connectTo(const InetAddress& peerAddr);
+    /// Floods @c payload to the mesh. Thread safe.
+    void broadcast(const tesla::base::StringPiece& payload);
+
+    /// Not thread safe, but in loop
+    size_t peerCount() const
+    {
+        return peers_.size();
+    }
+    /// messages delivered, those seen before, and frames sent to peers
+    int64_t delivered() const
+    {
+        return delivered_;
+    }
+    int64_t duplicates() const
+    {
+        return duplicates_;
+    }
+    int64_t sentFrames() const
+    {
+        return sentFrames_;
+    }
+    /// frames not sent as the peer had MAX_PEER_OUTPUT queued
+    int64_t droppedFrames() const
+    {
+        return droppedFrames_;
+    }
+
+private:
+    enum FrameType
+    {
+        Hello = 1,
+        Gossip = 2,
+    };
+
+    /// the context of a connection
+    struct PeerContext
+    {
+        int64_t nodeId; // 0 until its Hello
+        bool outbound;
+    };
+
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+    typedef std::shared_ptr<TcpClient> TcpClientPtr;
+#else // __GXX_EXPERIMENTAL_CXX0X__
+    typedef boost::shared_ptr<TcpClient> TcpClientPtr;
+#endif // __GXX_EXPERIMENTAL_CXX0X__
+    typedef std::map<int64_t, TcpConnectionPtr> PeerMap;
+    typedef std::map<tesla::base::string, TcpClientPtr> ClientMap;
+
+    void connectInLoop(const InetAddress& peerAddr);
+    void broadcastString(const tesla::base::string& payload);
+    void broadcastInLoop(const tesla::base::StringPiece& payload);
+
+    void onConnection(const TcpConnectionPtr& conn, bool outbound);
+    void onMessage(const TcpConnectionPtr& conn,
+                   Buffer* buf,
+                   tesla::base::Timestamp receiveTime);
+    void onHello(const TcpConnectionPtr& conn, PeerContext* context, int64_t nodeId);
+    void onGossip(const TcpConnectionPtr& conn,
+                  const tesla::base::StringPiece& frame,
+                  int64_t origin,
+                  tesla::base::Timestamp receiveTime);
+    /// closes it, for good if this node dialed it
+    void dropConnection(const TcpConnectionPtr& conn, bool outbound);
+    /// holds @c client in a functor, until it is run
+    static void releaseClient(const TcpClientPtr& client);
+    /// whether the message was seen, marks it seen
+    bool testAndMarkSeen(uint64_t hash);
+    /// sends to all peers but @c except
+    void sendToPeers(const Slice& frame, int64_t except);
+
+    EventLoop* loop_;
+    const int64_t nodeId_;
+    const int maxPeers_;
+    GossipCallback gossipCallback_;
+    PeerCallback peerCallback_;
+
+    // always in loop thread
+    PeerMap peers_;
+    ClientMap clients_; // keyed by the dialed ip:port
+    int64_t sequence_;
+    BloomFilter seenFilter0_;
+    BloomFilter seenFilter1_;
+    BloomFilter* seen_;      // being filled
+    BloomFilter* seenOlder_; // the generation before, cleared next
+
+    int64_t delivered_;
+    int64_t duplicates_;
+    int64_t sentFrames_;
+    int64_t droppedFrames_;
+
+    // last, its dtor calls back onConnection() for its connections
+    TcpServer server_;
+}; // class P2pServer
+
+} // namespace net
+
+} // namespace tesla
+
+#endif  // TESLA_NET_P2P_P2PSERVER_H
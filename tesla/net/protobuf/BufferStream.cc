@@ -1 +1,101 @@
-make it not empty
\ No newline at end of file
+#include <tesla/net/protobuf/BufferStream.h>
+
+#include <algorithm>
+
+#include <assert.h>
+#include <limits.h>
+
+namespace tesla
+{
+
+namespace net
+{
+
+const size_t BufferOutputStream::MIN_BLOCK_SIZE;
+
+BufferInputStream::BufferInputStream(const Buffer& buffer, size_t offset, size_t count)
+    : data_(buffer.peek() + offset),
+      size_(count),
+      position_(0)
+{
+    assert(offset + count <= buffer.readableBytes());
+}
+
+BufferInputStream::~BufferInputStream()
+{
+}
+
+bool BufferInputStream::Next(const void** data, int* size)
+{
+    if (position_ == size_)
+    {
+        return false;
+    }
+    // the bytes are contiguous, all of them in one block
+    size_t block = std::min(size_ - position_, static_cast<size_t>(INT_MAX));
+    *data = data_ + position_;
+    *size = static_cast<int>(block);
+    position_ += block;
+    return true;
+}
+
+void BufferInputStream::BackUp(int count)
+{
+    assert(count >= 0 && static_cast<size_t>(count) <= position_);
+    position_ -= count;
+}
+
+bool BufferInputStream::Skip(int count)
+{
+    assert(count >= 0);
+    if (static_cast<size_t>(count) > size_ - position_)
+    {
+        position_ = size_;
+        return false;
+    }
+    position_ += count;
+    return true;
+}
+
+int64_t BufferInputStream::ByteCount() const
+{
+    return static_cast<int64_t>(position_);
+}
+
+BufferOutputStream::BufferOutputStream(Buffer* buffer)
+    : buffer_(buffer),
+      originalSize_(buffer->readableBytes())
+{
+}
+
+BufferOutputStream::~BufferOutputStream()
+{
+}
+
+bool BufferOutputStream::Next(void** data, int* size)
+{
+    if (buffer_->writableBytes() == 0)
+    {
+        buffer_->ensureWritableBytes(MIN_BLOCK_SIZE);
+    }
+    size_t block = std::min(buffer_->writableBytes(), static_cast<size_t>(INT_MAX));
+    *data = buffer_->beginWrite();
+    *size = static_cast<int>(block);
+    buffer_->hasWritten(block);
+    return true;
+}
+
+void BufferOutputStream::BackUp(int count)
+{
+    assert(count >= 0 && static_cast<size_t>(count) <= buffer_->readableBytes() - originalSize_);
+    buffer_->unwrite(count);
+}
+
+int64_t BufferOutputStream::ByteCount() const
+{
+    return static_cast<int64_t>(buffer_->readableBytes() - originalSize_);
+}
+
+} // namespace net
+
+} // namespace tesla
@@ -1 +1,84 @@
-make it not empty
\ No newline at end of file
+/*
+ *
+ * Author:
+ *     Thomas Liu
+ * Date:
+ *     10/18/2026
+ * Description:
+ *     Protobuf zero-copy streams over a Buffer
+ *
+ *
+ * Licensed under the Apache License, Version 2.0
+ *
+ */
+
+#ifndef TESLA_NET_PROTOBUF_BUFFERSTREAM_H
+#define TESLA_NET_PROTOBUF_BUFFERSTREAM_H
+
+#include <tesla/net/Buffer.h>
+
+#include <google/protobuf/io/zero_copy_stream.h>
+
+#include <stdint.h>
+
+namespace tesla
+{
+
+namespace net
+{
+
+///
+/// Parses straight from the readable bytes of a Buffer.
+///
+/// Reads @c count bytes from @c offset into the readable bytes,
+/// in place, the buffer is left untouched and must outlive the stream.
+///
+class BufferInputStream
+    : public google::protobuf::io::ZeroCopyInputStream
+{
+public:
+    BufferInputStream(const Buffer& buffer, size_t offset, size_t count);
+    virtual ~BufferInputStream();
+
+    virtual bool Next(const void** data, int* size);
+    virtual void BackUp(int count);
+    virtual bool Skip(int count);
+    virtual int64_t ByteCount() const;
+
+private:
+    const char* data_;
+    size_t size_;
+    size_t position_;
+}; // class BufferInputStream
+
+///
+/// Serializes straight into the writable bytes of a Buffer,
+/// what is written is appended to its readable bytes.
+///
+/// Reserve the serialized size with Buffer::ensureWritableBytes(),
+/// and the message is written in one block.
+///
+class BufferOutputStream
+    : public google::protobuf::io::ZeroCopyOutputStream
+{
+public:
+    explicit BufferOutputStream(Buffer* buffer);
+    virtual ~BufferOutputStream();
+
+    virtual bool Next(void** data, int* size);
+    virtual void BackUp(int count);
+    virtual int64_t ByteCount() const;
+
+private:
+    /// the buffer grows by at least this much when full
+    static const size_t MIN_BLOCK_SIZE = 1024;
+
+    Buffer* buffer_;
+    size_t originalSize_;
+}; // class BufferOutputStream
+
+} // namespace net
+
+} // namespace tesla
+
+#endif  // TESLA_NET_PROTOBUF_BUFFERSTREAM_H
@@ -1 +1,212 @@
-make it not empty
\ No newline at end of file
+#include <tesla/net/protobuf/ProtobufCodec.h>
+#include <tesla/net/protobuf/BufferStream.h>
+
+#include <tesla/base/Crc32c.h>
+#include <tesla/base/Logger.h>
+
+#include <tesla/net/Buffer.h>
+#include <tesla/net/Endian.hpp>
+#include <tesla/net/TcpConnection.h>
+
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/message.h>
+
+#include <assert.h>
+#include <string.h>
+
+namespace tesla
+{
+
+namespace net
+{
+
+using namespace tesla::base;
+
+const int ProtobufCodec::HEADER_LEN;
+const int ProtobufCodec::MIN_MESSAGE_LEN;
+const int ProtobufCodec::MAX_MESSAGE_LEN;
+
+int32_t asInt32(const char* buf)
+{
+    int32_t be32 = 0;
+    ::memcpy(&be32, buf, sizeof be32);
+    return networkToHost32(be32);
+}
+
+int32_t checkSumOf(const char* buf, size_t len)
+{
+    return static_cast<int32_t>(Crc32c::value(buf, len));
+}
+
+ProtobufCodec::ProtobufCodec(const ProtobufMessageCallback& messageCallback)
+    : messageCallback_(messageCallback),
+      errorCallback_(defaultErrorCallback)
+{
+}
+
+ProtobufCodec::ProtobufCodec(const ProtobufMessageCallback& messageCallback,
+                             const ErrorCallback& errorCallback)
+    : messageCallback_(messageCallback),
+      errorCallback_(errorCallback)
+{
+}
+
+void ProtobufCodec::onMessage(const TcpConnectionPtr& conn,
+                              Buffer* buf,
+                              Timestamp receiveTime)
+{
+    while (buf->readableBytes() >= implicit_cast<size_t>(MIN_MESSAGE_LEN + HEADER_LEN))
+    {
+        const int32_t len = buf->peekInt32();
+        if (len > MAX_MESSAGE_LEN || len < MIN_MESSAGE_LEN)
+        {
+            errorCallback_(conn, buf, receiveTime, InvalidLength);
+            break;
+        }
+
+        const size_t frameLen = HEADER_LEN + len;
+        if (buf->readableBytes() < frameLen)
+        {
+            // make room for the rest of the frame at once,
+            // rather than growing the buffer read by read
+            buf->ensureWritableBytes(frameLen - buf->readableBytes());
+            break;
+        }
+
+        ErrorCode errorCode = NoError;
+        MessagePtr message = parse(*buf, len, &errorCode);
+        if (errorCode != NoError)
+        {
+            errorCallback_(conn, buf, receiveTime, errorCode);
+            break;
+        }
+        messageCallback_(conn, message, receiveTime);
+        buf->retrieve(frameLen);
+    }
+}
+
+void ProtobufCodec::send(const TcpConnectionPtr& conn,
+                         const google::protobuf::Message& message)
+{
+    Buffer buf;
+    fillBuffer(&buf, message);
+    conn->send(&buf);
+}
+
+const char* ProtobufCodec::errorCodeToString(ErrorCode errorCode)
+{
+    switch (errorCode)
+    {
+    case NoError:
+        return "NoError";
+    case InvalidLength:
+        return "InvalidLength";
+    case CheckSumError:
+        return "CheckSumError";
+    case InvalidNameLength:
+        return "InvalidNameLength";
+    case UnknownMessageType:
+        return "UnknownMessageType";
+    case ParseError:
+        return "ParseError";
+    default:
+        return "UnknownError";
+    }
+}
+
+void ProtobufCodec::fillBuffer(Buffer* buf, const google::protobuf::Message& message)
+{
+    const size_t start = buf->readableBytes();
+    const std::string& typeName = message.GetTypeName();
+    const int32_t nameLen = static_cast<int32_t>(typeName.size() + 1);
+    const size_t byteSize = message.ByteSizeLong();
+    buf->ensureWritableBytes(3 * HEADER_LEN + nameLen + byteSize);
+
+    buf->appendInt32(0); // the length, filled in below
+    buf->appendInt32(nameLen);
+    buf->append(typeName.c_str(), nameLen);
+    {
+        BufferOutputStream output(buf);
+        google::protobuf::io::CodedOutputStream coded(&output);
+        // the sizes were cached by ByteSizeLong() above
+        message.SerializeWithCachedSizes(&coded);
+    }
+    assert(buf->readableBytes() - start == 2 * HEADER_LEN + nameLen + byteSize);
+
+    const char* frame = buf->peek() + start + HEADER_LEN;
+    buf->appendInt32(checkSumOf(frame, buf->beginWrite() - frame));
+
+    int32_t be32 = hostToNetwork32(static_cast<int32_t>(buf->readableBytes() - start - HEADER_LEN));
+    ::memcpy(const_cast<char*>(buf->peek()) + start, &be32, sizeof be32);
+}
+
+MessagePtr ProtobufCodec::parse(const Buffer& buf, int32_t len, ErrorCode* errorCode)
+{
+    assert(len >= MIN_MESSAGE_LEN && buf.readableBytes() >= implicit_cast<size_t>(HEADER_LEN + len));
+    MessagePtr message;
+
+    const char* frame = buf.peek() + HEADER_LEN;
+    const int32_t expectedCheckSum = asInt32(frame + len - HEADER_LEN);
+    if (checkSumOf(frame, len - HEADER_LEN) != expectedCheckSum)
+    {
+        *errorCode = CheckSumError;
+        return message;
+    }
+
+    const int32_t nameLen = asInt32(frame);
+    if (nameLen < 2 || nameLen > len - 2 * HEADER_LEN || frame[HEADER_LEN + nameLen - 1] != '\0')
+    {
+        *errorCode = InvalidNameLength;
+        return message;
+    }
+
+    std::string typeName(frame + HEADER_LEN, nameLen - 1);
+    message.reset(createMessage(typeName));
+    if (!message)
+    {
+        *errorCode = UnknownMessageType;
+        return message;
+    }
+
+    BufferInputStream input(buf, 2 * HEADER_LEN + nameLen, len - nameLen - 2 * HEADER_LEN);
+    if (message->ParseFromZeroCopyStream(&input))
+    {
+        *errorCode = NoError;
+    }
+    else
+    {
+        *errorCode = ParseError;
+        message.reset();
+    }
+    return message;
+}
+
+google::protobuf::Message* ProtobufCodec::createMessage(const std::string& typeName)
+{
+    const google::protobuf::Descriptor* descriptor =
+        google::protobuf::DescriptorPool::generated_pool()->FindMessageTypeByName(typeName);
+    if (descriptor == NULL)
+    {
+        return NULL;
+    }
+    const google::protobuf::Message* prototype =
+        google::protobuf::MessageFactory::generated_factory()->GetPrototype(descriptor);
+    return prototype != NULL ? prototype->New() : NULL;
+}
+
+void ProtobufCodec::defaultErrorCallback(const TcpConnectionPtr& conn,
+                                         Buffer* buf,
+                                         Timestamp receiveTime,
+                                         ErrorCode errorCode)
+{
+    LOG_ERROR << "ProtobufCodec::defaultErrorCallback - " << errorCodeToString(errorCode);
+    if (conn && conn->connected())
+    {
+        conn->shutdown();
+    }
+}
+
+} // namespace net
+
+} // namespace tesla
@@ -1 +1,142 @@
-make it not empty
\ No newline at end of file
+/*
+ *
+ * Author:
+ *     Thomas Liu
+ * Date:
+ *     10/18/2026
+ * Description:
+ *     Length-prefixed protobuf codec over TcpConnection
+ *
+ *
+ * Licensed under the Apache License, Version 2.0
+ *
+ */
+
+#ifndef TESLA_NET_PROTOBUF_PROTOBUFCODEC_H
+#define TESLA_NET_PROTOBUF_PROTOBUFCODEC_H
+
+#include <tesla/base/Noncopyable.hpp>
+
+#include <tesla/net/Callbacks.hpp>
+
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+#include <functional>
+#else // __GXX_EXPERIMENTAL_CXX0X__
+#include <boost/function.hpp>
+#endif // __GXX_EXPERIMENTAL_CXX0X__
+#include <boost/shared_ptr.hpp>
+
+#include <string>
+
+#include <stdint.h>
+
+namespace google
+{
+namespace protobuf
+{
+class Message;
+} // namespace protobuf
+} // namespace google
+
+namespace tesla
+{
+
+namespace net
+{
+
+typedef boost::shared_ptr<google::protobuf::Message> MessagePtr;
+
+///
+/// Frames protobuf messages on a TcpConnection:
+///
+///     int32_t len;                // of the rest of the frame
+///     int32_t nameLen;            // with the trailing '\0'
+///     char    typeName[nameLen];  // full name, "tesla.Query"
+///     char    data[len - nameLen - 8];
+///     int32_t checkSum;           // CRC-32C of nameLen, typeName and data
+///
+/// All integers in network byte order.
+///
+/// A message is serialized straight into the output Buffer and parsed
+/// straight from the input Buffer, through the streams of BufferStream.h,
+/// there is no std::string in between.
+///
+class ProtobufCodec
+    : private tesla::base::Noncopyable
+{
+public:
+    enum ErrorCode
+    {
+        NoError = 0,
+        InvalidLength,
+        CheckSumError,
+        InvalidNameLength,
+        UnknownMessageType,
+        ParseError,
+    };
+
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+    typedef std::function<void (const TcpConnectionPtr&,
+                                const MessagePtr&,
+                                tesla::base::Timestamp)> ProtobufMessageCallback;
+    typedef std::function<void (const TcpConnectionPtr&,
+                                Buffer*,
+                                tesla::base::Timestamp,
+                                ErrorCode)> ErrorCallback;
+#else // __GXX_EXPERIMENTAL_CXX0X__
+    typedef boost::function<void (const TcpConnectionPtr&,
+                                  const MessagePtr&,
+                                  tesla::base::Timestamp)> ProtobufMessageCallback;
+    typedef boost::function<void (const TcpConnectionPtr&,
+                                  Buffer*,
+                                  tesla::base::Timestamp,
+                                  ErrorCode)> ErrorCallback;
+#endif // __GXX_EXPERIMENTAL_CXX0X__
+
+    static const int HEADER_LEN = sizeof(int32_t);
+    static const int MIN_MESSAGE_LEN = 2 * HEADER_LEN + 2; // nameLen, typeName "\0" and checkSum
+    static const int MAX_MESSAGE_LEN = 64 * 1024 * 1024;
+
+    explicit ProtobufCodec(const ProtobufMessageCallback& messageCallback);
+    ProtobufCodec(const ProtobufMessageCallback& messageCallback,
+                  const ErrorCallback& errorCallback);
+
+    /// The MessageCallback of the connection, every complete message
+    /// goes to the ProtobufMessageCallback. On a bad frame the ErrorCallback
+    /// is called and the rest of @c buf is left alone, by default
+    /// the connection is shut down.
+    void onMessage(const TcpConnectionPtr& conn,
+                   Buffer* buf,
+                   tesla::base::Timestamp receiveTime);
+
+    /// Serializes and sends @c message in one frame, no copy.
+    void send(const TcpConnectionPtr& conn,
+              const google::protobuf::Message& message);
+
+    static const char* errorCodeToString(ErrorCode errorCode);
+
+    /// Appends the frame of @c message to @c buf, so several
+    /// messages can be batched into one send.
+    static void fillBuffer(Buffer* buf, const google::protobuf::Message& message);
+    /// Parses the frame of @c len bytes behind the length field
+    /// at the front of @c buf, @c buf is left untouched.
+    static MessagePtr parse(const Buffer& buf, int32_t len, ErrorCode* errorCode);
+    /// A new message of the generated type named @c typeName,
+    /// NULL if there is none.
+    static google::protobuf::Message* createMessage(const std::string& typeName);
+
+private:
+    static void defaultErrorCallback(const TcpConnectionPtr& conn,
+                                     Buffer* buf,
+                                     tesla::base::Timestamp receiveTime,
+                                     ErrorCode errorCode);
+
+    ProtobufMessageCallback messageCallback_;
+    ErrorCallback errorCallback_;
+}; // class ProtobufCodec
+
+} // namespace net
+
+} // namespace tesla
+
+#endif  // TESLA_NET_PROTOBUF_PROTOBUFCODEC_H
@@ -0,0 +1,137 @@
+/*
+ *
+ * Author:
+ *     Thomas Liu
+ * Date:
+ *     10/18/2026
+ * Description:
+ *     Dispatches protobuf messages to callbacks by message type
+ *
+ *
+ * Licensed under the Apache License, Version 2.0
+ *
+ */
+
+#ifndef TESLA_NET_PROTOBUF_PROTOBUFDISPATCHER_H
+#define TESLA_NET_PROTOBUF_PROTOBUFDISPATCHER_H
+
+#include <tesla/base/Noncopyable.hpp>
+
+#include <tesla/net/Callbacks.hpp>
+#include <tesla/net/protobuf/ProtobufCodec.h>
+
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/message.h>
+
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+#include <functional>
+#else // __GXX_EXPERIMENTAL_CXX0X__
+#include <boost/function.hpp>
+#endif // __GXX_EXPERIMENTAL_CXX0X__
+#include <boost/shared_ptr.hpp>
+
+#include <map>
+
+namespace tesla
+{
+
+namespace net
+{
+
+class ProtobufCallback
+    : private tesla::base::Noncopyable
+{
+public:
+    virtual ~ProtobufCallback()
+    { }
+    virtual void onMessage(const TcpConnectionPtr& conn,
+                           const MessagePtr& message,
+                           tesla::base::Timestamp receiveTime) const = 0;
+}; // class ProtobufCallback
+
+template <typename T>
+class ProtobufCallbackT : public ProtobufCallback
+{
+public:
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+    typedef std::function<void (const TcpConnectionPtr&,
+                                const boost::shared_ptr<T>&,
+                                tesla::base::Timestamp)> Callback;
+#else // __GXX_EXPERIMENTAL_CXX0X__
+    typedef boost::function<void (const TcpConnectionPtr&,
+                                  const boost::shared_ptr<T>&,
+                                  tesla::base::Timestamp)> Callback;
+#endif // __GXX_EXPERIMENTAL_CXX0X__
+
+    explicit ProtobufCallbackT(const Callback& callback)
+        : callback_(callback)
+    { }
+
+    virtual void onMessage(const TcpConnectionPtr& conn,
+                           const MessagePtr& message,
+                           tesla::base::Timestamp receiveTime) const
+    {
+        boost::shared_ptr<T> concrete = down_pointer_cast<T>(message);
+        assert(concrete != NULL);
+        callback_(conn, concrete, receiveTime);
+    }
+
+private:
+    Callback callback_;
+}; // class ProtobufCallbackT
+
+///
+/// The ProtobufMessageCallback of a ProtobufCodec, hands each message
+/// to the callback registered for its type, as that type:
+///
+///     dispatcher.registerMessageCallback<tesla::Query>(onQuery);
+///     void onQuery(const TcpConnectionPtr&, const boost::shared_ptr<tesla::Query>&, Timestamp);
+///
+/// Messages of other types go to the default callback.
+/// Register all callbacks before the first message arrives.
+///
+class ProtobufDispatcher
+    : private tesla::base::Noncopyable
+{
+public:
+    typedef ProtobufCodec::ProtobufMessageCallback ProtobufMessageCallback;
+
+    explicit ProtobufDispatcher(const ProtobufMessageCallback& defaultCallback)
+        : defaultCallback_(defaultCallback)
+    { }
+
+    void onProtobufMessage(const TcpConnectionPtr& conn,
+                           const MessagePtr& message,
+                           tesla::base::Timestamp receiveTime) const
+    {
+        CallbackMap::const_iterator it = callbacks_.find(message->GetDescriptor());
+        if (it != callbacks_.end())
+        {
+            it->second->onMessage(conn, message, receiveTime);
+        }
+        else
+        {
+            defaultCallback_(conn, message, receiveTime);
+        }
+    }
+
+    template <typename T>
+    void registerMessageCallback(const typename ProtobufCallbackT<T>::Callback& callback)
+    {
+        boost::shared_ptr<ProtobufCallbackT<T> > pd(new ProtobufCallbackT<T>(callback));
+        callbacks_[T::descriptor()] = pd;
+    }
+
+private:
+    typedef std::map<const google::protobuf::Descriptor*,
+                     boost::shared_ptr<ProtobufCallback> > CallbackMap;
+
+    CallbackMap callbacks_;
+    ProtobufMessageCallback defaultCallback_;
+}; // class ProtobufDispatcher
+
+} // namespace net
+
+} // namespace tesla
+
+#endif  // TESLA_NET_PROTOBUF_PROTOBUFDISPATCHER_H
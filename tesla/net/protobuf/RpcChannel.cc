@@ -0,0 +1,231 @@
+#include <tesla/net/protobuf/RpcChannel.h>
+#include <tesla/net/protobuf/RpcCodec.h>
+#include <tesla/net/protobuf/RpcController.h>
+
+#include <tesla/base/Logger.h>
+#include <tesla/base/WeakCallback.hpp>
+
+#include <tesla/net/EventLoop.h>
+
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/message.h>
+
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+#include <functional>
+#else // __GXX_EXPERIMENTAL_CXX0X__
+#include <boost/bind.hpp>
+#endif // __GXX_EXPERIMENTAL_CXX0X__
+
+namespace tesla
+{
+
+namespace net
+{
+
+using namespace tesla::base;
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+using std::bind;
+using namespace std::placeholders;
+#else // __GXX_EXPERIMENTAL_CXX0X__
+using boost::bind;
+#endif // __GXX_EXPERIMENTAL_CXX0X__
+
+const double RpcChannel::TIMEOUT_SLACK = 0.1;
+
+void keepRpcChannel(RpcChannel*)
+{
+}
+
+RpcChannel::RpcChannel(EventLoop* loop,
+                       const InetAddress& serverAddr,
+                       const string& name)
+    : loop_(loop),
+      client_(loop, serverAddr, name),
+      defaultTimeout_(5.0),
+      nextId_(0),
+      flushQueued_(false),
+      calls_(0),
+      flushes_(0),
+      self_(this, keepRpcChannel)
+{
+    client_.setConnectionCallback(bind(&RpcChannel::onConnection, this, _1));
+    client_.setMessageCallback(bind(&RpcChannel::onMessage, this, _1, _2, _3));
+}
+
+RpcChannel::~RpcChannel()
+{
+    // a flush still queued finds the channel gone
+    self_.reset();
+    failAll("channel destroyed");
+}
+
+void RpcChannel::CallMethod(const google::protobuf::MethodDescriptor* method,
+                            google::protobuf::RpcController* controller,
+                            const google::protobuf::Message* request,
+                            google::protobuf::Message* response,
+                            google::protobuf::Closure* done)
+{
+    double timeout = defaultTimeout_;
+    RpcController* ours = dynamic_cast<RpcController*>(controller);
+    if (ours != NULL && ours->timeout() > 0)
+    {
+        timeout = ours->timeout();
+    }
+
+    __atomic_fetch_add(&calls_, 1, __ATOMIC_RELAXED);
+    MutexLockGuard lock(mutex_);
+    const int64_t id = ++nextId_;
+    RpcCodec::fillRequest(&pendingOutput_, id, method->full_name(), *request);
+
+    OutstandingCall& call = outstandings_[id];
+    call.response = response;
+    call.controller = controller;
+    call.done = done;
+    call.timer = loop_->runAfter(timeout,
+                                 bind(&RpcChannel::onTimeout, this, id),
+                                 timeout * TIMEOUT_SLACK);
+
+    // the calls of this iteration go out together, at its end
+    if (!flushQueued_)
+    {
+        flushQueued_ = true;
+        loop_->queueInLoop(makeWeakCallback(self_, &RpcChannel::flush));
+    }
+}
+
+void RpcChannel::onConnection(const TcpConnectionPtr& conn)
+{
+    if (conn->connected())
+    {
+        conn->setTcpNoDelay(true);
+        flush();
+    }
+    else
+    {
+        failAll("connection closed");
+    }
+}
+
+void RpcChannel::onMessage(const TcpConnectionPtr& conn,
+                           Buffer* buf,
+                           Timestamp)
+{
+    RpcCodec::Frame frame;
+    RpcCodec::ParseResult result;
+    while ((result = RpcCodec::parse(buf, &frame)) == RpcCodec::GotFrame)
+    {
+        if (frame.type == RpcCodec::Request)
+        {
+            LOG_WARN << "RpcChannel::onMessage - request " << frame.id
+                     << " from the server, ignored";
+            buf->retrieve(frame.size);
+            continue;
+        }
+
+        OutstandingCall call;
+        bool found = false;
+        {
+            MutexLockGuard lock(mutex_);
+            OutstandingMap::iterator it = outstandings_.find(frame.id);
+            if (it != outstandings_.end())
+            {
+                call = it->second;
+                outstandings_.erase(it);
+                found = true;
+            }
+        }
+        // not found once its timeout fired
+        if (found)
+        {
+            loop_->cancel(call.timer);
+            if (frame.type == RpcCodec::Error)
+            {
+                complete(call, RpcCodec::payloadOf(*buf, frame).as_string().c_str());
+            }
+            else if (!RpcCodec::parsePayload(*buf, frame, call.response))
+            {
+                complete(call, "bad response");
+            }
+            else
+            {
+                complete(call, NULL);
+            }
+        }
+        buf->retrieve(frame.size);
+    }
+
+    if (result == RpcCodec::BadFrame)
+    {
+        LOG_ERROR << "RpcChannel::onMessage - bad frame from " << conn->name();
+        buf->retrieveAll();
+        conn->shutdown();
+    }
+}
+
+void RpcChannel::onTimeout(int64_t id)
+{
+    OutstandingCall call;
+    {
+        MutexLockGuard lock(mutex_);
+        OutstandingMap::iterator it = outstandings_.find(id);
+        if (it == outstandings_.end())
+        {
+            return;
+        }
+        call = it->second;
+        outstandings_.erase(it);
+    }
+    complete(call, "timeout");
+}
+
+void RpcChannel::flush()
+{
+    TcpConnectionPtr conn = client_.connection();
+    Buffer output;
+    {
+        MutexLockGuard lock(mutex_);
+        flushQueued_ = false;
+        if (!conn || !conn->connected())
+        {
+            // sent once connected
+            return;
+        }
+        output.swap(pendingOutput_);
+    }
+    if (output.readableBytes() > 0)
+    {
+        __atomic_fetch_add(&flushes_, 1, __ATOMIC_RELAXED);
+        conn->send(&output);
+    }
+}
+
+void RpcChannel::failAll(const char* reason)
+{
+    OutstandingMap outstandings;
+    {
+        MutexLockGuard lock(mutex_);
+        outstandings.swap(outstandings_);
+        pendingOutput_.retrieveAll();
+    }
+    for (OutstandingMap::iterator it = outstandings.begin(); it != outstandings.end(); ++it)
+    {
+        loop_->cancel(it->second.timer);
+        complete(it->second, reason);
+    }
+}
+
+void RpcChannel::complete(const OutstandingCall& call, const char* errorText)
+{
+    if (errorText != NULL && call.controller != NULL)
+    {
+        call.controller->SetFailed(errorText);
+    }
+    if (call.done != NULL)
+    {
+        call.done->Run();
+    }
+}
+
+} // namespace net
+
+} // namespace tesla
@@ -0,0 +1,158 @@
+/*
+ *
+ * Author:
+ *     Thomas Liu
+ * Date:
+ *     10/18/2026
+ * Description:
+ *     Client side of protobuf RPC, calls pipelined over one TcpClient
+ *
+ *
+ * Licensed under the Apache License, Version 2.0
+ *
+ */
+
+#ifndef TESLA_NET_PROTOBUF_RPCCHANNEL_H
+#define TESLA_NET_PROTOBUF_RPCCHANNEL_H
+
+#include <tesla/base/Mutex.hpp>
+#include <tesla/base/Types.hpp>
+
+#include <tesla/net/Buffer.h>
+#include <tesla/net/TcpClient.h>
+#include <tesla/net/TimerId.hpp>
+
+#include <google/protobuf/service.h>
+
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+#include <memory>
+#else // __GXX_EXPERIMENTAL_CXX0X__
+#include <boost/shared_ptr.hpp>
+#endif // __GXX_EXPERIMENTAL_CXX0X__
+
+#include <map>
+
+#include <stdint.h>
+
+namespace tesla
+{
+
+namespace net
+{
+
+class EventLoop;
+class InetAddress;
+
+///
+/// Sends the calls of generated service stubs to one server:
+///
+///     RpcChannel channel(&loop, serverAddr, "echo");
+///     channel.connect();
+///     tesla::EchoService::Stub stub(&channel);
+///     stub.Echo(&controller, &request, &response, done);
+///
+/// Calls are pipelined over the connection and told apart by id,
+/// answers may come in any order. The calls made in one iteration
+/// of the loop go out in one send, at the end of the iteration.
+/// Calls made before the connection is up wait for it.
+///
+/// Each call fails after its timeout, that of its RpcController
+/// if it is a tesla::net::RpcController with one, the default
+/// of the channel otherwise. On a lost connection all calls fail.
+/// A timer is set and canceled for every call, for many calls
+/// give the loop EventLoop::WheelTimers.
+/// The request need not outlive CallMethod(), the response and
+/// the controller must outlive @c done, which runs in the loop thread.
+///
+/// CallMethod() is thread safe. Destroy the channel in the loop
+/// thread, outstanding calls fail then.
+///
+class RpcChannel
+    : public google::protobuf::RpcChannel
+{
+public:
+    RpcChannel(EventLoop* loop,
+               const InetAddress& serverAddr,
+               const tesla::base::string& name);
+    virtual ~RpcChannel();
+
+    void connect()
+    {
+        client_.connect();
+    }
+    void disconnect()
+    {
+        client_.disconnect();
+    }
+
+    /// seconds, 5 by default
+    void setDefaultTimeout(double seconds)
+    {
+        defaultTimeout_ = seconds;
+    }
+
+    virtual void CallMethod(const google::protobuf::MethodDescriptor* method,
+                            google::protobuf::RpcController* controller,
+                            const google::protobuf::Message* request,
+                            google::protobuf::Message* response,
+                            google::protobuf::Closure* done);
+
+    /// calls made, and sends they were batched into
+    int64_t calls() const
+    {
+        return __atomic_load_n(&calls_, __ATOMIC_RELAXED);
+    }
+    int64_t flushes() const
+    {
+        return __atomic_load_n(&flushes_, __ATOMIC_RELAXED);
+    }
+
+    /// timers of close timeouts may share an expiration, see EventLoop::runAfter()
+    static const double TIMEOUT_SLACK; // of the timeout
+
+private:
+    struct OutstandingCall
+    {
+        google::protobuf::Message* response;
+        google::protobuf::RpcController* controller;
+        google::protobuf::Closure* done;
+        TimerId timer;
+    };
+    typedef std::map<int64_t, OutstandingCall> OutstandingMap;
+
+    void onConnection(const TcpConnectionPtr& conn);
+    void onMessage(const TcpConnectionPtr& conn,
+                   Buffer* buf,
+                   tesla::base::Timestamp receiveTime);
+    void onTimeout(int64_t id);
+    void flush();
+    void failAll(const char* reason);
+    static void complete(const OutstandingCall& call, const char* errorText);
+
+    EventLoop* loop_;
+    TcpClient client_;
+    double defaultTimeout_;
+
+    tesla::base::MutexLock mutex_;
+    int64_t nextId_;              // @GuardedBy mutex_
+    OutstandingMap outstandings_; // @GuardedBy mutex_
+    Buffer pendingOutput_;        // @GuardedBy mutex_
+    bool flushQueued_;            // @GuardedBy mutex_
+
+    int64_t calls_;   /* atomic */
+    int64_t flushes_; /* atomic */
+
+    /// never deletes, expires as the channel destructs, so that
+    /// a queued flush finds it gone
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+    std::shared_ptr<RpcChannel> self_;
+#else // __GXX_EXPERIMENTAL_CXX0X__
+    boost::shared_ptr<RpcChannel> self_;
+#endif // __GXX_EXPERIMENTAL_CXX0X__
+}; // class RpcChannel
+
+} // namespace net
+
+} // namespace tesla
+
+#endif  // TESLA_NET_PROTOBUF_RPCCHANNEL_H
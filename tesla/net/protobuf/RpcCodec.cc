@@ -0,0 +1,145 @@
+#include <tesla/net/protobuf/RpcCodec.h>
+#include <tesla/net/protobuf/BufferStream.h>
+
+#include <tesla/base/Crc32c.h>
+
+#include <tesla/net/Buffer.h>
+#include <tesla/net/Endian.hpp>
+
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/message.h>
+
+#include <assert.h>
+#include <string.h>
+
+namespace tesla
+{
+
+namespace net
+{
+
+using namespace tesla::base;
+
+const int RpcCodec::HEADER_LEN;
+const int RpcCodec::MIN_FRAME_LEN;
+const int RpcCodec::MAX_FRAME_LEN;
+
+void fillRpcFrame(Buffer* buf,
+                  RpcCodec::MessageType type,
+                  int64_t id,
+                  const StringPiece& method,
+                  const google::protobuf::Message* message,
+                  const StringPiece& errorText)
+{
+    const size_t start = buf->readableBytes();
+    const size_t payloadLen = message != NULL ? message->ByteSizeLong() : errorText.size();
+    buf->ensureWritableBytes(RpcCodec::HEADER_LEN + RpcCodec::MIN_FRAME_LEN + method.size() + payloadLen);
+
+    buf->appendInt32(0); // the length, filled in below
+    buf->appendInt8(static_cast<int8_t>(type));
+    buf->appendInt64(id);
+    buf->appendInt16(static_cast<int16_t>(method.size()));
+    buf->append(method);
+    if (message != NULL)
+    {
+        BufferOutputStream output(buf);
+        google::protobuf::io::CodedOutputStream coded(&output);
+        // the sizes were cached by ByteSizeLong() above
+        message->SerializeWithCachedSizes(&coded);
+    }
+    else
+    {
+        buf->append(errorText);
+    }
+
+    const char* body = buf->peek() + start + RpcCodec::HEADER_LEN;
+    buf->appendInt32(static_cast<int32_t>(Crc32c::value(body, buf->beginWrite() - body)));
+
+    int32_t be32 = hostToNetwork32(static_cast<int32_t>(buf->readableBytes() - start - RpcCodec::HEADER_LEN));
+    ::memcpy(const_cast<char*>(buf->peek()) + start, &be32, sizeof be32);
+}
+
+void RpcCodec::fillRequest(Buffer* buf, int64_t id,
+                           const StringPiece& method,
+                           const google::protobuf::Message& request)
+{
+    fillRpcFrame(buf, Request, id, method, &request, StringPiece());
+}
+
+void RpcCodec::fillResponse(Buffer* buf, int64_t id,
+                            const google::protobuf::Message& response)
+{
+    fillRpcFrame(buf, Response, id, StringPiece(), &response, StringPiece());
+}
+
+void RpcCodec::fillError(Buffer* buf, int64_t id, const StringPiece& errorText)
+{
+    fillRpcFrame(buf, Error, id, StringPiece(), NULL, errorText);
+}
+
+RpcCodec::ParseResult RpcCodec::parse(Buffer* buf, Frame* frame)
+{
+    if (buf->readableBytes() < implicit_cast<size_t>(HEADER_LEN))
+    {
+        return NeedMore;
+    }
+    const int32_t len = buf->peekInt32();
+    if (len < MIN_FRAME_LEN || len > MAX_FRAME_LEN)
+    {
+        return BadFrame;
+    }
+    const size_t frameSize = HEADER_LEN + len;
+    if (buf->readableBytes() < frameSize)
+    {
+        // make room for the rest of the frame at once
+        buf->ensureWritableBytes(frameSize - buf->readableBytes());
+        return NeedMore;
+    }
+
+    const char* body = buf->peek() + HEADER_LEN;
+    int32_t be32 = 0;
+    ::memcpy(&be32, body + len - sizeof be32, sizeof be32);
+    if (Crc32c::value(body, len - sizeof be32) != networkToHost32(be32))
+    {
+        return BadFrame;
+    }
+
+    const int8_t type = body[0];
+    if (type != Request && type != Response && type != Error)
+    {
+        return BadFrame;
+    }
+    int64_t be64 = 0;
+    ::memcpy(&be64, body + 1, sizeof be64);
+    int16_t be16 = 0;
+    ::memcpy(&be16, body + 9, sizeof be16);
+    const size_t methodLen = static_cast<uint16_t>(networkToHost16(be16));
+    if (methodLen > implicit_cast<size_t>(len - MIN_FRAME_LEN))
+    {
+        return BadFrame;
+    }
+
+    frame->type = static_cast<MessageType>(type);
+    frame->id = networkToHost64(be64);
+    frame->method = StringPiece(body + 11, static_cast<int>(methodLen));
+    frame->payloadOffset = HEADER_LEN + 11 + methodLen;
+    frame->payloadLen = len - MIN_FRAME_LEN - methodLen;
+    frame->size = frameSize;
+    return GotFrame;
+}
+
+bool RpcCodec::parsePayload(const Buffer& buf, const Frame& frame,
+                            google::protobuf::Message* message)
+{
+    BufferInputStream input(buf, frame.payloadOffset, frame.payloadLen);
+    return message->ParseFromZeroCopyStream(&input);
+}
+
+StringPiece RpcCodec::payloadOf(const Buffer& buf, const Frame& frame)
+{
+    return StringPiece(buf.peek() + frame.payloadOffset, static_cast<int>(frame.payloadLen));
+}
+
+} // namespace net
+
+} // namespace tesla
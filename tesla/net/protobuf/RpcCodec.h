@@ -0,0 +1,112 @@
+/*
+ *
+ * Author:
+ *     Thomas Liu
+ * Date:
+ *     10/18/2026
+ * Description:
+ *     Frames of protobuf RPC calls
+ *
+ *
+ * Licensed under the Apache License, Version 2.0
+ *
+ */
+
+#ifndef TESLA_NET_PROTOBUF_RPCCODEC_H
+#define TESLA_NET_PROTOBUF_RPCCODEC_H
+
+#include <tesla/base/Noncopyable.hpp>
+#include <tesla/base/StringPiece.hpp>
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace google
+{
+namespace protobuf
+{
+class Message;
+} // namespace protobuf
+} // namespace google
+
+namespace tesla
+{
+
+namespace net
+{
+
+class Buffer;
+
+///
+/// A call and its answer, each in one frame:
+///
+///     int32_t len;             // of the rest of the frame
+///     int8_t  type;            // Request, Response or Error
+///     int64_t id;              // of the call, chosen by the caller
+///     int16_t methodLen;
+///     char    method[methodLen];   // "tesla.EchoService.Echo", requests only
+///     char    payload[];       // the message, or the text of an Error
+///     int32_t checkSum;        // CRC-32C of type to payload
+///
+/// All integers in network byte order.
+///
+/// The message is serialized in place of the payload and parsed
+/// from there, it is not wrapped in another message.
+///
+class RpcCodec
+    : private tesla::base::Noncopyable
+{
+public:
+    enum MessageType
+    {
+        Request = 1,
+        Response = 2,
+        Error = 3,
+    };
+
+    enum ParseResult
+    {
+        NeedMore,
+        GotFrame,
+        BadFrame,
+    };
+
+    /// a frame at the front of a Buffer, the method points into it
+    struct Frame
+    {
+        MessageType type;
+        int64_t id;
+        tesla::base::StringPiece method;
+        size_t payloadOffset;
+        size_t payloadLen;
+        size_t size; // with the length field
+    };
+
+    static const int HEADER_LEN = sizeof(int32_t);
+    static const int MIN_FRAME_LEN = 1 + 8 + 2 + 4; // type, id, methodLen and checkSum
+    static const int MAX_FRAME_LEN = 64 * 1024 * 1024;
+
+    /// Append a frame to @c buf, so that frames can be batched.
+    static void fillRequest(Buffer* buf, int64_t id,
+                            const tesla::base::StringPiece& method,
+                            const google::protobuf::Message& request);
+    static void fillResponse(Buffer* buf, int64_t id,
+                             const google::protobuf::Message& response);
+    static void fillError(Buffer* buf, int64_t id,
+                          const tesla::base::StringPiece& errorText);
+
+    /// Looks at the frame at the front of @c buf, retrieve
+    /// Frame::size bytes when done with it. On NeedMore room is made
+    /// for the rest of the frame.
+    static ParseResult parse(Buffer* buf, Frame* frame);
+    /// Parses the payload of @c frame into @c message.
+    static bool parsePayload(const Buffer& buf, const Frame& frame,
+                             google::protobuf::Message* message);
+    static tesla::base::StringPiece payloadOf(const Buffer& buf, const Frame& frame);
+}; // class RpcCodec
+
+} // namespace net
+
+} // namespace tesla
+
+#endif  // TESLA_NET_PROTOBUF_RPCCODEC_H
@@ -0,0 +1,84 @@
+/*
+ *
+ * Author:
+ *     Thomas Liu
+ * Date:
+ *     10/18/2026
+ * Description:
+ *     RpcController with a timeout
+ *
+ *
+ * Licensed under the Apache License, Version 2.0
+ *
+ */
+
+#ifndef TESLA_NET_PROTOBUF_RPCCONTROLLER_H
+#define TESLA_NET_PROTOBUF_RPCCONTROLLER_H
+
+#include <google/protobuf/service.h>
+
+#include <string>
+
+namespace tesla
+{
+
+namespace net
+{
+
+///
+/// The outcome of a call, and its timeout on the client side.
+/// Cancellation is not supported.
+///
+class RpcController
+    : public google::protobuf::RpcController
+{
+public:
+    RpcController()
+        : timeout_(0.0)
+    { }
+
+    /// seconds, 0 for the default of the RpcChannel
+    void setTimeout(double seconds)
+    {
+        timeout_ = seconds;
+    }
+    double timeout() const
+    {
+        return timeout_;
+    }
+
+    virtual void Reset()
+    {
+        errorText_.clear();
+    }
+    virtual bool Failed() const
+    {
+        return !errorText_.empty();
+    }
+    virtual std::string ErrorText() const
+    {
+        return errorText_;
+    }
+    virtual void StartCancel()
+    { }
+    virtual void SetFailed(const std::string& reason)
+    {
+        errorText_ = reason.empty() ? "failed" : reason;
+    }
+    virtual bool IsCanceled() const
+    {
+        return false;
+    }
+    virtual void NotifyOnCancel(google::protobuf::Closure*)
+    { }
+
+private:
+    double timeout_;
+    std::string errorText_;
+}; // class RpcController
+
+} // namespace net
+
+} // namespace tesla
+
+#endif  // TESLA_NET_PROTOBUF_RPCCONTROLLER_H
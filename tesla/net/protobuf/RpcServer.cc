@@ -0,0 +1,190 @@
+#include <tesla/net/protobuf/RpcServer.h>
+#include <tesla/net/protobuf/RpcCodec.h>
+#include <tesla/net/protobuf/RpcController.h>
+
+#include <tesla/base/Logger.h>
+
+#include <tesla/net/Buffer.h>
+#include <tesla/net/TcpConnection.h>
+
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/message.h>
+#include <google/protobuf/service.h>
+
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+#include <functional>
+#else // __GXX_EXPERIMENTAL_CXX0X__
+#include <boost/bind.hpp>
+#endif // __GXX_EXPERIMENTAL_CXX0X__
+#include <boost/scoped_ptr.hpp>
+
+namespace tesla
+{
+
+namespace net
+{
+
+using namespace tesla::base;
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+using std::bind;
+using namespace std::placeholders;
+#else // __GXX_EXPERIMENTAL_CXX0X__
+using boost::bind;
+#endif // __GXX_EXPERIMENTAL_CXX0X__
+
+/// answers given while a connection's calls are served, see RpcServer::onMessage()
+__thread Buffer* t_rpcBatch = NULL;
+__thread TcpConnection* t_rpcBatchConnection = NULL;
+
+///
+/// A call being served, the @c done of the service.
+///
+class RpcServerCall
+    : public google::protobuf::Closure
+{
+public:
+    RpcServerCall(const TcpConnectionPtr& conn,
+                  int64_t id,
+                  google::protobuf::Message* request,
+                  google::protobuf::Message* response)
+        : conn_(conn),
+          id_(id),
+          request_(request),
+          response_(response)
+    { }
+
+    RpcController* controller()
+    {
+        return &controller_;
+    }
+
+    virtual void Run()
+    {
+        Buffer own;
+        Buffer* output = &own;
+        if (t_rpcBatchConnection == conn_.get())
+        {
+            output = t_rpcBatch;
+        }
+        if (controller_.Failed())
+        {
+            RpcCodec::fillError(output, id_, controller_.ErrorText());
+        }
+        else
+        {
+            RpcCodec::fillResponse(output, id_, *response_);
+        }
+        if (output == &own)
+        {
+            conn_->send(&own);
+        }
+        delete this;
+    }
+
+private:
+    TcpConnectionPtr conn_;
+    int64_t id_;
+    boost::scoped_ptr<google::protobuf::Message> request_;
+    boost::scoped_ptr<google::protobuf::Message> response_;
+    RpcController controller_;
+}; // class RpcServerCall
+
+RpcServer::RpcServer(EventLoop* loop,
+                     const InetAddress& listenAddr,
+                     const string& name,
+                     TcpServer::Option option)
+    : server_(loop, listenAddr, name, option)
+{
+    server_.setConnectionCallback(bind(&RpcServer::onConnection, this, _1));
+    server_.setMessageCallback(bind(&RpcServer::onMessage, this, _1, _2, _3));
+}
+
+RpcServer::~RpcServer()
+{
+}
+
+void RpcServer::registerService(google::protobuf::Service* service)
+{
+    const google::protobuf::ServiceDescriptor* descriptor = service->GetDescriptor();
+    for (int i = 0; i < descriptor->method_count(); ++i)
+    {
+        Method method = { service, descriptor->method(i) };
+        const std::string& fullName = method.descriptor->full_name();
+        methods_[StringPiece(fullName.data(), static_cast<int>(fullName.size()))] = method;
+    }
+}
+
+void RpcServer::start()
+{
+    server_.start();
+}
+
+void RpcServer::onConnection(const TcpConnectionPtr& conn)
+{
+    if (conn->connected())
+    {
+        conn->setTcpNoDelay(true);
+    }
+}
+
+void RpcServer::onMessage(const TcpConnectionPtr& conn,
+                          Buffer* buf,
+                          Timestamp)
+{
+    Buffer batch;
+    t_rpcBatch = &batch;
+    t_rpcBatchConnection = conn.get();
+
+    RpcCodec::Frame frame;
+    RpcCodec::ParseResult result;
+    while ((result = RpcCodec::parse(buf, &frame)) == RpcCodec::GotFrame)
+    {
+        if (frame.type != RpcCodec::Request)
+        {
+            LOG_WARN << "RpcServer::onMessage - answer " << frame.id
+                     << " from the client, ignored";
+            buf->retrieve(frame.size);
+            continue;
+        }
+
+        MethodMap::const_iterator it = methods_.find(frame.method);
+        if (it == methods_.end())
+        {
+            RpcCodec::fillError(&batch, frame.id, "no such method");
+            buf->retrieve(frame.size);
+            continue;
+        }
+
+        google::protobuf::Service* service = it->second.service;
+        const google::protobuf::MethodDescriptor* method = it->second.descriptor;
+        google::protobuf::Message* request = service->GetRequestPrototype(method).New();
+        if (!RpcCodec::parsePayload(*buf, frame, request))
+        {
+            delete request;
+            RpcCodec::fillError(&batch, frame.id, "bad request");
+            buf->retrieve(frame.size);
+            continue;
+        }
+        google::protobuf::Message* response = service->GetResponsePrototype(method).New();
+        RpcServerCall* call = new RpcServerCall(conn, frame.id, request, response);
+        buf->retrieve(frame.size);
+        service->CallMethod(method, call->controller(), request, response, call);
+    }
+
+    t_rpcBatch = NULL;
+    t_rpcBatchConnection = NULL;
+    if (result == RpcCodec::BadFrame)
+    {
+        LOG_ERROR << "RpcServer::onMessage - bad frame from " << conn->name();
+        buf->retrieveAll();
+        conn->shutdown();
+    }
+    if (batch.readableBytes() > 0)
+    {
+        conn->send(&batch);
+    }
+}
+
+} // namespace net
+
+} // namespace tesla
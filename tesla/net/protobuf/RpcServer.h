@@ -0,0 +1,91 @@
+/*
+ *
+ * Author:
+ *     Thomas Liu
+ * Date:
+ *     10/18/2026
+ * Description:
+ *     Server side of protobuf RPC, a registry of services on TcpServer
+ *
+ *
+ * Licensed under the Apache License, Version 2.0
+ *
+ */
+
+#ifndef TESLA_NET_PROTOBUF_RPCSERVER_H
+#define TESLA_NET_PROTOBUF_RPCSERVER_H
+
+#include <tesla/base/Noncopyable.hpp>
+#include <tesla/base/StringPiece.hpp>
+
+#include <tesla/net/TcpServer.h>
+
+#include <map>
+
+namespace google
+{
+namespace protobuf
+{
+class MethodDescriptor;
+class Service;
+} // namespace protobuf
+} // namespace google
+
+namespace tesla
+{
+
+namespace net
+{
+
+///
+/// Serves the calls of RpcChannel to the registered services.
+///
+/// A service answers by running @c done, in any thread, at any time.
+/// The answers given while the calls of one read are served go out
+/// in one send, later ones on their own.
+///
+class RpcServer
+    : private tesla::base::Noncopyable
+{
+public:
+    RpcServer(EventLoop* loop,
+              const InetAddress& listenAddr,
+              const tesla::base::string& name,
+              TcpServer::Option option = TcpServer::NoReusePort);
+    ~RpcServer();
+
+    /// Not thread safe, register before start(),
+    /// the service must outlive the server.
+    void registerService(google::protobuf::Service* service);
+
+    /// see TcpServer::setThreadNum()
+    void setThreadNum(int numThreads)
+    {
+        server_.setThreadNum(numThreads);
+    }
+
+    void start();
+
+private:
+    struct Method
+    {
+        google::protobuf::Service* service;
+        const google::protobuf::MethodDescriptor* descriptor;
+    };
+    /// by full name, the keys point into the descriptors
+    typedef std::map<tesla::base::StringPiece, Method> MethodMap;
+
+    void onConnection(const TcpConnectionPtr& conn);
+    void onMessage(const TcpConnectionPtr& conn,
+                   Buffer* buf,
+                   tesla::base::Timestamp receiveTime);
+
+    TcpServer server_;
+    MethodMap methods_;
+}; // class RpcServer
+
+} // namespace net
+
+} // namespace tesla
+
+#endif  // TESLA_NET_PROTOBUF_RPCSERVER_H
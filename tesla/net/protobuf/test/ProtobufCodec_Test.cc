@@ -1 +1,133 @@
-make it not empty
\ No newline at end of file
+#include <tesla/net/protobuf/ProtobufCodec.h>
+#include <tesla/net/protobuf/test/echo.pb.h>
+
+#include <tesla/base/Timestamp.h>
+
+#include <tesla/net/Buffer.h>
+
+#include <google/protobuf/message.h>
+
+#include <string>
+#include <vector>
+
+#include <assert.h>
+#include <stdio.h>
+
+using namespace tesla::base;
+using namespace tesla::net;
+
+namespace
+{
+
+std::vector<MessagePtr> messages;
+std::vector<ProtobufCodec::ErrorCode> errors;
+
+void onMessage(const TcpConnectionPtr&, const MessagePtr& message, Timestamp)
+{
+    messages.push_back(message);
+}
+
+void onError(const TcpConnectionPtr&, Buffer*, Timestamp, ProtobufCodec::ErrorCode errorCode)
+{
+    errors.push_back(errorCode);
+}
+
+void testRoundTrip()
+{
+    tesla::EchoRequest request;
+    request.set_payload("hello");
+    request.set_delayms(42);
+
+    Buffer buf;
+    ProtobufCodec::fillBuffer(&buf, request);
+
+    const int32_t len = buf.peekInt32();
+    assert(buf.readableBytes() == ProtobufCodec::HEADER_LEN + static_cast<size_t>(len));
+    ProtobufCodec::ErrorCode errorCode = ProtobufCodec::ParseError;
+    MessagePtr message = ProtobufCodec::parse(buf, len, &errorCode);
+    assert(errorCode == ProtobufCodec::NoError);
+    assert(message);
+    assert(message->GetTypeName() == "tesla.EchoRequest");
+    const tesla::EchoRequest* parsed = dynamic_cast<tesla::EchoRequest*>(message.get());
+    assert(parsed != NULL);
+    assert(parsed->payload() == "hello");
+    assert(parsed->delayms() == 42);
+    (void)parsed;
+}
+
+void testBatchAndPartialFrames()
+{
+    messages.clear();
+    errors.clear();
+    ProtobufCodec codec(onMessage, onError);
+
+    tesla::EchoRequest request;
+    request.set_payload(std::string(100 * 1000, 'x')); // larger than a block of BufferOutputStream
+    tesla::EchoResponse response;
+    response.set_payload("world");
+
+    Buffer frames;
+    ProtobufCodec::fillBuffer(&frames, request);
+    ProtobufCodec::fillBuffer(&frames, response);
+
+    // byte by byte for a while, then the rest at once
+    Buffer buf;
+    const char* data = frames.peek();
+    const size_t total = frames.readableBytes();
+    size_t fed = 0;
+    for (; fed < 64; ++fed)
+    {
+        buf.append(data + fed, 1);
+        codec.onMessage(TcpConnectionPtr(), &buf, Timestamp::now());
+        assert(messages.empty());
+    }
+    buf.append(data + fed, total - fed);
+    codec.onMessage(TcpConnectionPtr(), &buf, Timestamp::now());
+
+    assert(errors.empty());
+    assert(messages.size() == 2);
+    assert(buf.readableBytes() == 0);
+    const tesla::EchoRequest* first = dynamic_cast<tesla::EchoRequest*>(messages[0].get());
+    const tesla::EchoResponse* second = dynamic_cast<tesla::EchoResponse*>(messages[1].get());
+    assert(first != NULL && first->payload() == request.payload());
+    assert(second != NULL && second->payload() == "world");
+    (void)first;
+    (void)second;
+}
+
+void testBadFrames()
+{
+    messages.clear();
+    errors.clear();
+    ProtobufCodec codec(onMessage, onError);
+
+    tesla::EchoResponse response;
+    response.set_payload("world");
+
+    Buffer buf;
+    ProtobufCodec::fillBuffer(&buf, response);
+    const_cast<char*>(buf.peek())[buf.readableBytes() - 5] ^= 0x1; // the last byte of the payload
+    codec.onMessage(TcpConnectionPtr(), &buf, Timestamp::now());
+    assert(messages.empty());
+    assert(errors.size() == 1 && errors[0] == ProtobufCodec::CheckSumError);
+
+    errors.clear();
+    buf.retrieveAll();
+    buf.appendInt32(ProtobufCodec::MAX_MESSAGE_LEN + 1);
+    buf.append(std::string(ProtobufCodec::MIN_MESSAGE_LEN, '\0'));
+    codec.onMessage(TcpConnectionPtr(), &buf, Timestamp::now());
+    assert(errors.size() == 1 && errors[0] == ProtobufCodec::InvalidLength);
+}
+
+} // namespace
+
+int main()
+{
+    GOOGLE_PROTOBUF_VERIFY_VERSION;
+    testRoundTrip();
+    testBatchAndPartialFrames();
+    testBadFrames();
+    google::protobuf::ShutdownProtobufLibrary();
+    printf("ProtobufCodec_Test passed\n");
+    return 0;
+}
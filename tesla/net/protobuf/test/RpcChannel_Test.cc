@@ -0,0 +1,180 @@
+#include <tesla/net/protobuf/RpcChannel.h>
+#include <tesla/net/protobuf/RpcController.h>
+#include <tesla/net/protobuf/RpcServer.h>
+#include <tesla/net/protobuf/test/echo.pb.h>
+
+#include <tesla/net/EventLoop.h>
+#include <tesla/net/InetAddress.h>
+
+#include <google/protobuf/stubs/callback.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <assert.h>
+#include <stdio.h>
+#include <unistd.h>
+
+using namespace tesla::base;
+using namespace tesla::net;
+
+namespace
+{
+
+EventLoop* g_loop = NULL;
+
+/// echoes the payload, after delayMs if there is one
+class EchoServiceImpl
+    : public tesla::EchoService
+{
+public:
+    virtual void Echo(google::protobuf::RpcController*,
+                      const tesla::EchoRequest* request,
+                      tesla::EchoResponse* response,
+                      google::protobuf::Closure* done)
+    {
+        response->set_payload(request->payload());
+        if (request->delayms() > 0)
+        {
+            g_loop->runAfter(request->delayms() / 1000.0,
+                             std::bind(&google::protobuf::Closure::Run, done));
+        }
+        else
+        {
+            done->Run();
+        }
+    }
+};
+
+struct Call
+{
+    tesla::EchoRequest request;
+    tesla::EchoResponse response;
+    RpcController controller;
+};
+
+const int PIPELINED_CALLS = 100;
+
+RpcChannel* g_channel = NULL;
+tesla::EchoService::Stub* g_stub = NULL;
+std::vector<Call*> g_calls;
+std::vector<int> g_order; // indexes of g_calls, as they complete
+int g_pending = 0;
+int g_round = 0;
+
+void nextRound();
+
+void onDone(int index)
+{
+    g_order.push_back(index);
+    if (--g_pending == 0)
+    {
+        nextRound();
+    }
+}
+
+void call(int index, const std::string& payload, int delayMs, double timeout)
+{
+    Call* c = g_calls[index];
+    c->request.set_payload(payload);
+    c->request.set_delayms(delayMs);
+    c->controller.setTimeout(timeout);
+    ++g_pending;
+    g_stub->Echo(&c->controller, &c->request, &c->response,
+                 google::protobuf::NewCallback(&onDone, index));
+}
+
+/// the rounds of the test, one after another
+void nextRound()
+{
+    const int index = static_cast<int>(g_order.size());
+    ++g_round;
+    if (g_round == 1)
+    {
+        // all of the first round, made before the connection was up,
+        // went out in one send and came back in order
+        assert(g_order.size() == static_cast<size_t>(PIPELINED_CALLS));
+        for (int i = 0; i < PIPELINED_CALLS; ++i)
+        {
+            assert(g_order[i] == i);
+            assert(!g_calls[i]->controller.Failed());
+            assert(g_calls[i]->response.payload() == g_calls[i]->request.payload());
+        }
+        assert(g_channel->calls() == PIPELINED_CALLS);
+        assert(g_channel->flushes() == 1);
+
+        // answered out of order, and one that times out
+        call(index, "slow", 200, 0.0);
+        call(index + 1, "fast", 0, 0.0);
+        call(index + 2, "late", 1000, 0.1);
+    }
+    else if (g_round == 2)
+    {
+        const size_t n = g_order.size();
+        assert(n == PIPELINED_CALLS + 3);
+        assert(g_order[n - 3] == PIPELINED_CALLS + 1);
+        assert(g_order[n - 2] == PIPELINED_CALLS + 2);
+        assert(g_order[n - 1] == PIPELINED_CALLS);
+        assert(g_channel->flushes() == 2);
+
+        Call* fast = g_calls[PIPELINED_CALLS + 1];
+        assert(!fast->controller.Failed() && fast->response.payload() == "fast");
+        Call* late = g_calls[PIPELINED_CALLS + 2];
+        assert(late->controller.Failed() && late->controller.ErrorText() == "timeout");
+        Call* slow = g_calls[PIPELINED_CALLS];
+        assert(!slow->controller.Failed() && slow->response.payload() == "slow");
+        (void)fast;
+        (void)late;
+        (void)slow;
+
+        // let the answer of the timed out call arrive and be dropped
+        g_loop->runAfter(1.0, std::bind(&EventLoop::quit, g_loop));
+    }
+}
+
+} // namespace
+
+int main()
+{
+    GOOGLE_PROTOBUF_VERIFY_VERSION;
+
+    EventLoop loop;
+    g_loop = &loop;
+    const uint16_t port = static_cast<uint16_t>(20000 + ::getpid() % 20000);
+    const InetAddress serverAddr("127.0.0.1", port);
+
+    EchoServiceImpl service;
+    RpcServer server(&loop, serverAddr, "RpcServer");
+    server.registerService(&service);
+    server.start();
+
+    RpcChannel channel(&loop, serverAddr, "RpcChannel");
+    g_channel = &channel;
+    tesla::EchoService::Stub stub(&channel);
+    g_stub = &stub;
+    for (int i = 0; i < PIPELINED_CALLS + 3; ++i)
+    {
+        g_calls.push_back(new Call);
+    }
+
+    // pipelined before the connection is up
+    for (int i = 0; i < PIPELINED_CALLS; ++i)
+    {
+        char payload[32];
+        snprintf(payload, sizeof payload, "call %d", i);
+        call(i, payload, 0, 0.0);
+    }
+    channel.connect();
+    loop.runAfter(10.0, std::bind(&EventLoop::quit, &loop)); // if anything hangs
+    loop.loop();
+
+    assert(g_round == 2);
+    for (size_t i = 0; i < g_calls.size(); ++i)
+    {
+        delete g_calls[i];
+    }
+    google::protobuf::ShutdownProtobufLibrary();
+    printf("RpcChannel_Test passed\n");
+    return 0;
+}
@@ -0,0 +1,29 @@
+#include <tesla/net/TimerQueue.h>
+#include <tesla/net/timer/SortedTimerQueue.h>
+#include <tesla/net/timer/WheelTimerQueue.h>
+
+#include <stdlib.h>
+
+namespace tesla
+{
+
+namespace net
+{
+
+TimerQueue* TimerQueue::newTimerQueue(EventLoop* loop,
+                                      EventLoop::TimerOption option)
+{
+    if (option == EventLoop::WheelTimers
+            || (option == EventLoop::DefaultTimers && ::getenv("TESLA_TIMING_WHEEL")))
+    {
+        return new WheelTimerQueue(loop);
+    }
+    else
+    {
+        return new SortedTimerQueue(loop);
+    }
+}
+
+} // namespace net
+
+} // namespace tesla
@@ -0,0 +1,212 @@
+#define __STDC_LIMIT_MACROS
+#include <tesla/base/Logger.h>
+
+#include <tesla/net/timer/SortedTimerQueue.h>
+#include <tesla/net/EventLoop.h>
+#include <tesla/net/Timer.h>
+#include <tesla/net/TimerId.hpp>
+
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+#include <functional>
+#include <memory>
+#else // __GXX_EXPERIMENTAL_CXX0X__
+#include <boost/bind.hpp>
+#endif // __GXX_EXPERIMENTAL_CXX0X__
+
+#include <algorithm>
+#include <iterator>
+
+#include <stdint.h>
+
+namespace tesla
+{
+
+using namespace tesla::base;
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+using std::bind;
+#else // __GXX_EXPERIMENTAL_CXX0X__
+using boost::bind;
+#endif // __GXX_EXPERIMENTAL_CXX0X__
+
+namespace net
+{
+
+SortedTimerQueue::SortedTimerQueue(EventLoop* loop)
+    : TimerQueue(loop),
+      timers_(),
+      callingExpiredTimers_(false)
+{
+}
+
+SortedTimerQueue::~SortedTimerQueue()
+{
+    for (TimerList::iterator it = timers_.begin();
+            it != timers_.end(); ++it)
+    {
+        delete it->second;
+    }
+}
+
+TimerId SortedTimerQueue::addTimer(const TimerCallback& cb,
+                                   Timestamp when,
+                                   double interval,
+                                   double slack)
+{
+    Timer* timer = new Timer(cb, when, interval, slack);
+    loop_->runInLoop(bind(&SortedTimerQueue::addTimerInLoop, this, timer));
+    return TimerId(timer, timer->sequence());
+}
+
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+TimerId SortedTimerQueue::addTimer(TimerCallback&& cb,
+                                   Timestamp when,
+                                   double interval,
+                                   double slack)
+{
+    Timer* timer = new Timer(std::move(cb), when, interval, slack);
+    loop_->runInLoop(bind(&SortedTimerQueue::addTimerInLoop, this, timer));
+    return TimerId(timer, timer->sequence());
+}
+#endif
+
+void SortedTimerQueue::cancel(TimerId timerId)
+{
+    loop_->runInLoop(bind(&SortedTimerQueue::cancelInLoop, this, timerId));
+}
+
+void SortedTimerQueue::addTimerInLoop(Timer* timer)
+{
+    loop_->assertInLoopThread();
+    bool earliestChanged = insert(timer);
+
+    if (earliestChanged)
+    {
+        resetTimerfd(timer->expiration());
+    }
+}
+
+void SortedTimerQueue::cancelInLoop(TimerId timerId)
+{
+    loop_->assertInLoopThread();
+    assert(timers_.size() == activeTimers_.size());
+    ActiveTimer timer(timerOf(timerId), sequenceOf(timerId));
+    ActiveTimerSet::iterator it = activeTimers_.find(timer);
+    if (it != activeTimers_.end())
+    {
+        size_t n = timers_.erase(Entry(it->first->expiration(), it->first));
+        assert(n == 1);
+        (void)n;
+        delete it->first; // FIXME: no delete please
+        activeTimers_.erase(it);
+    }
+    else if (callingExpiredTimers_)
+    {
+        cancelingTimers_.insert(timer);
+    }
+    assert(timers_.size() == activeTimers_.size());
+}
+
+size_t SortedTimerQueue::handleExpired(Timestamp now)
+{
+    std::vector<Entry> expired = getExpired(now);
+
+    callingExpiredTimers_ = true;
+    cancelingTimers_.clear();
+    // safe to callback outside critical section
+    for (std::vector<Entry>::iterator it = expired.begin();
+            it != expired.end(); ++it)
+    {
+        it->second->run();
+    }
+    callingExpiredTimers_ = false;
+
+    reset(expired, now);
+    return expired.size();
+}
+
+std::vector<SortedTimerQueue::Entry> SortedTimerQueue::getExpired(Timestamp now)
+{
+    assert(timers_.size() == activeTimers_.size());
+    std::vector<Entry> expired;
+    Entry sentry(now, reinterpret_cast<Timer*>(UINTPTR_MAX));
+    TimerList::iterator end = timers_.lower_bound(sentry);
+    assert(end == timers_.end() || now < end->first);
+    std::copy(timers_.begin(), end, back_inserter(expired));
+    timers_.erase(timers_.begin(), end);
+
+    for (std::vector<Entry>::iterator it = expired.begin();
+            it != expired.end(); ++it)
+    {
+        ActiveTimer timer(it->second, it->second->sequence());
+        size_t n = activeTimers_.erase(timer);
+        assert(n == 1);
+        (void)n;
+    }
+
+    assert(timers_.size() == activeTimers_.size());
+    return expired;
+}
+
+void SortedTimerQueue::reset(const std::vector<Entry>& expired, Timestamp now)
+{
+    Timestamp nextExpire;
+
+    for (std::vector<Entry>::const_iterator it = expired.begin();
+            it != expired.end(); ++it)
+    {
+        ActiveTimer timer(it->second, it->second->sequence());
+        if (it->second->repeat()
+                && cancelingTimers_.find(timer) == cancelingTimers_.end())
+        {
+            it->second->restart(now);
+            insert(it->second);
+        }
+        else
+        {
+            // FIXME move to a free list
+            delete it->second; // FIXME: no delete please
+        }
+    }
+
+    if (!timers_.empty())
+    {
+        nextExpire = timers_.begin()->second->expiration();
+    }
+
+    if (nextExpire.valid())
+    {
+        resetTimerfd(nextExpire);
+    }
+}
+
+bool SortedTimerQueue::insert(Timer* timer)
+{
+    loop_->assertInLoopThread();
+    assert(timers_.size() == activeTimers_.size());
+    bool earliestChanged = false;
+    Timestamp when = timer->expiration();
+    TimerList::iterator it = timers_.begin();
+    if (it == timers_.end() || when < it->first)
+    {
+        earliestChanged = true;
+    }
+    {
+        std::pair<TimerList::iterator, bool> result
+        = timers_.insert(Entry(when, timer));
+        assert(result.second);
+        (void)result;
+    }
+    {
+        std::pair<ActiveTimerSet::iterator, bool> result
+        = activeTimers_.insert(ActiveTimer(timer, timer->sequence()));
+        assert(result.second);
+        (void)result;
+    }
+
+    assert(timers_.size() == activeTimers_.size());
+    return earliestChanged;
+}
+
+} // namespace net
+
+} // namespace tesla
@@ -0,0 +1,84 @@
+/*
+ *
+ * Author:
+ *     Thomas Liu
+ * Date:
+ *     4/17/2014
+ * Description:
+ *
+ *
+ *
+ * Licensed under the Apache License, Version 2.0
+ *
+ */
+
+#ifndef TESLA_NET_TIMER_SORTEDTIMERQUEUE_H
+#define TESLA_NET_TIMER_SORTEDTIMERQUEUE_H
+
+#include <tesla/net/TimerQueue.h>
+
+#include <set>
+#include <vector>
+
+namespace tesla
+{
+
+namespace net
+{
+
+///
+/// Timers sorted by expiration in a std::set,
+/// exact order, O(log n) insert and cancel.
+///
+class SortedTimerQueue
+    : public TimerQueue
+{
+public:
+    SortedTimerQueue(EventLoop* loop);
+    virtual ~SortedTimerQueue();
+
+    virtual TimerId addTimer(const TimerCallback& cb,
+                             tesla::base::Timestamp when,
+                             double interval,
+                             double slack);
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+    virtual TimerId addTimer(TimerCallback&& cb,
+                             tesla::base::Timestamp when,
+                             double interval,
+                             double slack);
+#endif
+
+    virtual void cancel(TimerId timerId);
+
+private:
+
+    // FIXME: use unique_ptr<Timer> instead of raw pointers.
+    typedef std::pair<tesla::base::Timestamp, Timer*> Entry;
+    typedef std::set<Entry> TimerList;
+    typedef std::pair<Timer*, int64_t> ActiveTimer;
+    typedef std::set<ActiveTimer> ActiveTimerSet;
+
+    void addTimerInLoop(Timer* timer);
+    void cancelInLoop(TimerId timerId);
+    virtual size_t handleExpired(tesla::base::Timestamp now);
+    // move out all expired timers
+    std::vector<Entry> getExpired(tesla::base::Timestamp now);
+    void reset(const std::vector<Entry>& expired, tesla::base::Timestamp now);
+
+    bool insert(Timer* timer);
+
+    // Timer list sorted by expiration
+    TimerList timers_;
+
+    /// timer sets
+    ActiveTimerSet activeTimers_;
+    ActiveTimerSet cancelingTimers_;
+
+    bool callingExpiredTimers_; /* atomic */
+}; // class SortedTimerQueue
+
+} // namespace net
+
+} // namespace tesla
+
+#endif  // TESLA_NET_TIMER_SORTEDTIMERQUEUE_H
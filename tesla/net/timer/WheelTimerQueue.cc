@@ -0,0 +1,381 @@
+#include <tesla/base/Logger.h>
+
+#include <tesla/net/timer/WheelTimerQueue.h>
+#include <tesla/net/EventLoop.h>
+#include <tesla/net/Timer.h>
+#include <tesla/net/TimerId.hpp>
+
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+#include <functional>
+#include <memory>
+#else // __GXX_EXPERIMENTAL_CXX0X__
+#include <boost/bind.hpp>
+#endif // __GXX_EXPERIMENTAL_CXX0X__
+
+#include <algorithm>
+
+#include <assert.h>
+#include <string.h>
+
+namespace tesla
+{
+
+using namespace tesla::base;
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+using std::bind;
+#else // __GXX_EXPERIMENTAL_CXX0X__
+using boost::bind;
+#endif // __GXX_EXPERIMENTAL_CXX0X__
+
+namespace net
+{
+
+const int64_t WheelTimerQueue::TICK_MICROSECONDS;
+const int WheelTimerQueue::LEVELS;
+const int WheelTimerQueue::ROOT_BITS;
+const int WheelTimerQueue::LEVEL_BITS;
+const int WheelTimerQueue::ROOT_SIZE;
+const int WheelTimerQueue::LEVEL_SIZE;
+const int64_t WheelTimerQueue::ROOT_MASK;
+const int64_t WheelTimerQueue::LEVEL_MASK;
+
+WheelTimerQueue::WheelTimerQueue(EventLoop* loop)
+    : TimerQueue(loop),
+      currentTick_(tickOf(Timestamp::now())),
+      armedTick_(-1),
+      callingExpiredTimers_(false)
+{
+    memset(wheel_, 0, sizeof wheel_);
+    memset(counts_, 0, sizeof counts_);
+}
+
+WheelTimerQueue::~WheelTimerQueue()
+{
+    for (size_t i = 0; i < sizeof wheel_ / sizeof wheel_[0]; ++i)
+    {
+        Timer* timer = wheel_[i];
+        while (timer)
+        {
+            Timer* next = timer->next_;
+            delete timer;
+            timer = next;
+        }
+    }
+    for (size_t i = 0; i < freeTimers_.size(); ++i)
+    {
+        delete freeTimers_[i];
+    }
+}
+
+TimerId WheelTimerQueue::addTimer(const TimerCallback& cb,
+                                  Timestamp when,
+                                  double interval,
+                                  double slack)
+{
+    Timer* timer = newTimer(cb, when, interval, slack);
+    TimerId timerId(timer, timer->sequence());
+    loop_->runInLoop(bind(&WheelTimerQueue::addTimerInLoop, this, timer));
+    return timerId;
+}
+
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+TimerId WheelTimerQueue::addTimer(TimerCallback&& cb,
+                                  Timestamp when,
+                                  double interval,
+                                  double slack)
+{
+    const TimerCallback& callback = cb;
+    return addTimer(callback, when, interval, slack);
+}
+#endif
+
+void WheelTimerQueue::cancel(TimerId timerId)
+{
+    loop_->runInLoop(bind(&WheelTimerQueue::cancelInLoop, this, timerId));
+}
+
+Timer* WheelTimerQueue::newTimer(const TimerCallback& cb,
+                                 Timestamp when,
+                                 double interval,
+                                 double slack)
+{
+    // the pool belongs to the loop thread, other threads allocate,
+    // their timers join the pool once released.
+    if (loop_->isInLoopThread() && !freeTimers_.empty())
+    {
+        Timer* timer = freeTimers_.back();
+        freeTimers_.pop_back();
+        timer->reset(cb, when, interval, slack);
+        return timer;
+    }
+    return new Timer(cb, when, interval, slack);
+}
+
+void WheelTimerQueue::releaseTimer(Timer* timer)
+{
+    assert(timer->bucket_ == NULL);
+    timer->clear();
+    freeTimers_.push_back(timer);
+}
+
+void WheelTimerQueue::addTimerInLoop(Timer* timer)
+{
+    loop_->assertInLoopThread();
+    if (counts_[0] + counts_[1] + counts_[2] + counts_[3] == 0)
+    {
+        // idle wheel, catches up with the clock for free
+        currentTick_ = std::max(currentTick_, tickOf(Timestamp::now()));
+    }
+    place(timer);
+    if (callingExpiredTimers_)
+    {
+        return;  // handleExpired() rearms once it is done
+    }
+    int64_t tick = std::max(tickOf(timer->expiration()), currentTick_);
+    if (armedTick_ < 0 || tick < armedTick_)
+    {
+        armedTick_ = tick;
+        resetTimerfd(Timestamp(tick * TICK_MICROSECONDS));
+    }
+}
+
+void WheelTimerQueue::cancelInLoop(TimerId timerId)
+{
+    loop_->assertInLoopThread();
+    Timer* timer = timerOf(timerId);
+    if (timer == NULL || timer->sequence() != sequenceOf(timerId))
+    {
+        return;  // expired, or reused by another schedule
+    }
+    if (timer->bucket_)
+    {
+        unlink(timer);
+        releaseTimer(timer);
+        // the timerfd stays armed, a spurious wakeup is harmless
+    }
+    else if (callingExpiredTimers_)
+    {
+        timer->canceled_ = true;
+    }
+}
+
+size_t WheelTimerQueue::handleExpired(Timestamp now)
+{
+    armedTick_ = -1;
+    std::vector<Timer*> expired;
+    // rounds down, a tick is due once its whole millisecond has passed
+    advance(now.microSecondsSinceEpoch() / TICK_MICROSECONDS, &expired);
+
+    callingExpiredTimers_ = true;
+    for (std::vector<Timer*>::iterator it = expired.begin();
+            it != expired.end(); ++it)
+    {
+        (*it)->run();
+    }
+    callingExpiredTimers_ = false;
+
+    for (std::vector<Timer*>::iterator it = expired.begin();
+            it != expired.end(); ++it)
+    {
+        Timer* timer = *it;
+        if (timer->repeat() && !timer->canceled_)
+        {
+            timer->restart(now);
+            place(timer);
+        }
+        else
+        {
+            releaseTimer(timer);
+        }
+    }
+
+    rearm();
+    return expired.size();
+}
+
+int64_t WheelTimerQueue::tickOf(Timestamp when)
+{
+    // rounds up, so a timer never runs before its expiration
+    return (when.microSecondsSinceEpoch() + TICK_MICROSECONDS - 1) / TICK_MICROSECONDS;
+}
+
+void WheelTimerQueue::place(Timer* timer)
+{
+    assert(timer->bucket_ == NULL);
+    int64_t expires = std::max(tickOf(timer->expiration()), currentTick_);
+    int64_t delta = expires - currentTick_;
+
+    int level = 0;
+    int index = static_cast<int>(expires & ROOT_MASK);
+    if (delta >= ROOT_SIZE)
+    {
+        const int64_t maxDelta = (static_cast<int64_t>(1) << (ROOT_BITS + (LEVELS - 1) * LEVEL_BITS)) - 1;
+        if (delta > maxDelta)
+        {
+            // beyond the wheel, parked at its far end,
+            // placed again when it is cascaded down
+            expires = currentTick_ + maxDelta;
+            delta = maxDelta;
+        }
+        for (level = 1; level < LEVELS - 1; ++level)
+        {
+            if (delta < (static_cast<int64_t>(1) << (ROOT_BITS + level * LEVEL_BITS)))
+            {
+                break;
+            }
+        }
+        index = static_cast<int>((expires >> (ROOT_BITS + (level - 1) * LEVEL_BITS)) & LEVEL_MASK);
+    }
+
+    Timer** bucket = slot(level, index);
+    timer->prev_ = NULL;
+    timer->next_ = *bucket;
+    if (*bucket)
+    {
+        (*bucket)->prev_ = timer;
+    }
+    *bucket = timer;
+    timer->bucket_ = bucket;
+    timer->level_ = level;
+    ++counts_[level];
+}
+
+void WheelTimerQueue::unlink(Timer* timer)
+{
+    assert(timer->bucket_ != NULL);
+    if (timer->prev_)
+    {
+        timer->prev_->next_ = timer->next_;
+    }
+    else
+    {
+        *timer->bucket_ = timer->next_;
+    }
+    if (timer->next_)
+    {
+        timer->next_->prev_ = timer->prev_;
+    }
+    --counts_[timer->level_];
+    timer->prev_ = NULL;
+    timer->next_ = NULL;
+    timer->bucket_ = NULL;
+    timer->level_ = -1;
+}
+
+void WheelTimerQueue::cascade(int level, int index)
+{
+    Timer** bucket = slot(level, index);
+    Timer* timer = *bucket;
+    *bucket = NULL;
+    while (timer)
+    {
+        Timer* next = timer->next_;
+        --counts_[level];
+        timer->prev_ = NULL;
+        timer->next_ = NULL;
+        timer->bucket_ = NULL;
+        timer->level_ = -1;
+        place(timer);
+        timer = next;
+    }
+}
+
+void WheelTimerQueue::advance(int64_t nowTick, std::vector<Timer*>* expired)
+{
+    while (currentTick_ <= nowTick)
+    {
+        if (counts_[0] == 0)
+        {
+            // nothing in this round of the first level, skip to its end
+            currentTick_ = std::min((currentTick_ | ROOT_MASK) + 1, nowTick + 1);
+        }
+        else
+        {
+            Timer* timer = *slot(0, static_cast<int>(currentTick_ & ROOT_MASK));
+            while (timer)
+            {
+                Timer* next = timer->next_;
+                unlink(timer);
+                expired->push_back(timer);
+                timer = next;
+            }
+            ++currentTick_;
+        }
+
+        if ((currentTick_ & ROOT_MASK) == 0)
+        {
+            // a new round, brings down the next slot of each level above,
+            // as long as the level below wraps too.
+            // done right away, so placing never sees a pending cascade
+            for (int level = 1; level < LEVELS; ++level)
+            {
+                int index = static_cast<int>(
+                                (currentTick_ >> (ROOT_BITS + (level - 1) * LEVEL_BITS)) & LEVEL_MASK);
+                cascade(level, index);
+                if (index != 0)
+                {
+                    break;
+                }
+            }
+        }
+    }
+}
+
+int64_t WheelTimerQueue::nextWakeupTick() const
+{
+    int64_t next = -1;
+    if (counts_[0] > 0)
+    {
+        // all of them are within one round from now
+        for (int64_t tick = currentTick_; tick < currentTick_ + ROOT_SIZE; ++tick)
+        {
+            if (slot(0, static_cast<int>(tick & ROOT_MASK)))
+            {
+                next = tick;
+                break;
+            }
+        }
+        assert(next >= 0);
+    }
+    // timers of upper levels may be due before some in the first level,
+    // so wakes up in time for the cascade that brings them down too
+    if (counts_[1] > 0)
+    {
+        int64_t round = currentTick_ >> ROOT_BITS;
+        for (int64_t r = round + 1; r <= round + LEVEL_SIZE; ++r)
+        {
+            if (slot(1, static_cast<int>(r & LEVEL_MASK)))
+            {
+                int64_t tick = r << ROOT_BITS;
+                next = (next < 0) ? tick : std::min(next, tick);
+                break;
+            }
+        }
+    }
+    for (int level = 2; level < LEVELS; ++level)
+    {
+        if (counts_[level] > 0)
+        {
+            // next cascade of level 2, looks again from there
+            const int shift = ROOT_BITS + LEVEL_BITS;
+            int64_t tick = ((currentTick_ >> shift) + 1) << shift;
+            next = (next < 0) ? tick : std::min(next, tick);
+            break;
+        }
+    }
+    return next;
+}
+
+void WheelTimerQueue::rearm()
+{
+    int64_t tick = nextWakeupTick();
+    if (tick >= 0)
+    {
+        armedTick_ = tick;
+        resetTimerfd(Timestamp(tick * TICK_MICROSECONDS));
+    }
+}
+
+} // namespace net
+
+} // namespace tesla
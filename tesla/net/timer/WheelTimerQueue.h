@@ -0,0 +1,114 @@
+/*
+ *
+ * Author:
+ *     Thomas Liu
+ * Date:
+ *     10/18/2026
+ * Description:
+ *     Hashed hierarchical timing wheel
+ *
+ *
+ * Licensed under the Apache License, Version 2.0
+ *
+ */
+
+#ifndef TESLA_NET_TIMER_WHEELTIMERQUEUE_H
+#define TESLA_NET_TIMER_WHEELTIMERQUEUE_H
+
+#include <tesla/net/TimerQueue.h>
+
+#include <vector>
+
+namespace tesla
+{
+
+namespace net
+{
+
+///
+/// Timers hashed into a hierarchical timing wheel of 1ms ticks,
+/// 256 slots in the first level and 64 in each of the other three,
+/// which spans about 18 hours, later timers wait in the last level.
+///
+/// Insert and cancel are O(1), timers of a level are moved down
+/// one level when its slot comes around.
+/// Timers are pooled, a Timer is never freed before the queue is,
+/// so a stale TimerId is always safe to look at.
+class WheelTimerQueue
+    : public TimerQueue
+{
+public:
+    WheelTimerQueue(EventLoop* loop);
+    virtual ~WheelTimerQueue();
+
+    virtual TimerId addTimer(const TimerCallback& cb,
+                             tesla::base::Timestamp when,
+                             double interval,
+                             double slack);
+#if defined(__GXX_EXPERIMENTAL_CXX0X__) || __cplusplus >= 201103L
+    virtual TimerId addTimer(TimerCallback&& cb,
+                             tesla::base::Timestamp when,
+                             double interval,
+                             double slack);
+#endif
+
+    virtual void cancel(TimerId timerId);
+
+private:
+    static const int64_t TICK_MICROSECONDS = 1000;
+    static const int LEVELS = 4;
+    static const int ROOT_BITS = 8;
+    static const int LEVEL_BITS = 6;
+    static const int ROOT_SIZE = 1 << ROOT_BITS;
+    static const int LEVEL_SIZE = 1 << LEVEL_BITS;
+    static const int64_t ROOT_MASK = ROOT_SIZE - 1;
+    static const int64_t LEVEL_MASK = LEVEL_SIZE - 1;
+
+    Timer* newTimer(const TimerCallback& cb,
+                    tesla::base::Timestamp when,
+                    double interval,
+                    double slack);
+    void releaseTimer(Timer* timer);
+
+    void addTimerInLoop(Timer* timer);
+    void cancelInLoop(TimerId timerId);
+    virtual size_t handleExpired(tesla::base::Timestamp now);
+
+    /// Links the timer into the slot of its expiration.
+    void place(Timer* timer);
+    void unlink(Timer* timer);
+    /// Moves the timers of a slot down to lower levels.
+    void cascade(int level, int index);
+    /// Collects the timers of every tick up to @c nowTick.
+    void advance(int64_t nowTick, std::vector<Timer*>* expired);
+    /// Tick to wake up at, -1 if there is no timer.
+    int64_t nextWakeupTick() const;
+    void rearm();
+
+    static int64_t tickOf(tesla::base::Timestamp when);
+    Timer** slot(int level, int index)
+    {
+        return &wheel_[level == 0 ? index : ROOT_SIZE + (level - 1) * LEVEL_SIZE + index];
+    }
+    const Timer* slot(int level, int index) const
+    {
+        return wheel_[level == 0 ? index : ROOT_SIZE + (level - 1) * LEVEL_SIZE + index];
+    }
+
+    /// all ticks before it have been collected
+    int64_t currentTick_;
+    /// tick the timerfd is armed for, -1 if none
+    int64_t armedTick_;
+    Timer* wheel_[ROOT_SIZE + (LEVELS - 1) * LEVEL_SIZE];
+    size_t counts_[LEVELS];
+
+    /// released timers, for reuse in the loop thread
+    std::vector<Timer*> freeTimers_;
+    bool callingExpiredTimers_; /* atomic */
+}; // class WheelTimerQueue
+
+} // namespace net
+
+} // namespace tesla
+
+#endif  // TESLA_NET_TIMER_WHEELTIMERQUEUE_H